@@ -1,14 +1,192 @@
 #include "tui/app.h"
 #include "network/api_client.h"
+#include "sync/sync_engine.h"
 
+#include <nlohmann/json.hpp>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <string>
 #include <memory>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+/// ~/.vaultcli/cache, or empty if there is no home directory to put it in
+static std::filesystem::path default_cache_dir() {
+    const char* home = std::getenv("HOME");
+    if (!home || !*home) home = std::getenv("USERPROFILE");
+    if (!home || !*home) return {};
+    return std::filesystem::path(home) / ".vaultcli" / "cache";
+}
+
+/// First line of `file` if given, else the environment variable `env`.
+/// Secrets never come from argv, where other users could see them.
+static std::string read_secret(const std::string& file, const char* env) {
+    if (!file.empty()) {
+        std::ifstream in(file);
+        std::string line;
+        if (!in || !std::getline(in, line)) {
+            throw std::runtime_error("Cannot read " + file);
+        }
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        return line;
+    }
+    const char* value = std::getenv(env);
+    return value ? value : "";
+}
+
+/// Log in with --user/$VAULT_USER and --password-file/$VAULT_PASSWORD.
+/// Returns false (after saying why) if that isn't possible.
+static bool login_headless(vault::client::ApiClient& api, std::string user,
+                           const std::string& password_file) {
+    if (user.empty()) user = read_secret("", "VAULT_USER");
+    std::string password = read_secret(password_file, "VAULT_PASSWORD");
+    if (user.empty() || password.empty()) {
+        std::cerr << "Set --user or $VAULT_USER, and $VAULT_PASSWORD or --password-file\n";
+        return false;
+    }
+    auto login = api.login(user, password);
+    if (!login.success) {
+        std::cerr << "Login failed: " << login.message << "\n";
+        return false;
+    }
+    return true;
+}
+
+/// put <name> [file|-]: encrypt and upload, streaming from a file or stdin
+static int run_put(vault::client::ApiClient& api, const std::vector<std::string>& args,
+                   const std::string& key) {
+    std::string source = args.size() > 2 ? args[2] : "-";
+    std::ifstream file;
+    if (source != "-") {
+        file.open(source, std::ios::binary);
+        if (!file) {
+            std::cerr << "Cannot open " << source << "\n";
+            return 1;
+        }
+    }
+#ifdef _WIN32
+    if (source == "-") _setmode(_fileno(stdin), _O_BINARY);   // raw bytes, no CRLF translation
+#endif
+    std::istream& in = source == "-" ? std::cin : file;
+
+    auto result = api.upload_stream(in, args[1], key);
+    if (!result.success) {
+        std::cerr << "put failed: " << result.message << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+/// get <name> [file|-]: download and decrypt to a file or stdout. A file
+/// is written as "<file>.part" and renamed only once it decrypts cleanly.
+static int run_get(vault::client::ApiClient& api, const std::vector<std::string>& args,
+                   const std::string& key) {
+    std::string dest = args.size() > 2 ? args[2] : "-";
+    if (dest == "-") {
+#ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY);   // raw bytes, no CRLF translation
+#endif
+        auto result = api.download_stream(args[1], std::cout, key);
+        if (!result.success) {
+            std::cerr << "get failed: " << result.message << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    std::filesystem::path part = dest + ".part";
+    vault::client::ApiResult result;
+    {
+        std::ofstream out(part, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cerr << "Cannot write " << part.string() << "\n";
+            return 1;
+        }
+        result = api.download_stream(args[1], out, key);
+    }
+
+    std::error_code ec;
+    if (result.success) std::filesystem::rename(part, dest, ec);
+    if (!result.success || ec) {
+        std::filesystem::remove(part, ec);
+        std::cerr << "get failed: " << (result.success ? "cannot rename into place" : result.message) << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+/// ls [--json]: one line per file, or a JSON array
+static int run_ls(vault::client::ApiClient& api, bool as_json) {
+    auto listing = api.list_files();
+    if (!listing.ok) {
+        std::cerr << "ls failed: cannot list files\n";
+        return 1;
+    }
+
+    if (as_json) {
+        nlohmann::json files = nlohmann::json::array();
+        for (const auto& f : listing.files) {
+            files.push_back({{"filename", f.filename}, {"size", f.size}, {"uploaded_at", f.uploaded_at}});
+        }
+        std::cout << files.dump() << "\n";
+    } else {
+        for (const auto& f : listing.files) {
+            std::cout << f.size << '\t' << f.uploaded_at << '\t' << f.filename << "\n";
+        }
+    }
+    return 0;
+}
+
+static void print_usage() {
+    std::cout << "Usage: vault_client [options]              Interactive TUI\n"
+              << "       vault_client sync <dir> [options]   Two-way sync of a directory tree\n"
+              << "       vault_client put <name> [file|-]    Encrypt and upload (default: stdin)\n"
+              << "       vault_client get <name> [file|-]    Download and decrypt (default: stdout)\n"
+              << "       vault_client ls [--json]            List stored files\n"
+              << "\n"
+              << "Options:\n"
+              << "  --host, -H <host>  Server host (default: localhost)\n"
+              << "  --port, -p <port>  Server port (default: 8080)\n"
+              << "  --connections <n>  Keep-alive connections to the server (default: 4)\n"
+              << "  --cache-dir <dir>  Listing cache directory (default: ~/.vaultcli/cache)\n"
+              << "  --no-cache         Don't keep listings between runs\n"
+              << "  --help             Show this help\n"
+              << "\n"
+              << "Command options (login from $VAULT_USER / $VAULT_PASSWORD, key from $VAULT_KEY):\n"
+              << "  --user <name>           Account to use (default: $VAULT_USER)\n"
+              << "  --password-file <file>  Read the account password from a file\n"
+              << "  --key-file <file>       Read the encryption password from a file\n"
+              << "  --json                  ls: print a JSON array\n"
+              << "\n"
+              << "Sync options:\n"
+              << "  --prefix <p>            Remote name prefix for this tree (default: none)\n"
+              << "  --prefer local|remote   Side that wins a conflict (default: local)\n"
+              << "  --threads <n>           Scan and hash threads (default: CPU count)\n"
+              << "  --dry-run               Show what would be transferred\n";
+}
 
 int main(int argc, char* argv[]) {
     // ── Parse command line arguments ────────────────────────────────────
     std::string host = "localhost";
     int port = 8080;
+    size_t connections = 4;
+    std::filesystem::path cache_dir = default_cache_dir();
+
+    std::vector<std::string> positional;
+    std::string user;
+    std::string password_file;
+    std::string key_file;
+    bool as_json = false;
+    vault::client::SyncOptions sync_options;
+    sync_options.scan_threads = std::max(4u, std::thread::hardware_concurrency());
 
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
@@ -16,17 +194,98 @@ int main(int argc, char* argv[]) {
             host = argv[++i];
         } else if ((arg == "--port" || arg == "-p") && i + 1 < argc) {
             port = std::stoi(argv[++i]);
+        } else if (arg == "--connections" && i + 1 < argc) {
+            connections = std::stoul(argv[++i]);
+        } else if (arg == "--cache-dir" && i + 1 < argc) {
+            cache_dir = argv[++i];
+        } else if (arg == "--no-cache") {
+            cache_dir.clear();
+        } else if (arg == "--user" && i + 1 < argc) {
+            user = argv[++i];
+        } else if (arg == "--password-file" && i + 1 < argc) {
+            password_file = argv[++i];
+        } else if (arg == "--key-file" && i + 1 < argc) {
+            key_file = argv[++i];
+        } else if (arg == "--prefix" && i + 1 < argc) {
+            sync_options.prefix = argv[++i];
+        } else if (arg == "--prefer" && i + 1 < argc) {
+            std::string side = argv[++i];
+            if (side != "local" && side != "remote") {
+                std::cerr << "--prefer must be 'local' or 'remote'\n";
+                return 2;
+            }
+            sync_options.prefer = side == "local" ? vault::client::SyncPreference::Local
+                                                  : vault::client::SyncPreference::Remote;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            sync_options.scan_threads = std::stoul(argv[++i]);
+        } else if (arg == "--json") {
+            as_json = true;
+        } else if (arg == "--dry-run") {
+            sync_options.dry_run = true;
         } else if (arg == "--help") {
-            std::cout << "Usage: vault_client [options]\n"
-                      << "  --host, -H <host>  Server host (default: localhost)\n"
-                      << "  --port, -p <port>  Server port (default: 8080)\n"
-                      << "  --help             Show this help\n";
+            print_usage();
             return 0;
+        } else if (arg == "-" || (!arg.empty() && arg[0] != '-')) {
+            positional.push_back(arg);
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            print_usage();
+            return 2;
+        }
+    }
+
+    auto api = std::make_shared<vault::client::ApiClient>(host, port, connections);
+    api->set_cache_dir(cache_dir);
+
+    // ── Headless commands ───────────────────────────────────────────────
+    if (!positional.empty()) {
+        const std::string& command = positional[0];
+        bool known = (command == "sync" && positional.size() == 2) ||
+                     ((command == "put" || command == "get") &&
+                      (positional.size() == 2 || positional.size() == 3)) ||
+                     (command == "ls" && positional.size() == 1);
+        if (!known) {
+            print_usage();
+            return 2;
+        }
+
+        try {
+            std::string key;
+            if (command != "ls") {
+                key = read_secret(key_file, "VAULT_KEY");
+                if (key.empty()) {
+                    std::cerr << "Set $VAULT_KEY or --key-file to the encryption password\n";
+                    return 2;
+                }
+            }
+            if (!login_headless(*api, user, password_file)) return 1;
+
+            if (command == "put") return run_put(*api, positional, key);
+            if (command == "get") return run_get(*api, positional, key);
+            if (command == "ls") return run_ls(*api, as_json);
+
+            sync_options.password = key;
+            sync_options.transfers = connections;
+
+            vault::client::SyncEngine engine(api, positional[1], sync_options);
+            engine.set_logger([](const std::string& line) { std::cerr << line << "\n"; });
+            auto report = engine.run();
+
+            std::cout << (sync_options.dry_run ? "Would upload " : "Uploaded ") << report.uploaded
+                      << ", " << (sync_options.dry_run ? "download " : "downloaded ") << report.downloaded
+                      << ", unchanged " << report.unchanged
+                      << ", adopted " << report.adopted
+                      << ", conflicts " << report.conflicts
+                      << ", skipped " << report.skipped
+                      << ", failed " << report.failed << "\n";
+            return report.failed == 0 ? 0 : 1;
+        } catch (const std::exception& e) {
+            std::cerr << command << " failed: " << e.what() << "\n";
+            return 1;
         }
     }
 
-    // ── Create API client and launch TUI ────────────────────────────────
-    auto api = std::make_shared<vault::client::ApiClient>(host, port);
+    // ── Launch TUI ──────────────────────────────────────────────────────
     vault::client::App app(api);
 
     try {
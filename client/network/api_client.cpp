@@ -1,36 +1,130 @@
 #include "network/api_client.h"
 #include "crypto/crypto.h"
 #include "utils/utils.h"
+#include "utils/structured_writer.h"
+#include "utils/tar.h"
 #include <httplib.h>
 #include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
 #include <filesystem>
+#include <fstream>
+#include <memory>
 using json = nlohmann::json;
 
 namespace vault::client
 {
-    ApiClient::ApiClient(const std::string& host, int port)
-        : host_(host), port_(port) 
+    /// Decode a response body according to its Content-Type.
+    /// Returns a discarded value if the body is malformed.
+    static json decode_body(const httplib::Response& res)
     {
+        switch (utils::encoding_from_content_type(res.get_header_value("Content-Type")))
+        {
+            case utils::Encoding::Cbor:    return json::from_cbor(res.body, true, false);
+            case utils::Encoding::Msgpack: return json::from_msgpack(res.body, true, false);
+            case utils::Encoding::Json:    break;
+        }
+        return json::parse(res.body, nullptr, false);
+    }
+
+    /// Failure for a request that never produced a response
+    static ApiResult transport_failure(const httplib::Result& res)
+    {
+        ApiResult result{false, "Cannot connect to server"};
+        if (res.error() == httplib::Error::Canceled)
+        {
+            result.message = "Cancelled";
+        }
+        else
+        {
+            result.transient = true;
+        }
+        return result;
+    }
+
+    /// Failure for an error response. Overload and gateway errors are
+    /// transient; anything else would fail the same way again.
+    static ApiResult http_failure(const httplib::Response& res, const std::string& fallback)
+    {
+        auto body = decode_body(res);
+
+        ApiResult result{false, body.is_object() ? body.value("message", fallback) : fallback};
+        result.status = res.status;
+        result.transient = res.status == 429 || res.status == 502 ||
+                           res.status == 503 || res.status == 504;
+        if (res.has_header("Retry-After"))
+        {
+            result.retry_after = std::atoi(res.get_header_value("Retry-After").c_str());
+        }
+        return result;
+    }
+
+    /// Whether a Repr-Digest header agrees with the SHA-256 of the bytes
+    /// received. Servers that don't send one are taken at their word.
+    static bool digest_matches(const std::string& repr_digest, const std::string& sha256_hex)
+    {
+        if (repr_digest.find("sha-256=") == std::string::npos) return true;
+        return repr_digest.find("sha-256=:" + crypto::hex_to_base64(sha256_hex) + ":") != std::string::npos;
+    }
+
+    static const char* const kDamagedCopy = "Integrity check failed: the server's copy of this file is damaged";
+
+    /// Upload bodies are handed to the socket in slices this size
+    static constexpr size_t kUploadSlice = 64 * 1024;
+
+    ApiClient::ApiClient(const std::string& host, int port, size_t max_connections)
+        : host_(host), port_(port),
+          pool_(host, port, ConnectionPool::Options{max_connections})
+    {
+    }
+
+    bool ApiClient::is_authenticated() const
+    {
+        std::lock_guard<std::mutex> lock(session_mutex_);
+        return !token_.empty();
+    }
+
+    std::string ApiClient::username() const
+    {
+        std::lock_guard<std::mutex> lock(session_mutex_);
+        return username_;
+    }
+
+    httplib::Headers ApiClient::request_headers(bool authenticated) const
+    {
+        // PERF: Binary responses are smaller and much cheaper to decode than JSON
+        httplib::Headers headers = 
+        {
+            {"Accept", std::string(utils::content_type(encoding_)) + ", application/json;q=0.5"}
+        };
+        if (authenticated)
+        {
+            std::lock_guard<std::mutex> lock(session_mutex_);
+            headers.emplace("Authorization", "Bearer " + token_);
+        }
+        return headers;
     }
 
     ApiResult ApiClient::register_user(const std::string& username,
                                         const std::string& password)
     {
-        httplib::Client cli(host_, port_);
-        cli.set_connection_timeout(5);
-        cli.set_read_timeout(10);
-
         json body;
         body["username"] = username;
         body["password"] = password;
 
-        auto result = cli.Post("/register", body.dump(), "application/json");
+        auto result = pool_.execute([&](httplib::Client& cli)
+        {
+            cli.set_read_timeout(10);
+            return cli.Post("/register", request_headers(false), body.dump(), "application/json");
+        });
         if (!result)
         {
             return {false, "Cannot connect to server"};
         }
 
-        auto response = json::parse(result->body, nullptr, false);
+        auto response = decode_body(*result);
         if (response.is_discarded())
         {
             return {false, "Invalid server response"};
@@ -46,21 +140,21 @@ namespace vault::client
     ApiResult ApiClient::login(const std::string& username,
                                 const std::string& password)
     {
-        httplib::Client cli(host_, port_);
-        cli.set_connection_timeout(5);
-        cli.set_read_timeout(10);
-
         json body;
         body["username"] = username;
         body["password"] = password;
 
-        auto res = cli.Post("/login", body.dump(), "application/json");
+        auto res = pool_.execute([&](httplib::Client& cli)
+        {
+            cli.set_read_timeout(10);
+            return cli.Post("/login", request_headers(false), body.dump(), "application/json");
+        });
         if (!res)
         {
             return {false, "Cannot connect to server"};
         }
 
-        auto resp = json::parse(res->body, nullptr, false);
+        auto resp = decode_body(*res);
         if (resp.is_discarded())
         {
             return {false, "Invalid server response"};
@@ -69,6 +163,11 @@ namespace vault::client
         bool success = resp.value("success", false);
         if (success)
         {
+            if (username != this->username())
+            {
+                logout();   // drop the previous user's cached validators
+            }
+            std::lock_guard<std::mutex> lock(session_mutex_);
             token_ = resp.value("token", "");
             username_ = username;
         }
@@ -81,9 +180,11 @@ namespace vault::client
     }
 
     ApiResult ApiClient::upload_file(const std::string& filepath,
-                                      const std::string& password)
+                                      const std::string& password,
+                                      const ProgressFn& progress,
+                                      const std::string& remote_name)
     {
-        if (token_.empty())
+        if (!is_authenticated())
         {
             return {false, "Not authenticated"};
         }
@@ -111,30 +212,45 @@ namespace vault::client
         }
 
         // Send as multipart form data
-        std::string filename = utils::extract_filename(filepath);
-
-        httplib::Client cli(host_, port_);
-        cli.set_connection_timeout(5);
-        cli.set_read_timeout(30);
+        std::string filename = remote_name.empty() ? utils::extract_filename(filepath) : remote_name;
 
-        httplib::MultipartFormDataItems items = 
+        // The part is streamed from the ciphertext buffer in slices, which
+        // avoids a second copy and lets the caller watch progress or cancel
+        httplib::MultipartFormDataProviderItems parts = 
         {
-            {"file", std::string(encrypted.begin(), encrypted.end()),
-             filename, "application/octet-stream"}
+            {"file", [&](size_t offset, httplib::DataSink& sink)
+            {
+                if (offset >= encrypted.size())
+                {
+                    sink.done();
+                    return true;
+                }
+                size_t n = std::min(kUploadSlice, encrypted.size() - offset);
+                if (!sink.write(reinterpret_cast<const char*>(encrypted.data()) + offset, n))
+                {
+                    return false;
+                }
+                return !progress || progress(offset + n, encrypted.size());
+            }, filename, "application/octet-stream"}
         };
 
-        httplib::Headers headers = 
-        {
-            {"Authorization", "Bearer " + token_}
-        };
+        auto headers = request_headers(true);
 
-        auto res = cli.Post("/upload", headers, items, httplib::MultipartFormDataProviderItems{});
+        auto res = pool_.execute([&](httplib::Client& cli)
+        {
+            cli.set_read_timeout(30);
+            return cli.Post("/upload", headers, httplib::MultipartFormDataItems{}, parts);
+        });
         if (!res)
         {
-            return {false, "Cannot connect to server"};
+            return transport_failure(res);
+        }
+        if (res->status >= 300)
+        {
+            return http_failure(*res, "Upload failed");
         }
 
-        auto resp = json::parse(res->body, nullptr, false);
+        auto resp = decode_body(*res);
         if (resp.is_discarded())
         {
             return {false, "Invalid server response"};
@@ -147,24 +263,121 @@ namespace vault::client
         };
     }
 
-    ApiResult ApiClient::download_file(const std::string& filename,
-                                        const std::string& dest_path,
-                                        const std::string& password)
+    /// Upload batches close once they reach either bound
+    static constexpr size_t kUploadBatchBytes = 8 * 1024 * 1024;
+    static constexpr size_t kUploadBatchFiles = 256;
+
+    std::vector<ApiResult> ApiClient::upload_files(const std::vector<std::string>& filepaths,
+                                                    const std::string& password)
     {
-        if (token_.empty())
+        std::vector<ApiResult> results(filepaths.size());
+        if (!is_authenticated())
         {
-            return {false, "Not authenticated"};
+            for (auto& r : results) r = {false, "Not authenticated"};
+            return results;
         }
 
-        httplib::Client cli(host_, port_);
-        cli.set_connection_timeout(5);
-        cli.set_read_timeout(30);
+        httplib::MultipartFormDataItems items;
+        std::vector<size_t> indices;
+        size_t batch_bytes = 0;
 
-        httplib::Headers headers = 
+        for (size_t i = 0; i < filepaths.size(); ++i)
+        {
+            // SECURITY: Encrypt each file on the client side before sending
+            std::vector<uint8_t> encrypted;
+            try
+            {
+                encrypted = crypto::aes256_encrypt(utils::read_file_binary(filepaths[i]), password);
+            }
+            catch (const std::exception& e)
+            {
+                results[i] = {false, std::string("Cannot encrypt file: ") + e.what()};
+                continue;
+            }
+
+            // A file larger than the bound still goes, just in a batch of its own
+            if (!items.empty() && (batch_bytes + encrypted.size() > kUploadBatchBytes ||
+                                   items.size() == kUploadBatchFiles))
+            {
+                send_upload_batch(items, indices, results);
+                items.clear();
+                indices.clear();
+                batch_bytes = 0;
+            }
+
+            batch_bytes += encrypted.size();
+            items.push_back({"file", std::string(encrypted.begin(), encrypted.end()),
+                             utils::extract_filename(filepaths[i]), "application/octet-stream"});
+            indices.push_back(i);
+        }
+
+        if (!items.empty())
+        {
+            send_upload_batch(items, indices, results);
+        }
+        return results;
+    }
+
+    void ApiClient::send_upload_batch(const httplib::MultipartFormDataItems& items,
+                                      const std::vector<size_t>& indices,
+                                      std::vector<ApiResult>& results)
+    {
+        auto fail_all = [&](const std::string& message)
         {
-            {"Authorization", "Bearer " + token_}
+            for (size_t i : indices) results[i] = {false, message};
         };
 
+        auto headers = request_headers(true);
+        auto res = pool_.execute([&](httplib::Client& cli)
+        {
+            cli.set_read_timeout(60);
+            return cli.Post("/upload", headers, items, httplib::MultipartFormDataProviderItems{});
+        });
+        if (!res)
+        {
+            fail_all("Cannot connect to server");
+            return;
+        }
+
+        auto resp = decode_body(*res);
+        if (!resp.is_object())
+        {
+            fail_all("Invalid server response");
+            return;
+        }
+
+        // Multi-part responses carry one entry per part in request order;
+        // a single part gets the plain { success, message } shape
+        auto it = resp.find("results");
+        if (it == resp.end() || !it->is_array() || it->size() != indices.size())
+        {
+            fail_all(resp.value("message", "Unknown error"));
+            if (resp.value("success", false) && indices.size() == 1)
+            {
+                results[indices[0]].success = true;
+            }
+            return;
+        }
+
+        for (size_t k = 0; k < indices.size(); ++k)
+        {
+            const auto& r = (*it)[k];
+            results[indices[k]] = {r.value("success", false), r.value("message", "Unknown error")};
+        }
+    }
+
+    ApiResult ApiClient::download_file(const std::string& filename,
+                                        const std::string& dest_path,
+                                        const std::string& password,
+                                        const ProgressFn& progress)
+    {
+        if (!is_authenticated())
+        {
+            return {false, "Not authenticated"};
+        }
+
+        auto headers = request_headers(true);
+
         // The server stores files with .enc extension
         std::string enc_filename = filename;
         if (enc_filename.find(".enc") == std::string::npos)
@@ -172,17 +385,68 @@ namespace vault::client
             enc_filename += ".enc";
         }
 
-        auto res = cli.Get("/download?filename=" + enc_filename, headers);
+        // Remove .enc extension for the output filename if present
+        std::string output_name = filename;
+        if (output_name.size() > 4 &&
+            output_name.substr(output_name.size() - 4) == ".enc")
+        {
+            output_name = output_name.substr(0, output_name.size() - 4);
+        }
+
+        std::filesystem::path dest(dest_path);
+        if (std::filesystem::is_directory(dest))
+        {
+            dest = dest / output_name;
+        }
+
+        // PERF: If our last copy is still on disk untouched, let the server
+        // answer 304 instead of resending and re-decrypting the whole file
+        std::unique_lock<std::mutex> cache_lock(cache_mutex_);
+        auto cached = download_cache_.find(enc_filename);
+        if (cached != download_cache_.end())
+        {
+            std::error_code ec;
+            const auto& entry = cached->second;
+            if (entry.dest == dest &&
+                std::filesystem::file_size(dest, ec) == entry.size && !ec &&
+                std::filesystem::last_write_time(dest, ec) == entry.mtime && !ec)
+            {
+                headers.emplace("If-None-Match", entry.etag);
+            }
+        }
+        cache_lock.unlock();
+
+        auto res = pool_.execute([&](httplib::Client& cli)
+        {
+            cli.set_read_timeout(30);
+            return cli.Get("/download?filename=" + utils::url_encode(enc_filename), headers,
+                           [&progress](uint64_t done, uint64_t total)
+            {
+                return !progress || progress(done, total);
+            });
+        });
         if (!res)
         {
-            return {false, "Cannot connect to server"};
+            return transport_failure(res);
+        }
+
+        if (res->status == 304)
+        {
+            return {true, "File unchanged: " + dest.string()};
         }
 
         if (res->status != 200)
         {
-            auto resp = json::parse(res->body, nullptr, false);
-            return {false, resp.is_object() ? resp.value("message", "Download failed")
-                                            : "Download failed"};
+            return http_failure(*res, "Download failed");
+        }
+
+        // SECURITY: CBC has no authentication, so damaged ciphertext would
+        // decrypt to garbage rather than fail; check it against the hash
+        // the server recorded when the file was written
+        if (!digest_matches(res->get_header_value("Repr-Digest"),
+                            crypto::sha256_hex(res->body.data(), res->body.size())))
+        {
+            return {false, kDamagedCopy};
         }
 
         // SECURITY: Decrypt the file after downloading from server
@@ -199,21 +463,19 @@ namespace vault::client
 
         try
         {
-            // Remove .enc extension for the output filename if present
-            std::string output_name = filename;
-            if (output_name.size() > 4 &&
-                output_name.substr(output_name.size() - 4) == ".enc")
+            utils::write_file_binary(dest, decrypted);
+
+            auto etag = res->get_header_value("ETag");
+            std::lock_guard<std::mutex> lock(cache_mutex_);
+            if (!etag.empty())
             {
-                output_name = output_name.substr(0, output_name.size() - 4);
+                download_cache_[enc_filename] = {etag, dest, std::filesystem::file_size(dest),
+                                                 std::filesystem::last_write_time(dest)};
             }
-
-            std::filesystem::path dest(dest_path);
-            if (std::filesystem::is_directory(dest))
+            else
             {
-                dest = dest / output_name;
+                download_cache_.erase(enc_filename);
             }
-
-            utils::write_file_binary(dest, decrypted);
             return {true, "File downloaded and decrypted: " + dest.string()};
         }
         catch (const std::exception& e)
@@ -222,26 +484,460 @@ namespace vault::client
         }
     }
 
-    std::vector<models::FileMeta> ApiClient::list_files()
+    ApiResult ApiClient::upload_stream(std::istream& in,
+                                        const std::string& remote_name,
+                                        const std::string& password,
+                                        const ProgressFn& progress)
     {
-        std::vector<models::FileMeta> files;
+        if (!is_authenticated())
+        {
+            return {false, "Not authenticated"};
+        }
 
-        if (token_.empty()) return files;
+        std::unique_ptr<crypto::StreamEncryptor> encryptor;
+        try
+        {
+            encryptor = std::make_unique<crypto::StreamEncryptor>(password);
+        }
+        catch (const std::exception& e)
+        {
+            return {false, std::string("Encryption failed: ") + e.what()};
+        }
 
-        httplib::Client cli(host_, port_);
-        cli.set_connection_timeout(5);
-        cli.set_read_timeout(10);
+        // SECURITY: Each slice is encrypted on the client before it is sent
+        std::vector<char> plain(kUploadSlice);
+        std::vector<uint8_t> cipher;
+        uint64_t consumed = 0;
+        std::string error;
 
-        httplib::Headers headers = 
+        auto provider = [&](size_t, httplib::DataSink& sink)
+        {
+            cipher.clear();
+            in.read(plain.data(), static_cast<std::streamsize>(plain.size()));
+            auto n = static_cast<size_t>(in.gcount());
+            if (in.bad())
+            {
+                error = "Cannot read input";
+                return false;
+            }
+
+            try
+            {
+                encryptor->update(reinterpret_cast<const uint8_t*>(plain.data()), n, cipher);
+                if (in.eof()) encryptor->finish(cipher);
+            }
+            catch (const std::exception& e)
+            {
+                error = std::string("Encryption failed: ") + e.what();
+                return false;
+            }
+
+            consumed += n;
+            if (!cipher.empty() &&
+                !sink.write(reinterpret_cast<const char*>(cipher.data()), cipher.size()))
+            {
+                return false;
+            }
+            if (in.eof()) sink.done();
+            return !progress || progress(consumed, 0);
+        };
+
+        auto headers = request_headers(true);
+
+        // No automatic retry: the input can't be rewound for a second attempt
+        auto res = pool_.execute([&](httplib::Client& cli)
+        {
+            cli.set_read_timeout(30);
+            return cli.Put("/upload?filename=" + utils::url_encode(remote_name), headers,
+                           provider, "application/octet-stream");
+        }, false);
+
+        if (!error.empty())
+        {
+            return {false, error};
+        }
+        if (!res)
+        {
+            return transport_failure(res);
+        }
+        if (res->status >= 300)
+        {
+            return http_failure(*res, "Upload failed");
+        }
+
+        auto resp = decode_body(*res);
+        if (resp.is_discarded())
+        {
+            return {false, "Invalid server response"};
+        }
+
+        return
+        {
+            resp.value("success", false),
+            resp.value("message", "Unknown error")
+        };
+    }
+
+    ApiResult ApiClient::download_stream(const std::string& filename,
+                                          std::ostream& out,
+                                          const std::string& password,
+                                          const ProgressFn& progress)
+    {
+        if (!is_authenticated())
+        {
+            return {false, "Not authenticated"};
+        }
+
+        // The server stores files with .enc extension
+        std::string enc_filename = filename;
+        if (enc_filename.find(".enc") == std::string::npos)
+        {
+            enc_filename += ".enc";
+        }
+
+        // SECURITY: Decrypted slice by slice as the ciphertext arrives
+        crypto::StreamDecryptor decryptor(password);
+        std::vector<uint8_t> plain;
+        std::string error;
+        auto flush = [&]
         {
-            {"Authorization", "Bearer " + token_}
+            out.write(reinterpret_cast<const char*>(plain.data()),
+                      static_cast<std::streamsize>(plain.size()));
+            plain.clear();
+            if (!out) error = "Cannot write output";
+            return static_cast<bool>(out);
         };
 
-        auto res = cli.Get("/list", headers);
-        if (!res || res->status != 200) return files;
+        int status = 0;
+        uint64_t total = 0;
+        uint64_t received = 0;
+        std::string error_body;
+        std::string repr_digest;
+        crypto::Sha256 hasher;
 
-        auto resp = json::parse(res->body, nullptr, false);
-        if (resp.is_discarded() || !resp.contains("files")) return files;
+        httplib::Request req;
+        req.method = "GET";
+        req.path = "/download?filename=" + utils::url_encode(enc_filename);
+        req.headers = request_headers(true);
+        req.response_handler = [&](const httplib::Response& response)
+        {
+            status = response.status;
+            repr_digest = response.get_header_value("Repr-Digest");
+            if (response.has_header("Content-Length"))
+            {
+                total = std::strtoull(response.get_header_value("Content-Length").c_str(), nullptr, 10);
+            }
+            return true;
+        };
+        req.content_receiver = [&](const char* data, size_t len, uint64_t, uint64_t)
+        {
+            if (status != 200)
+            {
+                error_body.append(data, len);
+                return true;
+            }
+            hasher.update(data, len);
+            try
+            {
+                decryptor.update(reinterpret_cast<const uint8_t*>(data), len, plain);
+            }
+            catch (const std::exception& e)
+            {
+                error = std::string("Decryption failed: ") + e.what();
+                return false;
+            }
+            received += len;
+            return flush() && (!progress || progress(received, total));
+        };
+
+        // No automatic retry: part of the output may already be written
+        auto res = pool_.execute([&](httplib::Client& cli)
+        {
+            cli.set_read_timeout(30);
+            return cli.send(req);
+        }, false);
+
+        if (!error.empty())
+        {
+            return {false, error};
+        }
+        if (!res)
+        {
+            return transport_failure(res);
+        }
+        if (status != 200)
+        {
+            httplib::Response error_response = *res;
+            error_response.body = std::move(error_body);
+            return http_failure(error_response, "Download failed");
+        }
+
+        // Most of the output is already written by now; all that's left is
+        // to withhold the final block and report the damage
+        if (!digest_matches(repr_digest, hasher.final_hex()))
+        {
+            return {false, kDamagedCopy};
+        }
+
+        try
+        {
+            decryptor.finish(plain);
+        }
+        catch (const std::exception& e)
+        {
+            return {false, std::string("Decryption failed: ") + e.what()};
+        }
+        if (!flush() || !out.flush())
+        {
+            return {false, "Cannot write output"};
+        }
+        return {true, "File downloaded and decrypted"};
+    }
+
+    ApiResult ApiClient::download_files(const std::vector<std::string>& filenames,
+                                         const std::string& dest_dir,
+                                         const std::string& password)
+    {
+        if (filenames.empty())
+        {
+            return {false, "No files selected"};
+        }
+        json body = {{"files", filenames}};
+        return download_archive(body.dump(), dest_dir, password);
+    }
+
+    ApiResult ApiClient::download_all(const std::string& dest_dir,
+                                       const std::string& password,
+                                       const std::string& prefix)
+    {
+        json body = {{"prefix", prefix}};
+        return download_archive(body.dump(), dest_dir, password);
+    }
+
+    ApiResult ApiClient::download_archive(const std::string& selection,
+                                           const std::string& dest_dir,
+                                           const std::string& password)
+    {
+        if (!is_authenticated())
+        {
+            return {false, "Not authenticated"};
+        }
+
+        try
+        {
+            std::filesystem::create_directories(dest_dir);
+        }
+        catch (const std::exception& e)
+        {
+            return {false, std::string("Cannot create destination: ") + e.what()};
+        }
+
+        /// Per-entry unpack state; each file goes to "<name>.part" and is
+        /// renamed into place only once it decrypts cleanly
+        struct Unpack
+        {
+            std::unique_ptr<crypto::StreamDecryptor> decryptor;
+            std::ofstream out;
+            std::filesystem::path part_path;
+            std::filesystem::path final_path;
+            std::vector<uint8_t> plain;
+            size_t restored = 0;
+            std::string error;
+
+            bool flush()
+            {
+                out.write(reinterpret_cast<const char*>(plain.data()),
+                          static_cast<std::streamsize>(plain.size()));
+                plain.clear();
+                return static_cast<bool>(out);
+            }
+
+            void abandon()
+            {
+                if (out.is_open()) out.close();
+                if (!part_path.empty())
+                {
+                    std::error_code ec;
+                    std::filesystem::remove(part_path, ec);
+                    part_path.clear();
+                }
+            }
+        } unpack;
+
+        utils::TarReader tar;
+        tar.on_entry = [&](const std::string& name, std::uint64_t)
+        {
+            // SECURITY: Never let an archive name escape the destination directory
+            std::string output_name = utils::extract_filename(name);
+            if (output_name.size() > 4 && output_name.substr(output_name.size() - 4) == ".enc")
+            {
+                output_name.resize(output_name.size() - 4);
+            }
+            if (output_name.empty() || output_name == "." || output_name == "..")
+            {
+                unpack.error = "Invalid file name in archive: " + name;
+                return false;
+            }
+
+            unpack.final_path = std::filesystem::path(dest_dir) / output_name;
+            unpack.part_path = unpack.final_path;
+            unpack.part_path += ".part";
+            unpack.out.open(unpack.part_path, std::ios::binary | std::ios::trunc);
+            if (!unpack.out)
+            {
+                unpack.error = "Cannot save file: " + unpack.part_path.string();
+                return false;
+            }
+            unpack.decryptor = std::make_unique<crypto::StreamDecryptor>(password);
+            return true;
+        };
+        tar.on_data = [&](const char* data, size_t len)
+        {
+            try
+            {
+                unpack.decryptor->update(reinterpret_cast<const uint8_t*>(data), len, unpack.plain);
+            }
+            catch (const std::exception& e)
+            {
+                unpack.error = std::string("Decryption failed: ") + e.what();
+                return false;
+            }
+            if (!unpack.flush())
+            {
+                unpack.error = "Cannot save file: " + unpack.part_path.string();
+                return false;
+            }
+            return true;
+        };
+        tar.on_entry_end = [&]()
+        {
+            try
+            {
+                unpack.decryptor->finish(unpack.plain);
+            }
+            catch (const std::exception& e)
+            {
+                unpack.error = std::string("Decryption failed for ") +
+                               unpack.final_path.filename().string() + ": " + e.what();
+                return false;
+            }
+            if (!unpack.flush())
+            {
+                unpack.error = "Cannot save file: " + unpack.part_path.string();
+                return false;
+            }
+            unpack.out.close();
+
+            std::error_code ec;
+            std::filesystem::rename(unpack.part_path, unpack.final_path, ec);
+            if (ec)
+            {
+                unpack.error = "Cannot save file: " + ec.message();
+                return false;
+            }
+            unpack.part_path.clear();
+            ++unpack.restored;
+            return true;
+        };
+
+        // PERF: The archive is consumed as it arrives — no whole-body buffering
+        int status = 0;
+        std::string error_body;
+
+        httplib::Request req;
+        req.method = "POST";
+        req.path = "/download-batch";
+        req.headers = request_headers(true);
+        req.set_header("Content-Type", "application/json");
+        req.body = selection;
+        req.response_handler = [&status](const httplib::Response& response)
+        {
+            status = response.status;
+            return true;
+        };
+        req.content_receiver = [&](const char* data, size_t len, uint64_t, uint64_t)
+        {
+            if (status != 200)
+            {
+                error_body.append(data, len);
+                return true;
+            }
+            return tar.feed(data, len);
+        };
+
+        // No automatic retry: the unpacker must never see a second stream
+        auto res = pool_.execute([&](httplib::Client& cli)
+        {
+            cli.set_read_timeout(30);
+            return cli.send(req);
+        }, false);
+        unpack.abandon();
+
+        if (!unpack.error.empty())
+        {
+            return {false, unpack.error};
+        }
+        if (!res)
+        {
+            return {false, tar.error().empty() ? "Cannot connect to server" : tar.error()};
+        }
+        if (status != 200)
+        {
+            httplib::Response error_response = *res;
+            error_response.body = std::move(error_body);
+            auto resp = decode_body(error_response);
+            return {false, resp.is_object() ? resp.value("message", "Download failed")
+                                            : "Download failed"};
+        }
+        if (!tar.finished())
+        {
+            return {false, "Download interrupted after " + std::to_string(unpack.restored) + " files"};
+        }
+
+        return {true, std::to_string(unpack.restored) + " files downloaded and decrypted to " + dest_dir};
+    }
+
+    FileListing ApiClient::list_files()
+    {
+        FileListing listing;
+
+        if (!is_authenticated()) return listing;
+
+        auto cache_path = listing_cache_path();
+        auto headers = request_headers(true);
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex_);
+            load_listing_cache();
+            if (!list_etag_.empty())
+            {
+                headers.emplace("If-None-Match", list_etag_);
+            }
+            if (!list_modified_.empty())
+            {
+                headers.emplace("If-Modified-Since", list_modified_);
+            }
+        }
+
+        auto res = pool_.execute([&](httplib::Client& cli)
+        {
+            cli.set_read_timeout(10);
+            return cli.Get("/list", headers);
+        });
+        if (res && res->status == 304)
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex_);
+            if (list_cache_)
+            {
+                listing.ok = true;
+                listing.not_modified = true;
+                listing.files = *list_cache_;
+            }
+            return listing;
+        }
+        if (!res || res->status != 200) return listing;
+
+        auto resp = decode_body(*res);
+        if (resp.is_discarded() || !resp.contains("files")) return listing;
 
         for (const auto& f : resp["files"])
         {
@@ -249,15 +945,161 @@ namespace vault::client
             meta.filename = f.value("filename", "");
             meta.size = f.value("size", static_cast<size_t>(0));
             meta.uploaded_at = f.value("uploaded_at", "");
-            files.push_back(std::move(meta));
+            listing.files.push_back(std::move(meta));
+        }
+        listing.ok = true;
+
+        std::string etag = res->get_header_value("ETag");
+        std::string modified = res->get_header_value("Last-Modified");
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex_);
+            list_etag_ = etag;
+            list_modified_ = modified;
+            list_cache_ = listing.files;
+        }
+        save_listing_cache(cache_path, etag, modified, listing.files);
+        return listing;
+    }
+
+    std::optional<std::vector<models::FileMeta>> ApiClient::cached_files()
+    {
+        if (!is_authenticated()) return std::nullopt;
+
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        load_listing_cache();
+        return list_cache_;
+    }
+
+    // ─── Listing cache ──────────────────────────────────────────────────────────
+
+    void ApiClient::set_cache_dir(const std::filesystem::path& dir)
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        cache_dir_ = dir;
+        list_cache_loaded_ = false;
+    }
+
+    /// `<host>_<port>_<user>.list`, with anything that isn't safe in a file
+    /// name on every platform escaped
+    static std::string listing_cache_name(const std::string& host, int port, const std::string& user)
+    {
+        std::string name = host + "_" + std::to_string(port) + "_";
+        for (unsigned char c : user)
+        {
+            if (std::isalnum(c) || c == '-' || c == '.')
+            {
+                name += static_cast<char>(c);
+            }
+            else
+            {
+                char hex[4];
+                std::snprintf(hex, sizeof(hex), "_%02x", c);
+                name += hex;
+            }
+        }
+        return name + ".list";
+    }
+
+    std::filesystem::path ApiClient::listing_cache_path() const
+    {
+        std::string user = username();
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        if (cache_dir_.empty() || user.empty()) return {};
+        return cache_dir_ / listing_cache_name(host_, port_, user);
+    }
+
+    void ApiClient::load_listing_cache()
+    {
+        if (list_cache_loaded_) return;
+        list_cache_loaded_ = true;
+
+        std::string user = username();
+        if (cache_dir_.empty() || user.empty()) return;
+
+        std::ifstream in(cache_dir_ / listing_cache_name(host_, port_, user), std::ios::binary);
+        if (!in) return;
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+        // A cache we can't read is simply ignored; the next listing replaces it
+        auto doc = json::from_msgpack(bytes, true, false);
+        if (doc.is_discarded() || doc.value("version", 0) != 1 || !doc.contains("files")) return;
+
+        std::vector<models::FileMeta> files;
+        try
+        {
+            files.reserve(doc["files"].size());
+            for (const auto& f : doc["files"])
+            {
+                models::FileMeta meta;
+                meta.filename = f.at(0).get<std::string>();
+                meta.size = f.at(1).get<size_t>();
+                meta.uploaded_at = f.at(2).get<std::string>();
+                files.push_back(std::move(meta));
+            }
+        }
+        catch (const json::exception&)
+        {
+            return;
         }
 
-        return files;
+        list_etag_ = doc.value("etag", "");
+        list_modified_ = doc.value("last_modified", "");
+        list_cache_ = std::move(files);
+    }
+
+    void ApiClient::save_listing_cache(const std::filesystem::path& path, const std::string& etag,
+                                       const std::string& modified,
+                                       const std::vector<models::FileMeta>& files) const
+    {
+        if (path.empty()) return;
+
+        // PERF: Rows are [name, size, date] arrays in MessagePack, so a large
+        // listing loads at startup without parsing repeated JSON keys
+        json doc;
+        doc["version"] = 1;
+        doc["etag"] = etag;
+        doc["last_modified"] = modified;
+        json rows = json::array();
+        for (const auto& f : files)
+        {
+            rows.push_back(json::array({f.filename, f.size, f.uploaded_at}));
+        }
+        doc["files"] = std::move(rows);
+        auto bytes = json::to_msgpack(doc);
+
+        // Best effort: a failed write only costs the next startup a full fetch
+        std::error_code ec;
+        std::filesystem::create_directories(path.parent_path(), ec);
+        std::filesystem::permissions(path.parent_path(), std::filesystem::perms::owner_all,
+                                     std::filesystem::perm_options::replace, ec);
+
+        auto tmp = path;
+        tmp += ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            if (!out) return;
+            out.write(reinterpret_cast<const char*>(bytes.data()),
+                      static_cast<std::streamsize>(bytes.size()));
+            if (!out) return;
+        }
+        std::filesystem::rename(tmp, path, ec);
+        if (ec) std::filesystem::remove(tmp, ec);
     }
 
     void ApiClient::logout()
     {
-        token_.clear();
-        username_.clear();
+        {
+            std::lock_guard<std::mutex> lock(session_mutex_);
+            token_.clear();
+            username_.clear();
+        }
+
+        // Validators belong to the previous user's view of the vault
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        download_cache_.clear();
+        list_etag_.clear();
+        list_modified_.clear();
+        list_cache_.reset();
+        list_cache_loaded_ = false;   // the on-disk copy stays for the next login
     }
 }
\ No newline at end of file
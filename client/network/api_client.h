@@ -1,11 +1,20 @@
 #pragma once
 
 #include "models/file_meta.h"
+#include "network/connection_pool.h"
+#include "utils/structured_writer.h"
+
+#include <httplib.h>
 
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <filesystem>
 #include <functional>
+#include <iosfwd>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
 
 namespace vault::client 
 {
@@ -16,13 +25,29 @@ namespace vault::client
         bool success = false;
         std::string message;
         std::vector<uint8_t> data;   // Raw response data (for downloads)
+        int status = 0;              // HTTP status, 0 if no response arrived
+        bool transient = false;      // worth retrying: network error, 429 or 502-504
+        int retry_after = 0;         // seconds the server asked us to wait, if any
+    };
+
+    /// Outcome of ApiClient::list_files
+    struct FileListing
+    {
+        bool ok = false;              // false if the server couldn't be reached or refused
+        bool not_modified = false;    // the server answered 304; files are the cached copy
+        std::vector<models::FileMeta> files;
     };
 
-    /// HTTP client wrapper for VaultCLI server communication
+    /// Transfer progress callback: (bytes done, bytes total). Return false to cancel.
+    using ProgressFn = std::function<bool(uint64_t done, uint64_t total)>;
+
+    /// HTTP client wrapper for VaultCLI server communication.
+    /// Safe to share between threads: requests run on a pool of up to
+    /// `max_connections` keep-alive connections.
     class ApiClient 
     {
     public:
-        ApiClient(const std::string& host, int port);
+        ApiClient(const std::string& host, int port, size_t max_connections = 4);
 
         /// Register a new user
         ApiResult register_user(const std::string& username, const std::string& password);
@@ -30,31 +55,126 @@ namespace vault::client
         /// Log in and store the session token
         ApiResult login(const std::string& username, const std::string& password);
 
-        /// Upload a file (encrypts on client side before sending)
-        ApiResult upload_file(const std::string& filepath, const std::string& password);
+        /// Upload a file (encrypts on client side before sending). It is
+        /// stored under `remote_name`, or the file's own name when empty.
+        ApiResult upload_file(const std::string& filepath, const std::string& password,
+                              const ProgressFn& progress = nullptr,
+                              const std::string& remote_name = "");
+
+        /// Encrypt `in` as it is read and stream it to the server under
+        /// `remote_name`, holding only one slice in memory. The length need
+        /// not be known (a pipe works); progress reports a total of 0.
+        ApiResult upload_stream(std::istream& in, const std::string& remote_name,
+                                const std::string& password,
+                                const ProgressFn& progress = nullptr);
+
+        /// Download a file and write its plaintext to `out` as it arrives.
+        /// A wrong password is only detected at the end, after some output
+        /// has been written, so callers must check the result.
+        ApiResult download_stream(const std::string& filename, std::ostream& out,
+                                  const std::string& password,
+                                  const ProgressFn& progress = nullptr);
+
+        /// Upload many files, packed into size-bounded multipart batches so
+        /// small files share a request. Returns one result per path, in order.
+        std::vector<ApiResult> upload_files(const std::vector<std::string>& filepaths,
+                                            const std::string& password);
 
         /// Download a file (decrypts after receiving)
         ApiResult download_file(const std::string& filename,
                                 const std::string& dest_path,
-                                const std::string& password);
+                                const std::string& password,
+                                const ProgressFn& progress = nullptr);
+
+        /// Download several files as one streamed archive, decrypting each
+        /// into `dest_dir` as it arrives. One request regardless of count.
+        ApiResult download_files(const std::vector<std::string>& filenames,
+                                 const std::string& dest_dir,
+                                 const std::string& password);
+
+        /// Restore every stored file whose name starts with `prefix`
+        /// (all of them when empty) into `dest_dir`
+        ApiResult download_all(const std::string& dest_dir,
+                               const std::string& password,
+                               const std::string& prefix = "");
+
+        /// List files stored on the server, revalidating the cached listing
+        /// with a conditional request when there is one
+        FileListing list_files();
 
-        /// List files stored on the server
-        std::vector<models::FileMeta> list_files();
+        /// Last listing seen for the logged-in user, from memory or the
+        /// on-disk cache, without touching the network
+        std::optional<std::vector<models::FileMeta>> cached_files();
+
+        /// Directory for the persistent listing cache (empty disables it).
+        /// Listings are kept per server and user, so the next run can show
+        /// them before the first request completes.
+        void set_cache_dir(const std::filesystem::path& dir);
 
         /// Logout (clear session)
         void logout();
 
         /// Check if currently authenticated
-        bool is_authenticated() const { return !token_.empty(); }
+        bool is_authenticated() const;
 
         /// Get the current username
-        const std::string& username() const { return username_; }
+        std::string username() const;
+
+        /// Response encoding to request via Accept (MessagePack by default)
+        void set_encoding(utils::Encoding encoding) { encoding_ = encoding; }
 
     private:
+        /// Accept header, plus the bearer token when `authenticated`
+        httplib::Headers request_headers(bool authenticated) const;
+
+        /// POST one multipart batch and fill in the results for its parts
+        void send_upload_batch(const httplib::MultipartFormDataItems& items,
+                               const std::vector<size_t>& indices,
+                               std::vector<ApiResult>& results);
+
+        /// Cache file for the current user's listing, empty if caching is off
+        std::filesystem::path listing_cache_path() const;
+
+        /// Fill the in-memory listing and validators from disk. Caller holds cache_mutex_.
+        void load_listing_cache();
+
+        /// Write the listing and its validators to disk
+        void save_listing_cache(const std::filesystem::path& path, const std::string& etag,
+                                const std::string& modified,
+                                const std::vector<models::FileMeta>& files) const;
+
+        /// POST a /download-batch selection and unpack the archive into `dest_dir`
+        ApiResult download_archive(const std::string& selection,
+                                   const std::string& dest_dir,
+                                   const std::string& password);
+
         std::string host_;
         int port_;
+        ConnectionPool pool_;
+
+        mutable std::mutex session_mutex_;   // guards token_ and username_
         std::string token_;
         std::string username_;
+        utils::Encoding encoding_ = utils::Encoding::Msgpack;
+
+        /// A downloaded file is revalidated only while the local copy is
+        /// exactly what we wrote, so edits on disk force a fresh download
+        struct CachedDownload
+        {
+            std::string etag;
+            std::filesystem::path dest;
+            std::uintmax_t size = 0;
+            std::filesystem::file_time_type mtime;
+        };
+
+        // Validator cache for conditional requests, keyed by stored name
+        mutable std::mutex cache_mutex_;
+        std::unordered_map<std::string, CachedDownload> download_cache_;
+        std::string list_etag_;
+        std::string list_modified_;
+        std::optional<std::vector<models::FileMeta>> list_cache_;
+        bool list_cache_loaded_ = false;     // disk cache consulted for this user
+        std::filesystem::path cache_dir_;
     };
 
 } // namespace vault::client
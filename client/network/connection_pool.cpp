@@ -0,0 +1,144 @@
+#include "network/connection_pool.h"
+
+namespace vault::client
+{
+
+    /// Failures that leave no doubt the server never answered: the socket
+    /// couldn't be used or the request couldn't be sent. Repeating those is
+    /// safe even for a POST. A read error may follow a response the server
+    /// already acted on, and Canceled means the caller gave up on purpose.
+    static bool failed_before_response(httplib::Error error)
+    {
+        return error == httplib::Error::Connection || error == httplib::Error::Write;
+    }
+
+    ConnectionPool::ConnectionPool(std::string host, int port, Options options)
+        : host_(std::move(host)), port_(port), options_(options)
+    {
+        if (options_.max_connections == 0) options_.max_connections = 1;
+    }
+
+    ConnectionPool::~ConnectionPool()
+    {
+        clear();
+    }
+
+    std::unique_ptr<httplib::Client> ConnectionPool::connect() const
+    {
+        // The socket opens lazily on the first request and then stays up
+        auto client = std::make_unique<httplib::Client>(host_, port_);
+        client->set_keep_alive(true);
+        client->set_tcp_nodelay(true);
+        client->set_connection_timeout(options_.connect_timeout);
+        return client;
+    }
+
+    ConnectionPool::Connection ConnectionPool::acquire()
+    {
+        std::vector<Connection> stale;   // closed outside the lock
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        for (;;)
+        {
+            auto now = std::chrono::steady_clock::now();
+            while (!idle_.empty())
+            {
+                Connection c = std::move(idle_.back());
+                idle_.pop_back();
+
+                // Health check: a connection idle past the server's keep-alive
+                // timeout is almost certainly closed on the other end
+                if (now - c.returned > options_.max_idle)
+                {
+                    --open_;
+                    stale.push_back(std::move(c));
+                    continue;
+                }
+                return c;
+            }
+
+            if (open_ < options_.max_connections)
+            {
+                ++open_;
+                lock.unlock();
+                return Connection{connect(), {}, false};
+            }
+
+            available_.wait(lock);
+        }
+    }
+
+    void ConnectionPool::release(Connection connection, bool healthy)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (healthy)
+            {
+                connection.returned = std::chrono::steady_clock::now();
+                idle_.push_back(std::move(connection));
+            }
+            else
+            {
+                --open_;
+            }
+        }
+        available_.notify_one();
+    }
+
+    httplib::Result ConnectionPool::execute(const std::function<httplib::Result(httplib::Client&)>& request,
+                                            bool retry)
+    {
+        for (int attempt = 0;; ++attempt)
+        {
+            Connection c = acquire();
+            bool reused = c.used && c.client->is_socket_open();
+
+            httplib::Result result;
+            try
+            {
+                result = request(*c.client);
+            }
+            catch (...)
+            {
+                release(std::move(c), false);
+                throw;
+            }
+            c.used = true;
+
+            bool failed = !result;
+            release(std::move(c), !failed);
+
+            // Reconnect: if one pooled socket went stale the rest likely did too
+            if (failed && reused && retry && attempt == 0 && failed_before_response(result.error()))
+            {
+                clear();
+                continue;
+            }
+            return result;
+        }
+    }
+
+    std::size_t ConnectionPool::idle_count() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return idle_.size();
+    }
+
+    std::size_t ConnectionPool::open_count() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return open_;
+    }
+
+    void ConnectionPool::clear()
+    {
+        std::vector<Connection> closing;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            open_ -= idle_.size();
+            closing.swap(idle_);
+        }
+        available_.notify_all();
+    }
+
+} // namespace vault::client
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <httplib.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace vault::client
+{
+
+    /// Keep-alive HTTP connections to one server, shared between threads.
+    ///
+    /// httplib::Client is not safe for concurrent requests, so each request
+    /// borrows a client exclusively and hands it back afterwards with its
+    /// socket still open. At most `max_connections` exist at once; callers
+    /// beyond that wait for one to be returned.
+    class ConnectionPool
+    {
+    public:
+        struct Options
+        {
+            std::size_t max_connections = 4;
+            std::time_t connect_timeout = 5;                 // seconds
+            std::chrono::milliseconds max_idle{4000};        // below the server's keep-alive timeout
+        };
+
+        ConnectionPool(std::string host, int port, Options options);
+        ~ConnectionPool();
+
+        ConnectionPool(const ConnectionPool&) = delete;
+        ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+        /// Run `request` on a pooled connection.
+        ///
+        /// A connection the server closed while it sat idle only shows up as
+        /// a transport error on the next request. When a reused connection
+        /// fails to connect or to send the request and `retry` is set, the
+        /// request is repeated once on a fresh connection. Read errors and
+        /// cancelled transfers are never repeated, since the server may
+        /// already have acted on the request. Pass retry = false for
+        /// requests whose callbacks must not observe a second attempt.
+        httplib::Result execute(const std::function<httplib::Result(httplib::Client&)>& request,
+                                bool retry = true);
+
+        std::size_t max_connections() const { return options_.max_connections; }
+
+        /// Connections currently parked in the pool
+        std::size_t idle_count() const;
+
+        /// Connections that exist, idle or borrowed
+        std::size_t open_count() const;
+
+        /// Close every idle connection (e.g. after the server restarted)
+        void clear();
+
+    private:
+        struct Connection
+        {
+            std::unique_ptr<httplib::Client> client;
+            std::chrono::steady_clock::time_point returned;   // when it last went idle
+            bool used = false;                                // has served a request
+        };
+
+        Connection acquire();
+        void release(Connection connection, bool healthy);
+        std::unique_ptr<httplib::Client> connect() const;
+
+        std::string host_;
+        int port_;
+        Options options_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable available_;
+        std::vector<Connection> idle_;   // most recently returned at the back
+        std::size_t open_ = 0;
+    };
+
+} // namespace vault::client
@@ -0,0 +1,311 @@
+#include "network/transfer_manager.h"
+
+#include <algorithm>
+#include <random>
+
+namespace vault::client
+{
+
+    const char* to_string(TransferState state)
+    {
+        switch (state)
+        {
+            case TransferState::Queued:    return "queued";
+            case TransferState::Running:   return "running";
+            case TransferState::Retrying:  return "retrying";
+            case TransferState::Done:      return "done";
+            case TransferState::Failed:    return "failed";
+            case TransferState::Cancelled: return "cancelled";
+        }
+        return "unknown";
+    }
+
+    static bool is_finished(TransferState state)
+    {
+        return state == TransferState::Done || state == TransferState::Failed ||
+               state == TransferState::Cancelled;
+    }
+
+    TransferManager::TransferManager(std::shared_ptr<ApiClient> api, TransferOptions options)
+        : api_(std::move(api)),
+          options_(options),
+          pool_(std::max<std::size_t>(options.concurrency, 1))
+    {
+    }
+
+    TransferManager::~TransferManager()
+    {
+        // Queued jobs still run, but only to record that they were cancelled
+        cancel_all();
+        pool_.shutdown();
+    }
+
+    // ─── Queueing ───────────────────────────────────────────────────────────────
+
+    TransferManager::Id TransferManager::enqueue_upload(const std::string& filepath,
+                                                        const std::string& password,
+                                                        const std::string& remote_name)
+    {
+        auto job = std::make_shared<Job>();
+        job->progress.kind = TransferKind::Upload;
+        job->progress.name = filepath;
+        job->source = filepath;
+        job->dest = remote_name;
+        job->password = password;
+        return enqueue(std::move(job));
+    }
+
+    TransferManager::Id TransferManager::enqueue_download(const std::string& filename,
+                                                          const std::string& dest_path,
+                                                          const std::string& password)
+    {
+        auto job = std::make_shared<Job>();
+        job->progress.kind = TransferKind::Download;
+        job->progress.name = filename;
+        job->source = filename;
+        job->dest = dest_path;
+        job->password = password;
+        return enqueue(std::move(job));
+    }
+
+    TransferManager::Id TransferManager::enqueue(std::shared_ptr<Job> job)
+    {
+        Id id;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            id = next_id_++;
+            job->progress.id = id;
+            jobs_.emplace(id, job);
+            order_.push_back(id);
+            ++active_;
+        }
+        notify(job->progress);
+
+        if (!pool_.try_submit([this, job] { run(job); }))
+        {
+            // Only happens while shutting down
+            job->cancelled = true;
+            set_state(job, TransferState::Cancelled, "Cancelled");
+            std::lock_guard<std::mutex> lock(mutex_);
+            --active_;
+            changed_.notify_all();
+        }
+        return id;
+    }
+
+    bool TransferManager::cancel(Id id)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = jobs_.find(id);
+        if (it == jobs_.end() || is_finished(it->second->progress.state)) return false;
+
+        it->second->cancelled = true;
+        changed_.notify_all();   // wakes a job sleeping in backoff
+        return true;
+    }
+
+    void TransferManager::cancel_all()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& [id, job] : jobs_)
+        {
+            job->cancelled = true;
+        }
+        changed_.notify_all();
+    }
+
+    void TransferManager::set_listener(Listener listener)
+    {
+        std::lock_guard<std::mutex> lock(listener_mutex_);
+        listener_ = std::move(listener);
+    }
+
+    // ─── Execution ──────────────────────────────────────────────────────────────
+
+    void TransferManager::run(const std::shared_ptr<Job>& job)
+    {
+        thread_local std::mt19937 rng{std::random_device{}()};
+
+        for (int attempt_no = 1;; ++attempt_no)
+        {
+            if (job->cancelled)
+            {
+                set_state(job, TransferState::Cancelled, "Cancelled");
+                break;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                job->progress.attempts = attempt_no;
+                job->progress.bytes_done = 0;
+                job->progress.bytes_per_sec = 0.0;
+                job->attempt_start = std::chrono::steady_clock::now();
+            }
+            set_state(job, TransferState::Running);
+
+            ApiResult result = attempt(job);
+
+            if (job->cancelled)
+            {
+                set_state(job, TransferState::Cancelled, "Cancelled");
+                break;
+            }
+            if (result.success)
+            {
+                set_state(job, TransferState::Done, result.message);
+                break;
+            }
+            if (!result.transient || attempt_no >= options_.max_attempts)
+            {
+                set_state(job, TransferState::Failed, result.message);
+                break;
+            }
+
+            // Exponential backoff with up to 25% jitter so a burst of failed
+            // transfers doesn't retry in lockstep; the server's Retry-After wins
+            auto delay = options_.initial_backoff * (1 << std::min(attempt_no - 1, 16));
+            delay = std::min(delay, options_.max_backoff);
+            delay += std::chrono::milliseconds(
+                std::uniform_int_distribution<long long>(0, delay.count() / 4)(rng));
+            if (result.retry_after > 0)
+            {
+                delay = std::max<std::chrono::milliseconds>(delay, std::chrono::seconds(result.retry_after));
+            }
+
+            set_state(job, TransferState::Retrying,
+                      result.message + " (retrying in " +
+                      std::to_string((delay.count() + 999) / 1000) + "s)");
+
+            std::unique_lock<std::mutex> lock(mutex_);
+            changed_.wait_for(lock, delay, [&job] { return job->cancelled.load(); });
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        --active_;
+        changed_.notify_all();
+    }
+
+    ApiResult TransferManager::attempt(const std::shared_ptr<Job>& job)
+    {
+        auto progress = [this, &job](std::uint64_t done, std::uint64_t total)
+        {
+            return on_progress(job, done, total);
+        };
+
+        try
+        {
+            if (job->progress.kind == TransferKind::Upload)
+            {
+                return api_->upload_file(job->source, job->password, progress, job->dest);
+            }
+            return api_->download_file(job->source, job->dest, job->password, progress);
+        }
+        catch (const std::exception& e)
+        {
+            return {false, e.what()};
+        }
+    }
+
+    bool TransferManager::on_progress(const std::shared_ptr<Job>& job,
+                                      std::uint64_t done, std::uint64_t total)
+    {
+        if (job->cancelled) return false;
+
+        TransferProgress copy;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto now = std::chrono::steady_clock::now();
+            auto& p = job->progress;
+            p.bytes_done = done;
+            p.bytes_total = total;
+
+            double elapsed = std::chrono::duration<double>(now - job->attempt_start).count();
+            p.bytes_per_sec = elapsed > 0 ? static_cast<double>(done) / elapsed : 0.0;
+
+            // PERF: Progress fires per 64 KiB slice; listeners only need a few updates a second
+            if (now - job->last_notify < options_.notify_interval && done != total) return true;
+            job->last_notify = now;
+            copy = p;
+        }
+        notify(copy);
+        return !job->cancelled;
+    }
+
+    void TransferManager::set_state(const std::shared_ptr<Job>& job, TransferState state,
+                                    const std::string& message)
+    {
+        TransferProgress copy;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job->progress.state = state;
+            job->progress.message = message;
+            if (is_finished(state) || state == TransferState::Retrying)
+            {
+                job->progress.bytes_per_sec = 0.0;
+            }
+            copy = job->progress;
+        }
+        notify(copy);
+    }
+
+    void TransferManager::notify(const TransferProgress& progress)
+    {
+        std::lock_guard<std::mutex> lock(listener_mutex_);
+        if (listener_) listener_(progress);
+    }
+
+    // ─── Inspection ─────────────────────────────────────────────────────────────
+
+    std::vector<TransferProgress> TransferManager::snapshot() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<TransferProgress> out;
+        out.reserve(order_.size());
+        for (Id id : order_)
+        {
+            out.push_back(jobs_.at(id)->progress);
+        }
+        return out;
+    }
+
+    AggregateProgress TransferManager::aggregate() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        AggregateProgress total;
+        for (const auto& [id, job] : jobs_)
+        {
+            const auto& p = job->progress;
+            switch (p.state)
+            {
+                case TransferState::Queued:    ++total.queued; break;
+                case TransferState::Running:
+                case TransferState::Retrying:  ++total.running; break;
+                case TransferState::Done:      ++total.done; break;
+                case TransferState::Failed:    ++total.failed; break;
+                case TransferState::Cancelled: ++total.cancelled; break;
+            }
+            total.bytes_done += p.bytes_done;
+            total.bytes_total += p.bytes_total;
+            total.bytes_per_sec += p.bytes_per_sec;
+        }
+        return total;
+    }
+
+    void TransferManager::clear_finished()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        order_.erase(std::remove_if(order_.begin(), order_.end(), [this](Id id)
+        {
+            if (!is_finished(jobs_.at(id)->progress.state)) return false;
+            jobs_.erase(id);
+            return true;
+        }), order_.end());
+    }
+
+    void TransferManager::wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait(lock, [this] { return active_ == 0; });
+    }
+
+} // namespace vault::client
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "network/api_client.h"
+#include "utils/thread_pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace vault::client
+{
+
+    enum class TransferKind { Upload, Download };
+
+    enum class TransferState { Queued, Running, Retrying, Done, Failed, Cancelled };
+
+    const char* to_string(TransferState state);
+
+    /// Point-in-time view of one transfer
+    struct TransferProgress
+    {
+        std::uint64_t id = 0;
+        TransferKind kind = TransferKind::Upload;
+        std::string name;                  // local path for uploads, remote name for downloads
+        TransferState state = TransferState::Queued;
+        std::uint64_t bytes_done = 0;
+        std::uint64_t bytes_total = 0;     // 0 until known
+        double bytes_per_sec = 0.0;        // over the current attempt
+        int attempts = 0;
+        std::string message;               // result or last error
+    };
+
+    /// Totals across every transfer the manager knows about
+    struct AggregateProgress
+    {
+        std::size_t queued = 0;
+        std::size_t running = 0;
+        std::size_t done = 0;
+        std::size_t failed = 0;
+        std::size_t cancelled = 0;
+        std::uint64_t bytes_done = 0;
+        std::uint64_t bytes_total = 0;
+        double bytes_per_sec = 0.0;        // sum over running transfers
+    };
+
+    struct TransferOptions
+    {
+        std::size_t concurrency = 4;
+        int max_attempts = 4;
+        std::chrono::milliseconds initial_backoff{500};    // doubled per retry
+        std::chrono::milliseconds max_backoff{15000};
+        std::chrono::milliseconds notify_interval{100};    // progress listener throttle
+    };
+
+    /// Queue of uploads and downloads run concurrently on a worker pool.
+    ///
+    /// Transient failures (network errors, 429, 502-504) are retried with
+    /// exponential backoff, honouring Retry-After. Everything is safe to
+    /// call from any thread; the listener runs on worker threads.
+    class TransferManager
+    {
+    public:
+        using Id = std::uint64_t;
+        using Listener = std::function<void(const TransferProgress&)>;
+
+        explicit TransferManager(std::shared_ptr<ApiClient> api, TransferOptions options = {});
+        ~TransferManager();
+
+        TransferManager(const TransferManager&) = delete;
+        TransferManager& operator=(const TransferManager&) = delete;
+
+        /// `remote_name` defaults to the file's own name
+        Id enqueue_upload(const std::string& filepath, const std::string& password,
+                          const std::string& remote_name = "");
+
+        Id enqueue_download(const std::string& filename, const std::string& dest_path,
+                            const std::string& password);
+
+        /// Stop a queued or running transfer. Returns false if it already finished.
+        bool cancel(Id id);
+        void cancel_all();
+
+        /// Called on state changes and, throttled, on progress
+        void set_listener(Listener listener);
+
+        std::vector<TransferProgress> snapshot() const;
+        AggregateProgress aggregate() const;
+
+        /// Forget transfers that have finished (done, failed or cancelled)
+        void clear_finished();
+
+        /// Block until nothing is queued or running
+        void wait();
+
+    private:
+        struct Job
+        {
+            TransferProgress progress;           // guarded by mutex_
+            std::string source;
+            std::string dest;                    // remote name for uploads, local path for downloads
+            std::string password;
+            std::atomic<bool> cancelled{false};
+            std::chrono::steady_clock::time_point attempt_start;
+            std::chrono::steady_clock::time_point last_notify;
+        };
+
+        Id enqueue(std::shared_ptr<Job> job);
+        void run(const std::shared_ptr<Job>& job);
+        ApiResult attempt(const std::shared_ptr<Job>& job);
+        bool on_progress(const std::shared_ptr<Job>& job, std::uint64_t done, std::uint64_t total);
+        void set_state(const std::shared_ptr<Job>& job, TransferState state,
+                       const std::string& message = "");
+        void notify(const TransferProgress& progress);
+
+        std::shared_ptr<ApiClient> api_;
+        TransferOptions options_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable changed_;    // state changes and cancellations
+        std::unordered_map<Id, std::shared_ptr<Job>> jobs_;
+        std::vector<Id> order_;              // enqueue order, for snapshots
+        Id next_id_ = 1;
+        std::size_t active_ = 0;             // queued + running + retrying
+
+        std::mutex listener_mutex_;
+        Listener listener_;
+
+        utils::ThreadPool pool_;             // last: joined before the rest is torn down
+    };
+
+} // namespace vault::client
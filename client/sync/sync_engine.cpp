@@ -0,0 +1,564 @@
+#include "sync/sync_engine.h"
+#include "sync/sync_state.h"
+#include "network/transfer_manager.h"
+#include "crypto/crypto.h"
+#include "utils/thread_pool.h"
+#include "utils/utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <ostream>
+#include <streambuf>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace vault::client
+{
+
+    /// Directory under the sync root that holds the state database
+    static constexpr const char* kStateDir = ".vaultsync";
+
+    /// Suffix the server gives stored objects
+    static constexpr const char* kEncSuffix = ".enc";
+
+    struct LocalFile
+    {
+        std::string rel;                  // generic '/' separators
+        std::uint64_t size = 0;
+        std::int64_t mtime = 0;
+        std::string sha256;               // empty until hashed
+        bool unreadable = false;
+    };
+
+    /// Stored size of a file of `plaintext` bytes: the 16-byte IV, then
+    /// AES-CBC with PKCS#7 padding, which always adds 1 to 16 bytes
+    static std::uint64_t ciphertext_size(std::uint64_t plaintext)
+    {
+        return 16 + (plaintext / 16 + 1) * 16;
+    }
+
+    /// Keeps only a running SHA-256 of what is written to it
+    class HashingBuf : public std::streambuf
+    {
+    public:
+        std::string hash() { return hasher_.final_hex(); }
+
+    protected:
+        std::streamsize xsputn(const char* data, std::streamsize n) override
+        {
+            hasher_.update(data, static_cast<std::size_t>(n));
+            return n;
+        }
+
+        int_type overflow(int_type c) override
+        {
+            if (!traits_type::eq_int_type(c, traits_type::eof()))
+            {
+                char ch = traits_type::to_char_type(c);
+                hasher_.update(&ch, 1);
+            }
+            return traits_type::not_eof(c);
+        }
+
+    private:
+        crypto::Sha256 hasher_;
+    };
+
+    // ─── Naming ─────────────────────────────────────────────────────────────────
+
+    std::string SyncEngine::remote_name(const std::string& prefix, const std::string& rel_path)
+    {
+        // Encoding '/' keeps every stored name a single flat path component,
+        // and always appending ".enc" makes the mapping reversible
+        return prefix + utils::url_encode(rel_path) + kEncSuffix;
+    }
+
+    std::optional<std::string> SyncEngine::local_path(const std::string& prefix,
+                                                      const std::string& remote_name)
+    {
+        std::size_t suffix = std::char_traits<char>::length(kEncSuffix);
+        if (remote_name.size() <= prefix.size() + suffix ||
+            remote_name.compare(0, prefix.size(), prefix) != 0 ||
+            remote_name.compare(remote_name.size() - suffix, suffix, kEncSuffix) != 0)
+        {
+            return std::nullopt;
+        }
+
+        std::string encoded = remote_name.substr(prefix.size(),
+                                                 remote_name.size() - prefix.size() - suffix);
+        std::string rel;
+        try
+        {
+            rel = utils::url_decode(encoded);
+        }
+        catch (const std::exception&)
+        {
+            return std::nullopt;
+        }
+
+        // Only names we would have produced ourselves, so a crafted or
+        // hand-uploaded name can never point outside the root
+        if (utils::url_encode(rel) != encoded) return std::nullopt;
+
+        std::size_t start = 0;
+        while (start <= rel.size())
+        {
+            std::size_t end = rel.find('/', start);
+            if (end == std::string::npos) end = rel.size();
+            std::string segment = rel.substr(start, end - start);
+            if (segment.empty() || segment == "." || segment == ".." ||
+                segment.find('\\') != std::string::npos || segment.find(':') != std::string::npos)
+            {
+                return std::nullopt;
+            }
+            if (start == 0 && segment == kStateDir) return std::nullopt;
+            start = end + 1;
+        }
+        return rel;
+    }
+
+    // ─── Local Scan ─────────────────────────────────────────────────────────────
+
+    /// Walk `root` with one task per directory, so wide and deep trees are
+    /// listed by all threads at once. Symlinks are not followed.
+    static std::vector<LocalFile> scan_tree(const fs::path& root, std::size_t threads,
+                                            std::size_t& unreadable_dirs)
+    {
+        utils::ThreadPool pool(std::max<std::size_t>(threads, 1));
+        std::mutex mutex;
+        std::condition_variable idle;
+        std::size_t pending = 0;
+        std::vector<LocalFile> files;
+        unreadable_dirs = 0;
+
+        std::function<void(const fs::path&, const std::string&)> visit;
+        auto spawn = [&](fs::path dir, std::string rel)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ++pending;
+            }
+            if (!pool.try_submit([&visit, dir, rel] { visit(dir, rel); }))
+            {
+                visit(dir, rel);
+            }
+        };
+
+        visit = [&](const fs::path& dir, const std::string& rel)
+        {
+            std::vector<LocalFile> found;
+            std::error_code ec;
+            fs::directory_iterator it(dir, fs::directory_options::skip_permission_denied, ec);
+            bool failed = static_cast<bool>(ec);
+
+            for (; !ec && it != fs::directory_iterator(); it.increment(ec))
+            {
+                std::error_code entry_ec;
+                auto status = it->symlink_status(entry_ec);
+                if (entry_ec) continue;
+
+                std::string name = it->path().filename().string();
+                std::string child = rel.empty() ? name : rel + "/" + name;
+
+                if (fs::is_directory(status))
+                {
+                    if (rel.empty() && name == kStateDir) continue;
+                    spawn(it->path(), child);
+                }
+                else if (fs::is_regular_file(status))
+                {
+                    LocalFile f;
+                    f.rel = std::move(child);
+                    f.size = it->file_size(entry_ec);
+                    if (!entry_ec) f.mtime = it->last_write_time(entry_ec).time_since_epoch().count();
+                    if (entry_ec) continue;
+                    found.push_back(std::move(f));
+                }
+            }
+            failed = failed || static_cast<bool>(ec);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (failed) ++unreadable_dirs;
+            files.insert(files.end(), std::make_move_iterator(found.begin()),
+                         std::make_move_iterator(found.end()));
+            if (--pending == 0) idle.notify_all();
+        };
+
+        spawn(root, "");
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            idle.wait(lock, [&pending] { return pending == 0; });
+        }
+        pool.shutdown();
+        return files;
+    }
+
+    /// Run fn(i) for every i in [0, count) on `threads` workers
+    static void parallel_for(std::size_t count, std::size_t threads,
+                             const std::function<void(std::size_t)>& fn)
+    {
+        if (count == 0) return;
+        threads = std::clamp<std::size_t>(threads, 1, count);
+
+        utils::ThreadPool pool(threads);
+        std::atomic<std::size_t> next{0};
+        for (std::size_t t = 0; t < threads; ++t)
+        {
+            pool.try_submit([&]
+            {
+                for (std::size_t i = next++; i < count; i = next++) fn(i);
+            });
+        }
+        pool.shutdown();
+    }
+
+    // ─── Sync ───────────────────────────────────────────────────────────────────
+
+    SyncEngine::SyncEngine(std::shared_ptr<ApiClient> api, fs::path root, SyncOptions options)
+        : api_(std::move(api)), root_(std::move(root)), options_(std::move(options))
+    {
+    }
+
+    void SyncEngine::log(const std::string& message) const
+    {
+        std::lock_guard<std::mutex> lock(log_mutex_);
+        if (log_) log_(message);
+    }
+
+    SyncReport SyncEngine::run()
+    {
+        SyncReport report;
+
+        if (!fs::is_directory(root_))
+        {
+            throw std::runtime_error("Not a directory: " + root_.string());
+        }
+
+        SyncState state(root_ / kStateDir / "state");
+        state.load();
+        auto& entries = state.entries();
+
+        auto listing = api_->list_files();
+        if (!listing.ok)
+        {
+            throw std::runtime_error("Cannot list files on the server");
+        }
+
+        std::unordered_map<std::string, const models::FileMeta*> remote;
+        for (const auto& f : listing.files)
+        {
+            if (local_path(options_.prefix, f.filename)) remote.emplace(f.filename, &f);
+        }
+
+        // ── Detect local changes ────────────────────────────────────────────
+        std::size_t unreadable_dirs = 0;
+        auto files = scan_tree(root_, options_.scan_threads, unreadable_dirs);
+        report.scanned = files.size();
+        log("Scanned " + std::to_string(files.size()) + " files");
+        if (unreadable_dirs > 0)
+        {
+            log("Warning: " + std::to_string(unreadable_dirs) + " directories could not be read");
+        }
+
+        // PERF: Only files whose size or mtime moved since the last run are
+        // read and hashed; everything else reuses the recorded digest
+        std::vector<LocalFile*> to_hash;
+        for (auto& f : files)
+        {
+            auto it = entries.find(remote_name(options_.prefix, f.rel));
+            if (it != entries.end() && it->second.size == f.size && it->second.mtime == f.mtime)
+            {
+                f.sha256 = it->second.sha256;
+            }
+            else
+            {
+                to_hash.push_back(&f);
+            }
+        }
+        parallel_for(to_hash.size(), options_.scan_threads, [&](std::size_t i)
+        {
+            try
+            {
+                to_hash[i]->sha256 = crypto::sha256_file((root_ / fs::path(to_hash[i]->rel)).string());
+            }
+            catch (const std::exception&)
+            {
+                to_hash[i]->unreadable = true;
+            }
+        });
+        log("Hashed " + std::to_string(to_hash.size()) + " new or modified files");
+
+        // ── Plan ────────────────────────────────────────────────────────────
+        struct Action
+        {
+            bool upload = true;
+            std::string name;
+            std::string rel;
+            const LocalFile* local = nullptr;
+            const models::FileMeta* remote = nullptr;
+        };
+        std::vector<Action> actions;
+        std::vector<Action> candidates;     // unrecorded, on both sides, plausible size
+        std::unordered_set<std::string> seen;
+
+        auto remote_moved = [](const SyncEntry* e, const models::FileMeta* r)
+        {
+            return !e || e->remote_size != r->size || e->remote_uploaded != r->uploaded_at;
+        };
+
+        for (const auto& f : files)
+        {
+            std::string name = remote_name(options_.prefix, f.rel);
+            if (!local_path(options_.prefix, name))
+            {
+                log("Skipping " + f.rel + ": name can't be stored portably");
+                ++report.skipped;
+                continue;
+            }
+            seen.insert(name);
+            if (f.unreadable)
+            {
+                log("Cannot read " + f.rel);
+                ++report.failed;
+                continue;
+            }
+
+            auto e_it = entries.find(name);
+            SyncEntry* e = e_it != entries.end() ? &e_it->second : nullptr;
+            auto r_it = remote.find(name);
+            const models::FileMeta* r = r_it != remote.end() ? r_it->second : nullptr;
+
+            // First sight of a path that is on both sides, e.g. a tree uploaded
+            // before it was synced. Without a record both copies would look
+            // changed. A ciphertext of the right size may be this very file;
+            // it is checked below rather than transferred back and forth.
+            if (!e && r && r->size == ciphertext_size(f.size))
+            {
+                candidates.push_back({false, name, f.rel, &f, r});
+                continue;
+            }
+
+            bool local_changed = !e || e->sha256 != f.sha256;
+            if (e && !local_changed && !options_.dry_run)
+            {
+                // Touched but identical: remember the new mtime so it isn't rehashed
+                e->size = f.size;
+                e->mtime = f.mtime;
+            }
+
+            if (!r)
+            {
+                actions.push_back({true, name, f.rel, &f, nullptr});
+            }
+            else if (local_changed && remote_moved(e, r))
+            {
+                ++report.conflicts;
+                log("Conflict on " + f.rel + ", keeping " +
+                    (options_.prefer == SyncPreference::Local ? "local" : "remote") + " copy");
+                actions.push_back({options_.prefer == SyncPreference::Local, name, f.rel, &f, r});
+            }
+            else if (local_changed)
+            {
+                actions.push_back({true, name, f.rel, &f, r});
+            }
+            else if (remote_moved(e, r))
+            {
+                actions.push_back({false, name, f.rel, &f, r});
+            }
+            else
+            {
+                ++report.unchanged;
+            }
+        }
+
+        // ── Adopt ───────────────────────────────────────────────────────────
+        // Size alone proves nothing: CBC pads to 16 bytes, so small edits keep
+        // the ciphertext size. Each candidate's plaintext is downloaded and
+        // hashed (nothing is written); only an identical file is adopted as
+        // in sync, anything else is a conflict like any other.
+        enum class Match { Same, Different, Unknown };
+        std::vector<Match> matches(candidates.size(), Match::Unknown);
+        std::vector<std::string> errors(candidates.size());
+        parallel_for(candidates.size(), options_.transfers, [&](std::size_t i)
+        {
+            HashingBuf hashed;
+            std::ostream out(&hashed);
+            auto result = api_->download_stream(candidates[i].name, out, options_.password);
+            if (result.success)
+            {
+                matches[i] = hashed.hash() == candidates[i].local->sha256 ? Match::Same : Match::Different;
+            }
+            else
+            {
+                errors[i] = result.message;
+            }
+        });
+        if (!candidates.empty())
+        {
+            log("Compared " + std::to_string(candidates.size()) + " files already on the server");
+        }
+
+        for (std::size_t i = 0; i < candidates.size(); ++i)
+        {
+            const auto& c = candidates[i];
+            if (matches[i] == Match::Same)
+            {
+                ++report.adopted;
+                if (!options_.dry_run)
+                {
+                    entries[c.name] = {c.local->size, c.local->mtime, c.local->sha256,
+                                       c.remote->size, c.remote->uploaded_at};
+                }
+            }
+            else if (matches[i] == Match::Different)
+            {
+                ++report.conflicts;
+                log("Conflict on " + c.rel + ", keeping " +
+                    (options_.prefer == SyncPreference::Local ? "local" : "remote") + " copy");
+                actions.push_back({options_.prefer == SyncPreference::Local, c.name, c.rel, c.local, c.remote});
+            }
+            else
+            {
+                // Unrecorded, so the next run compares it again
+                log("Cannot compare " + c.rel + ": " + errors[i]);
+                ++report.failed;
+            }
+        }
+
+        for (const auto& [name, r] : remote)
+        {
+            if (seen.count(name)) continue;
+
+            auto e_it = entries.find(name);
+            if (e_it != entries.end() && !remote_moved(&e_it->second, r))
+            {
+                ++report.skipped;   // deleted here since the last sync
+                continue;
+            }
+            actions.push_back({false, name, *local_path(options_.prefix, name), nullptr, r});
+        }
+
+        if (!options_.dry_run)
+        {
+            // Forget paths that are gone on both sides
+            for (auto it = entries.begin(); it != entries.end();)
+            {
+                if (!seen.count(it->first) && !remote.count(it->first)) it = entries.erase(it);
+                else ++it;
+            }
+        }
+
+        if (options_.dry_run)
+        {
+            for (const auto& a : actions)
+            {
+                log(std::string(a.upload ? "upload   " : "download ") + a.rel);
+                ++(a.upload ? report.uploaded : report.downloaded);
+            }
+            return report;
+        }
+
+        // ── Transfer ────────────────────────────────────────────────────────
+        TransferOptions transfer_options;
+        transfer_options.concurrency = options_.transfers;
+        TransferManager transfers(api_, transfer_options);
+        transfers.set_listener([this](const TransferProgress& p)
+        {
+            if (p.state == TransferState::Failed)
+            {
+                log("Failed " + p.name + ": " + p.message);
+            }
+        });
+
+        std::unordered_map<TransferManager::Id, const Action*> by_id;
+        for (const auto& a : actions)
+        {
+            fs::path path = root_ / fs::path(a.rel);
+            TransferManager::Id id;
+            if (a.upload)
+            {
+                id = transfers.enqueue_upload(path.string(), options_.password, a.name);
+            }
+            else
+            {
+                std::error_code ec;
+                fs::create_directories(path.parent_path(), ec);
+                id = transfers.enqueue_download(a.name, path.string(), options_.password);
+            }
+            by_id.emplace(id, &a);
+        }
+        if (!actions.empty())
+        {
+            log("Transferring " + std::to_string(actions.size()) + " files");
+        }
+        transfers.wait();
+
+        std::vector<const Action*> uploaded;
+        std::vector<const Action*> downloaded;
+        for (const auto& p : transfers.snapshot())
+        {
+            const Action* a = by_id.at(p.id);
+            if (p.state != TransferState::Done)
+            {
+                ++report.failed;
+                continue;
+            }
+            (a->upload ? uploaded : downloaded).push_back(a);
+        }
+        report.uploaded = uploaded.size();
+        report.downloaded = downloaded.size();
+
+        // ── Record ──────────────────────────────────────────────────────────
+        // Uploads need the server's view of the new objects. If that can't be
+        // had they stay unrecorded and are simply compared again next run.
+        if (!uploaded.empty())
+        {
+            auto after = api_->list_files();
+            std::unordered_map<std::string, const models::FileMeta*> stored;
+            if (after.ok)
+            {
+                for (const auto& f : after.files) stored.emplace(f.filename, &f);
+            }
+            for (const Action* a : uploaded)
+            {
+                auto it = stored.find(a->name);
+                if (it == stored.end()) continue;
+                entries[a->name] = {a->local->size, a->local->mtime, a->local->sha256,
+                                    it->second->size, it->second->uploaded_at};
+            }
+        }
+
+        std::mutex record_mutex;
+        parallel_for(downloaded.size(), options_.scan_threads, [&](std::size_t i)
+        {
+            const Action* a = downloaded[i];
+            fs::path path = root_ / fs::path(a->rel);
+            try
+            {
+                SyncEntry entry;
+                entry.size = fs::file_size(path);
+                entry.mtime = fs::last_write_time(path).time_since_epoch().count();
+                entry.sha256 = crypto::sha256_file(path.string());
+                entry.remote_size = a->remote->size;
+                entry.remote_uploaded = a->remote->uploaded_at;
+
+                std::lock_guard<std::mutex> lock(record_mutex);
+                entries[a->name] = std::move(entry);
+            }
+            catch (const std::exception&)
+            {
+                // Left unrecorded; the next run hashes it again
+            }
+        });
+
+        state.save();
+        return report;
+    }
+
+} // namespace vault::client
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "network/api_client.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace vault::client
+{
+
+    /// Which side wins when a path changed both locally and on the server
+    enum class SyncPreference { Local, Remote };
+
+    struct SyncOptions
+    {
+        std::string password;                 // encryption password
+        std::string prefix;                   // remote namespace for this tree
+        SyncPreference prefer = SyncPreference::Local;
+        std::size_t scan_threads = 8;         // directory walk and hashing
+        std::size_t transfers = 4;            // concurrent uploads/downloads
+        bool dry_run = false;                 // report the plan, change nothing
+    };
+
+    /// Outcome of one sync run
+    struct SyncReport
+    {
+        std::size_t scanned = 0;              // local files seen
+        std::size_t unchanged = 0;
+        std::size_t adopted = 0;              // identical on both sides before their first sync
+        std::size_t uploaded = 0;
+        std::size_t downloaded = 0;
+        std::size_t conflicts = 0;            // resolved by SyncOptions::prefer
+        std::size_t skipped = 0;              // deleted locally, or an unstorable name
+        std::size_t failed = 0;
+    };
+
+    /// Two-way sync between a local directory tree and the vault.
+    ///
+    /// Each file is stored under its url-encoded relative path, e.g.
+    /// `photos/2024/a.jpg` becomes `photos%2F2024%2Fa.jpg.enc`. A state
+    /// database in `<root>/.vaultsync/` records what every path looked like
+    /// after the last successful run, so only files whose size or mtime moved
+    /// are hashed, and only files that really differ are transferred.
+    /// A path with no record that is already on the server is downloaded
+    /// and hashed (not written) when its ciphertext size fits the local
+    /// file; it is adopted as in sync only if the plaintext is identical.
+    /// Deletions are not propagated in either direction.
+    class SyncEngine
+    {
+    public:
+        using Logger = std::function<void(const std::string&)>;
+
+        SyncEngine(std::shared_ptr<ApiClient> api, std::filesystem::path root, SyncOptions options);
+
+        /// Progress and per-file messages, one call per line; silent by default
+        void set_logger(Logger logger) { log_ = std::move(logger); }
+
+        /// Run one sync pass. Throws on errors that stop the whole run
+        /// (unreadable root, server unreachable, damaged state file).
+        SyncReport run();
+
+        /// Remote name for a relative path (generic '/' separators)
+        static std::string remote_name(const std::string& prefix, const std::string& rel_path);
+
+        /// Relative path for a remote name, or nullopt if the name is outside
+        /// `prefix`, wasn't produced by remote_name(), or would escape the root
+        static std::optional<std::string> local_path(const std::string& prefix,
+                                                     const std::string& remote_name);
+
+    private:
+        void log(const std::string& message) const;
+
+        std::shared_ptr<ApiClient> api_;
+        std::filesystem::path root_;
+        SyncOptions options_;
+        mutable std::mutex log_mutex_;     // transfers report from worker threads
+        Logger log_;
+    };
+
+} // namespace vault::client
@@ -0,0 +1,91 @@
+#include "sync/sync_state.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace vault::client
+{
+
+    static constexpr const char* kHeader = "vaultsync 1";
+
+    SyncState::SyncState(std::filesystem::path file)
+        : file_(std::move(file))
+    {
+    }
+
+    void SyncState::load()
+    {
+        entries_.clear();
+
+        std::ifstream in(file_);
+        if (!in) return;
+
+        std::string line;
+        if (!std::getline(in, line) || line != kHeader)
+        {
+            throw std::runtime_error("Unrecognised sync state: " + file_.string());
+        }
+
+        std::size_t line_no = 1;
+        while (std::getline(in, line))
+        {
+            ++line_no;
+            if (line.empty()) continue;
+
+            // name \t size \t mtime \t sha256 \t remote_size \t remote_uploaded
+            std::istringstream fields(line);
+            std::string name, size, mtime, sha256, remote_size, remote_uploaded;
+            if (!std::getline(fields, name, '\t') || !std::getline(fields, size, '\t') ||
+                !std::getline(fields, mtime, '\t') || !std::getline(fields, sha256, '\t') ||
+                !std::getline(fields, remote_size, '\t'))
+            {
+                throw std::runtime_error("Corrupt sync state at line " + std::to_string(line_no));
+            }
+            std::getline(fields, remote_uploaded);
+
+            try
+            {
+                SyncEntry entry;
+                entry.size = std::stoull(size);
+                entry.mtime = std::stoll(mtime);
+                entry.sha256 = std::move(sha256);
+                entry.remote_size = std::stoull(remote_size);
+                entry.remote_uploaded = std::move(remote_uploaded);
+                entries_[name] = std::move(entry);
+            }
+            catch (const std::exception&)
+            {
+                throw std::runtime_error("Corrupt sync state at line " + std::to_string(line_no));
+            }
+        }
+    }
+
+    void SyncState::save() const
+    {
+        std::filesystem::create_directories(file_.parent_path());
+
+        auto tmp = file_;
+        tmp += ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::trunc);
+            if (!out)
+            {
+                throw std::runtime_error("Cannot write sync state: " + tmp.string());
+            }
+
+            out << kHeader << '\n';
+            for (const auto& [name, e] : entries_)
+            {
+                out << name << '\t' << e.size << '\t' << e.mtime << '\t' << e.sha256 << '\t'
+                    << e.remote_size << '\t' << e.remote_uploaded << '\n';
+            }
+            if (!out.flush())
+            {
+                throw std::runtime_error("Cannot write sync state: " + tmp.string());
+            }
+        }
+        std::filesystem::rename(tmp, file_);
+    }
+
+} // namespace vault::client
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+
+namespace vault::client
+{
+
+    /// What a path looked like, locally and on the server, when it was last
+    /// in sync. Local changes are spotted from size and mtime and confirmed
+    /// by hash; remote changes from the listing's size and upload time.
+    struct SyncEntry
+    {
+        std::uint64_t size = 0;
+        std::int64_t mtime = 0;             // file_time_type ticks
+        std::string sha256;                 // of the plaintext
+        std::uint64_t remote_size = 0;      // of the ciphertext
+        std::string remote_uploaded;
+    };
+
+    /// Local state database for `vault_client sync`, one line per path in a
+    /// tab-separated text file kept inside the synced directory.
+    class SyncState
+    {
+    public:
+        /// Keyed by remote name (the url-encoded relative path plus ".enc")
+        using Entries = std::unordered_map<std::string, SyncEntry>;
+
+        explicit SyncState(std::filesystem::path file);
+
+        /// Read the database. A missing file is an empty state; a damaged
+        /// one throws rather than silently forcing a full resync.
+        void load();
+
+        /// Write the database atomically (temp file, then rename)
+        void save() const;
+
+        Entries& entries() { return entries_; }
+        const Entries& entries() const { return entries_; }
+
+    private:
+        std::filesystem::path file_;
+        Entries entries_;
+    };
+
+} // namespace vault::client
@@ -1,4 +1,8 @@
 #include "tui/app.h"
+#include "tui/file_list_view.h"
+#include "network/transfer_manager.h"
+#include "utils/thread_pool.h"
+#include "utils/utils.h"
 
 #include <ftxui/component/component.hpp>
 #include <ftxui/component/screen_interactive.hpp>
@@ -9,6 +13,8 @@
 #include <string>
 #include <functional>
 #include <memory>
+#include <cstdio>
+#include <algorithm>
 
 using namespace ftxui;
 
@@ -50,6 +56,52 @@ namespace vault::client
         }) | borderRounded | color(accent());
     }
 
+    static std::string format_rate(double bytes_per_sec)
+    {
+        return format_bytes(static_cast<std::uint64_t>(bytes_per_sec)) + "/s";
+    }
+
+    static Color state_color(TransferState state)
+    {
+        switch (state)
+        {
+            case TransferState::Done:      return success_c();
+            case TransferState::Failed:    return error_c();
+            case TransferState::Cancelled:
+            case TransferState::Queued:    return dim();
+            case TransferState::Running:
+            case TransferState::Retrying:  break;
+        }
+        return accent();
+    }
+
+    /// One line per transfer: name, state, progress bar and throughput
+    static Element transfer_row(const TransferProgress& p, bool selected)
+    {
+        float ratio = p.bytes_total > 0
+            ? static_cast<float>(p.bytes_done) / static_cast<float>(p.bytes_total)
+            : (p.state == TransferState::Done ? 1.0f : 0.0f);
+
+        std::string detail = format_bytes(p.bytes_done);
+        if (p.bytes_total > 0) detail += " / " + format_bytes(p.bytes_total);
+        if (p.state == TransferState::Running) detail += "  " + format_rate(p.bytes_per_sec);
+
+        auto row = hbox({
+            text(p.kind == TransferKind::Upload ? " ↑ " : " ↓ ") | color(accent()),
+            text(utils::extract_filename(p.name)) | size(WIDTH, EQUAL, 24),
+            text(to_string(p.state)) | size(WIDTH, EQUAL, 10) | color(state_color(p.state)),
+            gauge(ratio) | size(WIDTH, EQUAL, 20) | color(primary()),
+            text(" " + detail) | size(WIDTH, EQUAL, 28),
+        });
+        if (selected) row = row | inverted;
+
+        if ((p.state == TransferState::Failed || p.state == TransferState::Retrying) && !p.message.empty())
+        {
+            return vbox({row, text("     " + p.message) | color(error_c())});
+        }
+        return row;
+    }
+
     // ─── App Implementation ─────────────────────────────────────────────────────
 
     App::App(std::shared_ptr<ApiClient> api) : api_(std::move(api)) {}
@@ -59,7 +111,7 @@ namespace vault::client
         auto screen = ScreenInteractive::Fullscreen();
 
         // ── Shared state ────────────────────────────────────────────────────
-        int current_screen_index = 0; // 0=LOGIN, 1=DASHBOARD, 2=UPLOAD, 3=DOWNLOAD, 4=FILES
+        int current_screen_index = 0; // 0=LOGIN, 1=DASHBOARD, 2=UPLOAD, 3=DOWNLOAD, 4=FILES, 5=TRANSFERS
 
         // Login state
         std::string login_username;
@@ -81,7 +133,14 @@ namespace vault::client
         std::string download_key;
 
         // Files state
-        std::vector<models::FileMeta> file_list;
+        FileListView file_view;
+        std::string file_filter;
+
+        // Transfers state
+        int transfer_selected = 0;
+
+        // True while a login, register or list request is in flight
+        bool busy = false;
 
         // Helper to set status
         auto set_status = [&](const std::string& msg, bool is_error)
@@ -90,6 +149,76 @@ namespace vault::client
             status_is_error = is_error;
         };
 
+        // ── Background work ─────────────────────────────────────────────────
+        // Network and crypto never run on the UI thread. Workers hand results
+        // back as closures run by the event loop, then wake it to redraw.
+        auto post_to_ui = [&screen](std::function<void()> fn)
+        {
+            screen.Post(std::move(fn));
+            screen.PostEvent(Event::Custom);
+        };
+
+        // Declared after the state above so both are joined before it is destroyed
+        TransferManager transfers(api_);
+        transfers.set_listener([&screen](const TransferProgress&)
+        {
+            screen.PostEvent(Event::Custom);   // throttled by the manager
+        });
+
+        utils::ThreadPool background(1);
+        auto run_in_background = [&](std::function<void()> work)
+        {
+            busy = true;
+            background.try_submit(std::move(work));
+        };
+
+        auto refresh_files = [&](const std::string& done_message)
+        {
+            if (busy) return;
+            // Whatever is on screen (possibly from the on-disk cache) stays
+            // visible while the listing is revalidated
+            set_status(file_view.total() > 0 ? "Checking for changes..." : "Loading file list...", false);
+            run_in_background([&, done_message]
+            {
+                auto listing = std::make_shared<FileListing>(api_->list_files());
+                post_to_ui([&, listing, done_message]
+                {
+                    busy = false;
+                    if (!api_->is_authenticated()) return;   // logged out meanwhile
+                    if (!listing->ok)
+                    {
+                        set_status(file_view.total() > 0
+                            ? "Server unreachable, showing cached list"
+                            : "Could not load file list", true);
+                        return;
+                    }
+                    // PERF: A 304 means the rows on screen are already current
+                    if (!listing->not_modified || file_view.total() == 0)
+                    {
+                        file_view.set_files(listing->files);
+                    }
+                    set_status(done_message, false);
+                });
+            });
+        };
+
+        /// One-line summary of queued and running transfers
+        auto transfer_summary = [&]() -> Element
+        {
+            auto total = transfers.aggregate();
+            if (total.queued + total.running == 0) return text("");
+
+            float ratio = total.bytes_total > 0
+                ? static_cast<float>(total.bytes_done) / static_cast<float>(total.bytes_total)
+                : 0.0f;
+            return hbox({
+                text("  " + std::to_string(total.running) + " running, " +
+                     std::to_string(total.queued) + " queued  ") | color(accent()),
+                gauge(ratio) | flex | color(primary()),
+                text("  " + format_rate(total.bytes_per_sec) + "  "),
+            });
+        };
+
         // ── Login/Register Input Components ─────────────────────────────────
         auto input_username = Input(&login_username, "Username");
         InputOption opt_password;
@@ -101,51 +230,62 @@ namespace vault::client
 
         auto login_button = Button("  Submit  ", [&]
         {
+            if (busy) return;
             if (login_username.empty() || login_password.empty())
             {
                 set_status("Please enter username and password", true);
                 return;
             }
 
-            if (login_tab == 0)
+            bool registering = login_tab == 1;
+            set_status(registering ? "Registering..." : "Logging in...", false);
+
+            run_in_background([&, user = login_username, pass = login_password, registering]
             {
-                // Login
-                auto result = api_->login(login_username, login_password);
-                if (result.success)
+                ApiResult result;
+                std::string prefix;
+                if (registering)
                 {
-                    set_status("", false);
-                    current_screen_index = 1; // DASHBOARD
-                    login_password.clear();
+                    result = api_->register_user(user, pass);
+                    if (result.success)
+                    {
+                        // Auto-login after registration
+                        result = api_->login(user, pass);
+                        if (!result.success) prefix = "Registered but login failed: ";
+                    }
                 }
                 else
                 {
-                    set_status(result.message, true);
+                    result = api_->login(user, pass);
                 }
-            }
-            else
-            {
-                // Register
-                auto result = api_->register_user(login_username, login_password);
+
+                // Last run's listing, so the Files screen has rows before the first fetch
+                std::shared_ptr<std::vector<models::FileMeta>> cached;
                 if (result.success)
                 {
-                    set_status("Registered! Logging in...", false);
-                    // Auto-login after registration
-                    auto login_result = api_->login(login_username, login_password);
-                    if (login_result.success)
+                    if (auto files = api_->cached_files())
                     {
+                        cached = std::make_shared<std::vector<models::FileMeta>>(std::move(*files));
+                    }
+                }
+
+                post_to_ui([&, result, prefix, cached]
+                {
+                    busy = false;
+                    if (result.success)
+                    {
+                        set_status("", false);
                         current_screen_index = 1; // DASHBOARD
                         login_password.clear();
+                        if (cached) file_view.set_files(*cached);
+                        refresh_files("");   // revalidate while the user is on the dashboard
                     }
                     else
                     {
-                        set_status("Registered but login failed: " + login_result.message, true);
+                        set_status(prefix + result.message, true);
                     }
-                }
-                else
-                {
-                    set_status(result.message, true);
-                }
-            }
+                });
+            });
         }, ButtonOption::Animated(Color::RGB(100, 149, 237)));
 
         auto login_container = Container::Vertical({
@@ -200,6 +340,7 @@ namespace vault::client
             "  📤  Upload File       ",
             "  📥  Download File     ",
             "  📋  List Files        ",
+            "  📊  Transfers         ",
             "  🚪  Logout            ",
             "  ❌  Exit              ",
         };
@@ -257,17 +398,23 @@ namespace vault::client
                         return true;
                     case 2:
                         current_screen_index = 4; // FILES
-                        file_list = api_->list_files();
-                        set_status("", false);
+                        refresh_files("");
                         return true;
                     case 3:
+                        current_screen_index = 5; // TRANSFERS
+                        set_status("", false);
+                        return true;
+                    case 4:
+                        transfers.cancel_all();
                         api_->logout();
+                        file_view = FileListView();
+                        file_filter.clear();
                         current_screen_index = 0; // LOGIN
                         login_username.clear();
                         login_password.clear();
                         set_status("Logged out", false);
                         return true;
-                    case 4:
+                    case 5:
                         screen.Exit();
                         return true;
                 }
@@ -299,14 +446,11 @@ namespace vault::client
                 return;
             }
 
-            set_status("Encrypting and uploading...", false);
-            auto result = api_->upload_file(upload_path, upload_key);
-            set_status(result.message, !result.success);
-            if (result.success)
-            {
-                upload_path.clear();
-                upload_key.clear();
-            }
+            // Encryption and the upload itself run on the transfer workers
+            transfers.enqueue_upload(upload_path, upload_key);
+            set_status("Queued upload: " + utils::extract_filename(upload_path), false);
+            upload_path.clear();
+            upload_key.clear();
         }, ButtonOption::Animated(Color::RGB(50, 205, 50)));
 
         auto upload_back = Button("  Back  ", [&]
@@ -348,6 +492,7 @@ namespace vault::client
                         }) | hcenter,
                         text("") | size(HEIGHT, EQUAL, 1),
                         status_element,
+                        transfer_summary(),
                     })) | size(WIDTH, LESS_THAN, 60),
                     filler(),
                 }),
@@ -375,9 +520,8 @@ namespace vault::client
                 return;
             }
 
-            set_status("Downloading and decrypting...", false);
-            auto result = api_->download_file(download_filename, download_dest, download_key);
-            set_status(result.message, !result.success);
+            transfers.enqueue_download(download_filename, download_dest, download_key);
+            set_status("Queued download: " + download_filename, false);
         }, ButtonOption::Animated(Color::RGB(50, 205, 50)));
 
         auto download_back = Button("  Back  ", [&]
@@ -422,6 +566,7 @@ namespace vault::client
                         }) | hcenter,
                         text("") | size(HEIGHT, EQUAL, 1),
                         status_element,
+                        transfer_summary(),
                     })) | size(WIDTH, LESS_THAN, 60),
                     filler(),
                 }),
@@ -432,8 +577,7 @@ namespace vault::client
         // ── File List Screen ────────────────────────────────────────────────
         auto files_refresh = Button("  Refresh  ", [&]
         {
-            file_list = api_->list_files();
-            set_status("File list refreshed", false);
+            refresh_files("File list refreshed");
         }, ButtonOption::Animated(Color::RGB(100, 149, 237)));
 
         auto files_back = Button("  Back  ", [&]
@@ -442,13 +586,22 @@ namespace vault::client
             set_status("", false);
         }, ButtonOption::Animated(Color::RGB(255, 99, 71)));
 
-        auto files_container = Container::Horizontal({
-            files_refresh,
-            files_back,
+        InputOption opt_filter;
+        opt_filter.on_change = [&] { file_view.set_filter(file_filter); };
+        auto files_filter = Input(&file_filter, "Filter (^ for prefix)", opt_filter);
+
+        auto files_container = Container::Vertical({
+            files_filter,
+            Container::Horizontal({
+                files_refresh,
+                files_back,
+            }),
         });
 
         auto files_renderer = Renderer(files_container, [&]
         {
+            constexpr int kVisibleRows = 20;
+
             Elements file_rows;
             file_rows.push_back(
                 hbox({
@@ -459,40 +612,36 @@ namespace vault::client
             );
             file_rows.push_back(separator() | color(dim()));
 
-            if (file_list.empty())
+            std::size_t count = file_view.size();
+            if (count == 0)
             {
                 file_rows.push_back(
-                    text("  No files found") | color(dim()) | hcenter
+                    text(file_view.total() == 0 ? "  No files found" : "  No matching files")
+                        | color(dim()) | hcenter
                 );
             }
             else
             {
-                for (const auto& f : file_list)
+                // PERF: Rows are formatted once per refresh; only the window is built
+                std::size_t first = file_view.first_visible(kVisibleRows);
+                std::size_t last = std::min(count, first + kVisibleRows);
+                for (std::size_t i = first; i < last; ++i)
                 {
-                    std::string size_str;
-                    if (f.size < 1024)
-                    {
-                        size_str = std::to_string(f.size) + " B";
-                    }
-                    else if (f.size < 1024 * 1024)
-                    {
-                        size_str = std::to_string(f.size / 1024) + " KB";
-                    }
-                    else
-                    {
-                        size_str = std::to_string(f.size / (1024 * 1024)) + " MB";
-                    }
-
-                    file_rows.push_back(
-                        hbox({
-                            text("  " + f.filename) | size(WIDTH, EQUAL, 30),
-                            text(size_str) | size(WIDTH, EQUAL, 12),
-                            text(f.uploaded_at) | size(WIDTH, EQUAL, 22),
-                        })
-                    );
+                    const auto& row = file_view.row(i);
+                    auto line = hbox({
+                        text("  " + row.name) | size(WIDTH, EQUAL, 30),
+                        text(row.size) | size(WIDTH, EQUAL, 12),
+                        text(row.uploaded) | size(WIDTH, EQUAL, 22),
+                    });
+                    if (static_cast<int>(i) == file_view.selected()) line = line | inverted;
+                    file_rows.push_back(line);
                 }
             }
 
+            std::string position = count == 0 ? "" :
+                std::to_string(file_view.selected() + 1) + " of " + std::to_string(count);
+            std::string title = "📋 Your Files (" + std::to_string(file_view.total()) + ")";
+
             auto status_element = text("");
             if (!status_message.empty())
             {
@@ -505,8 +654,14 @@ namespace vault::client
                 filler(),
                 hbox({
                     filler(),
-                    styled_box("📋 Your Files (" + std::to_string(file_list.size()) + ")", vbox({
-                        vbox(file_rows) | size(WIDTH, GREATER_THAN, 60),
+                    styled_box(title, vbox({
+                        hbox({
+                            text("  Filter: ") | color(accent()),
+                            files_filter->Render() | flex,
+                            text(position + "  ") | color(dim()),
+                        }),
+                        separator() | color(dim()),
+                        vbox(file_rows) | size(WIDTH, GREATER_THAN, 64),
                         text("") | size(HEIGHT, EQUAL, 1),
                         hbox({
                             files_refresh->Render(),
@@ -518,8 +673,147 @@ namespace vault::client
                     })),
                     filler(),
                 }),
+                text("↑/↓ PgUp/PgDn Home/End to scroll • Enter to download") | color(dim()) | hcenter,
+                filler(),
+            });
+        }) | CatchEvent([&](Event event)
+        {
+            constexpr int kPage = 20;
+            if (event == Event::ArrowUp)   { file_view.move(-1); return true; }
+            if (event == Event::ArrowDown) { file_view.move(1); return true; }
+            if (event == Event::PageUp)    { file_view.move(-kPage); return true; }
+            if (event == Event::PageDown)  { file_view.move(kPage); return true; }
+            if (event == Event::Home)      { file_view.home(); return true; }
+            if (event == Event::End)       { file_view.end(); return true; }
+            if (event == Event::Return && files_filter->Focused() && file_view.size() > 0)
+            {
+                download_filename = file_view.row(file_view.selected()).name;
+                current_screen_index = 3; // DOWNLOAD
+                set_status("", false);
+                return true;
+            }
+            return false;
+        });
+
+        // ── Transfers Screen ────────────────────────────────────────────────
+        auto cancel_selected = [&]
+        {
+            auto snapshot = transfers.snapshot();
+            if (transfer_selected >= 0 && transfer_selected < static_cast<int>(snapshot.size()))
+            {
+                transfers.cancel(snapshot[transfer_selected].id);
+            }
+        };
+
+        auto transfers_cancel = Button("  Cancel  ", cancel_selected,
+                                       ButtonOption::Animated(Color::RGB(255, 99, 71)));
+
+        auto transfers_cancel_all = Button("  Cancel All  ", [&]
+        {
+            transfers.cancel_all();
+        }, ButtonOption::Animated(Color::RGB(255, 99, 71)));
+
+        auto transfers_clear = Button("  Clear Finished  ", [&]
+        {
+            transfers.clear_finished();
+            transfer_selected = 0;
+        }, ButtonOption::Animated(Color::RGB(100, 149, 237)));
+
+        auto transfers_back = Button("  Back  ", [&]
+        {
+            current_screen_index = 1; // DASHBOARD
+            set_status("", false);
+        }, ButtonOption::Animated(Color::RGB(255, 99, 71)));
+
+        auto transfers_container = Container::Horizontal({
+            transfers_cancel,
+            transfers_cancel_all,
+            transfers_clear,
+            transfers_back,
+        });
+
+        auto transfers_renderer = Renderer(transfers_container, [&]
+        {
+            constexpr int kVisibleRows = 15;
+
+            auto snapshot = transfers.snapshot();
+            auto total = transfers.aggregate();
+            int count = static_cast<int>(snapshot.size());
+            transfer_selected = std::max(0, std::min(transfer_selected, count - 1));
+
+            Elements rows;
+            if (snapshot.empty())
+            {
+                rows.push_back(text("  No transfers") | color(dim()) | hcenter);
+            }
+            else
+            {
+                // Only the window around the selection is built
+                int first = std::max(0, std::min(transfer_selected - kVisibleRows / 2, count - kVisibleRows));
+                int last = std::min(count, first + kVisibleRows);
+                for (int i = first; i < last; ++i)
+                {
+                    rows.push_back(transfer_row(snapshot[i], i == transfer_selected));
+                }
+            }
+
+            float ratio = total.bytes_total > 0
+                ? static_cast<float>(total.bytes_done) / static_cast<float>(total.bytes_total)
+                : 0.0f;
+
+            return vbox({
+                filler(),
+                hbox({
+                    filler(),
+                    styled_box("📊 Transfers", vbox({
+                        vbox(rows) | size(WIDTH, GREATER_THAN, 86),
+                        separator() | color(dim()),
+                        hbox({
+                            text("  Total  ") | bold,
+                            gauge(ratio) | flex | color(primary()),
+                            text("  " + format_bytes(total.bytes_done) + " / " +
+                                 format_bytes(total.bytes_total) + "  " +
+                                 format_rate(total.bytes_per_sec) + "  "),
+                        }),
+                        text("  " + std::to_string(total.running) + " running • " +
+                             std::to_string(total.queued) + " queued • " +
+                             std::to_string(total.done) + " done • " +
+                             std::to_string(total.failed) + " failed • " +
+                             std::to_string(total.cancelled) + " cancelled") | color(dim()),
+                        text("") | size(HEIGHT, EQUAL, 1),
+                        hbox({
+                            transfers_cancel->Render(),
+                            text("  "),
+                            transfers_cancel_all->Render(),
+                            text("  "),
+                            transfers_clear->Render(),
+                            text("  "),
+                            transfers_back->Render(),
+                        }) | hcenter,
+                    })),
+                    filler(),
+                }),
+                text("↑/↓ to select • x to cancel selected") | color(dim()) | hcenter,
                 filler(),
             });
+        }) | CatchEvent([&](Event event)
+        {
+            if (event == Event::ArrowUp)
+            {
+                --transfer_selected;   // clamped on render
+                return true;
+            }
+            if (event == Event::ArrowDown)
+            {
+                ++transfer_selected;
+                return true;
+            }
+            if (event == Event::Character('x'))
+            {
+                cancel_selected();
+                return true;
+            }
+            return false;
         });
 
         // ── Main Application Router ─────────────────────────────────────────
@@ -529,6 +823,7 @@ namespace vault::client
             upload_renderer,
             download_renderer,
             files_renderer,
+            transfers_renderer,
         }, &current_screen_index);
 
         screen.Loop(main_container);
@@ -0,0 +1,170 @@
+#include "tui/file_list_view.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <numeric>
+#include <tuple>
+#include <utility>
+
+namespace vault::client
+{
+
+    std::string format_bytes(std::uint64_t bytes)
+    {
+        static const char* const units[] = {"B", "KB", "MB", "GB", "TB"};
+        double value = static_cast<double>(bytes);
+        int unit = 0;
+        while (value >= 1024.0 && unit < 4)
+        {
+            value /= 1024.0;
+            ++unit;
+        }
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), unit == 0 ? "%.0f %s" : "%.1f %s", value, units[unit]);
+        return buf;
+    }
+
+    static std::string to_lower(const std::string& s)
+    {
+        std::string out(s);
+        for (auto& c : out)
+        {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        return out;
+    }
+
+    void FileListView::set_files(const std::vector<models::FileMeta>& files)
+    {
+        std::string selected_name;
+        if (selected_ >= 0 && static_cast<std::size_t>(selected_) < matches_.size())
+        {
+            selected_name = rows_[matches_[selected_]].name;
+        }
+
+        // Sort once, case-insensitively so prefix queries can binary search
+        // the lower-cased names; every later filter keeps this order for free
+        std::vector<std::string> lowered(files.size());
+        for (std::size_t i = 0; i < files.size(); ++i) lowered[i] = to_lower(files[i].filename);
+
+        std::vector<std::uint32_t> order(files.size());
+        std::iota(order.begin(), order.end(), 0u);
+        std::sort(order.begin(), order.end(), [&files, &lowered](std::uint32_t a, std::uint32_t b)
+        {
+            return std::tie(lowered[a], files[a].filename) < std::tie(lowered[b], files[b].filename);
+        });
+
+        rows_.clear();
+        lower_names_.clear();
+        rows_.reserve(files.size());
+        lower_names_.reserve(files.size());
+        for (auto i : order)
+        {
+            const auto& f = files[i];
+            rows_.push_back({f.filename, format_bytes(f.size), f.uploaded_at});
+            lower_names_.push_back(std::move(lowered[i]));
+        }
+
+        rebuild_matches(false);
+
+        selected_ = 0;
+        if (!selected_name.empty())
+        {
+            auto key = std::make_pair(to_lower(selected_name), selected_name);
+            auto it = std::lower_bound(matches_.begin(), matches_.end(), key,
+                [this](std::uint32_t i, const std::pair<std::string, std::string>& k)
+                {
+                    return std::tie(lower_names_[i], rows_[i].name) < std::tie(k.first, k.second);
+                });
+            if (it != matches_.end() && rows_[*it].name == selected_name)
+            {
+                selected_ = static_cast<int>(it - matches_.begin());
+            }
+        }
+        clamp();
+    }
+
+    void FileListView::set_filter(const std::string& query)
+    {
+        std::string lowered = to_lower(query);
+        if (lowered == query_) return;
+
+        // Typing another character can only shrink the match set
+        bool narrow = !query_.empty() && lowered.compare(0, query_.size(), query_) == 0;
+        query_ = std::move(lowered);
+        rebuild_matches(narrow);
+
+        selected_ = 0;
+        scroll_ = 0;
+    }
+
+    void FileListView::rebuild_matches(bool narrow)
+    {
+        if (query_.empty() || query_ == "^")
+        {
+            matches_.resize(rows_.size());
+            std::iota(matches_.begin(), matches_.end(), 0u);
+            return;
+        }
+
+        if (query_[0] == '^')
+        {
+            // PERF: Prefix queries are a binary search on the lower-cased
+            // names, which the rows are sorted by
+            std::string prefix = query_.substr(1);
+            auto first = std::lower_bound(lower_names_.begin(), lower_names_.end(), prefix);
+            auto last = first;
+            while (last != lower_names_.end() && last->compare(0, prefix.size(), prefix) == 0)
+            {
+                ++last;
+            }
+            matches_.resize(static_cast<std::size_t>(last - first));
+            std::iota(matches_.begin(), matches_.end(),
+                      static_cast<std::uint32_t>(first - lower_names_.begin()));
+            return;
+        }
+
+        std::vector<std::uint32_t> next;
+        auto test = [&](std::uint32_t i)
+        {
+            if (lower_names_[i].find(query_) != std::string::npos) next.push_back(i);
+        };
+
+        if (narrow)
+        {
+            for (auto i : matches_) test(i);
+        }
+        else
+        {
+            for (std::uint32_t i = 0; i < rows_.size(); ++i) test(i);
+        }
+        matches_.swap(next);
+    }
+
+    void FileListView::move(int delta)
+    {
+        selected_ += delta;
+        clamp();
+    }
+
+    void FileListView::clamp()
+    {
+        int last = static_cast<int>(matches_.size()) - 1;
+        selected_ = std::max(0, std::min(selected_, last));
+    }
+
+    std::size_t FileListView::first_visible(int height)
+    {
+        if (height < 1) height = 1;
+        auto h = static_cast<std::size_t>(height);
+        auto sel = static_cast<std::size_t>(std::max(selected_, 0));
+
+        if (sel < scroll_) scroll_ = sel;
+        if (sel >= scroll_ + h) scroll_ = sel - h + 1;
+        if (matches_.size() <= h) scroll_ = 0;
+        else scroll_ = std::min(scroll_, matches_.size() - h);
+        return scroll_;
+    }
+
+} // namespace vault::client
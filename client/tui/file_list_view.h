@@ -0,0 +1,73 @@
+#pragma once
+
+#include "models/file_meta.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace vault::client
+{
+
+    /// Human-readable size, e.g. "1.5 MB"
+    std::string format_bytes(std::uint64_t bytes);
+
+    /// Display model behind the Files screen.
+    ///
+    /// Rows are formatted once per refresh and kept sorted by name, ignoring
+    /// case, so a frame only has to build elements for the rows in view.
+    /// Filtering is a case-insensitive substring match; extending the query
+    /// only rescans the previous matches. A query starting with '^' is a prefix
+    /// match answered by binary search on the sorted names.
+    class FileListView
+    {
+    public:
+        struct Row
+        {
+            std::string name;
+            std::string size;
+            std::string uploaded;
+        };
+
+        /// Replace the listing. Keeps the filter and, if possible, the selected file.
+        void set_files(const std::vector<models::FileMeta>& files);
+
+        /// Apply a new filter query (empty shows everything)
+        void set_filter(const std::string& query);
+
+        /// Rows matching the filter
+        std::size_t size() const { return matches_.size(); }
+
+        /// Rows before filtering
+        std::size_t total() const { return rows_.size(); }
+
+        /// i-th matching row, 0 <= i < size()
+        const Row& row(std::size_t i) const { return rows_[matches_[i]]; }
+
+        // ── Selection and scrolling ─────────────────────────────────────
+
+        int selected() const { return selected_; }
+
+        /// Move the selection by `delta` rows, clamped to the matches
+        void move(int delta);
+        void home() { selected_ = 0; }
+        void end() { selected_ = static_cast<int>(matches_.size()) - 1; clamp(); }
+
+        /// First row to draw for a window of `height` rows. Scrolls only
+        /// when the selection would leave the window.
+        std::size_t first_visible(int height);
+
+    private:
+        void clamp();
+        void rebuild_matches(bool narrow);
+
+        std::vector<Row> rows_;                  // sorted by lower-cased name, then name
+        std::vector<std::string> lower_names_;   // parallel to rows_, for matching; sorted
+        std::vector<std::uint32_t> matches_;     // indices into rows_, ascending
+        std::string query_;                      // lower-cased
+        int selected_ = 0;
+        std::size_t scroll_ = 0;
+    };
+
+} // namespace vault::client
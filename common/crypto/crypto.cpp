@@ -1,13 +1,17 @@
 #include "crypto/crypto.h"
 
+#include <openssl/crypto.h>
 #include <openssl/evp.h>
+#include <openssl/hmac.h>
 #include <openssl/rand.h>
 #include <openssl/sha.h>
 
+#include <fstream>
 #include <iomanip>
 #include <sstream>
 #include <stdexcept>
 #include <cstring>
+#include <algorithm>
 
 namespace vault::crypto
 {
@@ -71,6 +75,112 @@ namespace vault::crypto
         return to_hex(hash, SHA256_DIGEST_LENGTH);
     }
 
+    std::string sha256_hex(const void* data, size_t len)
+    {
+        unsigned char hash[SHA256_DIGEST_LENGTH];
+        if (!EVP_Digest(data, len, hash, nullptr, EVP_sha256(), nullptr))
+        {
+            throw std::runtime_error("SHA-256 hashing failed");
+        }
+        return to_hex(hash, SHA256_DIGEST_LENGTH);
+    }
+
+    Sha256::Sha256()
+        : ctx_(EVP_MD_CTX_new())
+    {
+        if (!ctx_ || EVP_DigestInit_ex(static_cast<EVP_MD_CTX*>(ctx_), EVP_sha256(), nullptr) != 1)
+        {
+            EVP_MD_CTX_free(static_cast<EVP_MD_CTX*>(ctx_));
+            throw std::runtime_error("SHA-256 hashing failed");
+        }
+    }
+
+    Sha256::~Sha256()
+    {
+        EVP_MD_CTX_free(static_cast<EVP_MD_CTX*>(ctx_));
+    }
+
+    void Sha256::update(const void* data, size_t len)
+    {
+        if (EVP_DigestUpdate(static_cast<EVP_MD_CTX*>(ctx_), data, len) != 1)
+        {
+            throw std::runtime_error("SHA-256 hashing failed");
+        }
+    }
+
+    std::string Sha256::final_hex()
+    {
+        unsigned char hash[SHA256_DIGEST_LENGTH];
+        if (EVP_DigestFinal_ex(static_cast<EVP_MD_CTX*>(ctx_), hash, nullptr) != 1)
+        {
+            throw std::runtime_error("SHA-256 hashing failed");
+        }
+        return to_hex(hash, SHA256_DIGEST_LENGTH);
+    }
+
+    std::string sha256_file(const std::string& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+        {
+            throw std::runtime_error("Cannot open file: " + path);
+        }
+
+        Sha256 hasher;
+        std::vector<char> buffer(256 * 1024);
+        while (in)
+        {
+            in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            hasher.update(buffer.data(), static_cast<size_t>(in.gcount()));
+        }
+        if (in.bad())
+        {
+            throw std::runtime_error("Cannot read file: " + path);
+        }
+        return hasher.final_hex();
+    }
+
+    std::string hmac_sha256(const std::string& key, const std::string& data)
+    {
+        unsigned char mac[EVP_MAX_MD_SIZE];
+        unsigned int len = 0;
+        if (!HMAC(EVP_sha256(), key.data(), static_cast<int>(key.size()),
+                  reinterpret_cast<const unsigned char*>(data.data()), data.size(), mac, &len))
+        {
+            throw std::runtime_error("HMAC-SHA256 failed");
+        }
+        return std::string(reinterpret_cast<const char*>(mac), len);
+    }
+
+    bool constant_time_equal(const std::string& a, const std::string& b)
+    {
+        return a.size() == b.size() && CRYPTO_memcmp(a.data(), b.data(), a.size()) == 0;
+    }
+
+    std::string hex_to_base64(const std::string& hex)
+    {
+        if (hex.size() % 2 != 0)
+        {
+            throw std::invalid_argument("Odd-length hex string");
+        }
+        std::vector<unsigned char> bytes(hex.size() / 2);
+        for (size_t i = 0; i < bytes.size(); ++i)
+        {
+            size_t used = 0;
+            bytes[i] = static_cast<unsigned char>(std::stoul(hex.substr(i * 2, 2), &used, 16));
+            if (used != 2)
+            {
+                throw std::invalid_argument("Malformed hex string");
+            }
+        }
+
+        std::string out(4 * ((bytes.size() + 2) / 3), '\0');
+        int n = EVP_EncodeBlock(reinterpret_cast<unsigned char*>(out.data()), bytes.data(),
+                                static_cast<int>(bytes.size()));
+        out.resize(static_cast<size_t>(n));
+        return out;
+    }
+
     // ─── AES-256-CBC Encryption ─────────────────────────────────────────────────
 
     std::vector<uint8_t> derive_aes_key(const std::string& password)
@@ -202,6 +312,123 @@ namespace vault::crypto
         return plaintext;
     }
 
+    StreamEncryptor::StreamEncryptor(const std::string& password)
+        : iv_(generate_iv())
+    {
+        auto key = derive_aes_key(password);
+        auto* ctx = EVP_CIPHER_CTX_new();
+        if (!ctx) throw std::runtime_error("Failed to create cipher context");
+        ctx_ = ctx;
+
+        // SECURITY: AES-256-CBC with PKCS7 padding, as in aes256_encrypt
+        if (EVP_EncryptInit_ex(ctx, EVP_aes_256_cbc(), nullptr, key.data(), iv_.data()) != 1)
+        {
+            EVP_CIPHER_CTX_free(ctx);
+            throw std::runtime_error("Encryption init failed");
+        }
+    }
+
+    StreamEncryptor::~StreamEncryptor()
+    {
+        EVP_CIPHER_CTX_free(static_cast<EVP_CIPHER_CTX*>(ctx_));
+    }
+
+    void StreamEncryptor::update(const uint8_t* data, size_t len, std::vector<uint8_t>& out)
+    {
+        if (!iv_sent_)
+        {
+            out.insert(out.end(), iv_.begin(), iv_.end());
+            iv_sent_ = true;
+        }
+        if (len == 0) return;
+
+        auto offset = out.size();
+        out.resize(offset + len + EVP_CIPHER_block_size(EVP_aes_256_cbc()));
+        int out_len = 0;
+        if (EVP_EncryptUpdate(static_cast<EVP_CIPHER_CTX*>(ctx_), out.data() + offset, &out_len,
+                              data, static_cast<int>(len)) != 1)
+        {
+            throw std::runtime_error("Encryption update failed");
+        }
+        out.resize(offset + out_len);
+    }
+
+    void StreamEncryptor::finish(std::vector<uint8_t>& out)
+    {
+        update(nullptr, 0, out);   // an empty input still carries its IV
+
+        auto offset = out.size();
+        out.resize(offset + EVP_CIPHER_block_size(EVP_aes_256_cbc()));
+        int out_len = 0;
+        if (EVP_EncryptFinal_ex(static_cast<EVP_CIPHER_CTX*>(ctx_), out.data() + offset, &out_len) != 1)
+        {
+            throw std::runtime_error("Encryption finalize failed");
+        }
+        out.resize(offset + out_len);
+    }
+
+    StreamDecryptor::StreamDecryptor(const std::string& password)
+        : key_(derive_aes_key(password))
+    {
+        iv_.reserve(16);
+    }
+
+    StreamDecryptor::~StreamDecryptor()
+    {
+        EVP_CIPHER_CTX_free(static_cast<EVP_CIPHER_CTX*>(ctx_));
+    }
+
+    void StreamDecryptor::update(const uint8_t* data, size_t len, std::vector<uint8_t>& out)
+    {
+        // SECURITY: The IV leads the stream exactly as in aes256_decrypt
+        if (iv_.size() < 16)
+        {
+            size_t take = std::min(len, 16 - iv_.size());
+            iv_.insert(iv_.end(), data, data + take);
+            data += take;
+            len -= take;
+            if (iv_.size() < 16) return;
+
+            auto* ctx = EVP_CIPHER_CTX_new();
+            if (!ctx) throw std::runtime_error("Failed to create cipher context");
+            ctx_ = ctx;
+            if (EVP_DecryptInit_ex(ctx, EVP_aes_256_cbc(), nullptr,
+                                   key_.data(), iv_.data()) != 1)
+            {
+                throw std::runtime_error("Decryption init failed");
+            }
+        }
+        if (len == 0) return;
+
+        auto offset = out.size();
+        out.resize(offset + len + EVP_CIPHER_block_size(EVP_aes_256_cbc()));
+        int out_len = 0;
+        if (EVP_DecryptUpdate(static_cast<EVP_CIPHER_CTX*>(ctx_), out.data() + offset, &out_len,
+                              data, static_cast<int>(len)) != 1)
+        {
+            throw std::runtime_error("Decryption update failed");
+        }
+        out.resize(offset + out_len);
+    }
+
+    void StreamDecryptor::finish(std::vector<uint8_t>& out)
+    {
+        if (!ctx_)
+        {
+            throw std::runtime_error("Ciphertext too short — missing IV");
+        }
+
+        auto offset = out.size();
+        out.resize(offset + EVP_CIPHER_block_size(EVP_aes_256_cbc()));
+        int out_len = 0;
+        if (EVP_DecryptFinal_ex(static_cast<EVP_CIPHER_CTX*>(ctx_), out.data() + offset, &out_len) != 1)
+        {
+            out.resize(offset);
+            throw std::runtime_error("Decryption failed — wrong password or corrupted data");
+        }
+        out.resize(offset + out_len);
+    }
+
     // ─── Token Generation ────────────────────────────────────────────────────────
 
     std::string generate_token()
@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <cstddef>
 
 namespace vault::crypto 
 {
@@ -16,6 +17,43 @@ namespace vault::crypto
     /// Returns hex-encoded hash string
     std::string sha256_hash(const std::string& password, const std::string& salt);
 
+    /// SHA-256 of arbitrary bytes, hex-encoded (content fingerprints)
+    std::string sha256_hex(const void* data, size_t len);
+
+    /// Incremental SHA-256 for content that is read or received in pieces
+    class Sha256
+    {
+    public:
+        Sha256();
+        ~Sha256();
+
+        Sha256(const Sha256&) = delete;
+        Sha256& operator=(const Sha256&) = delete;
+
+        void update(const void* data, size_t len);
+
+        /// Hex digest of everything fed so far. The hasher is spent afterwards.
+        std::string final_hex();
+
+    private:
+        void* ctx_ = nullptr;         // EVP_MD_CTX
+    };
+
+    /// SHA-256 of a file's contents, read in fixed-size chunks. Throws if
+    /// the file can't be read.
+    std::string sha256_file(const std::string& path);
+
+    /// HMAC-SHA256 of `data` under `key`, as 32 raw bytes (request signing)
+    std::string hmac_sha256(const std::string& key, const std::string& data);
+
+    /// Compare secrets in time that depends only on their length, so a
+    /// guesser can't learn how many leading bytes were right
+    bool constant_time_equal(const std::string& a, const std::string& b);
+
+    /// Base64 (RFC 4648) of the bytes a hex digest encodes, the form HTTP
+    /// digest fields such as Repr-Digest carry. Throws on malformed hex.
+    std::string hex_to_base64(const std::string& hex);
+
     // ─── AES-256-CBC File Encryption ─────────────────────────────────────────────
 
     /// Generate a 32-byte AES key derived from a password using SHA-256
@@ -32,5 +70,56 @@ namespace vault::crypto
 
     std::vector<uint8_t> aes256_decrypt(const std::vector<uint8_t>& ciphertext,
                                          const std::string& password);
+
+    /// Incremental counterpart of aes256_encrypt for data of unknown length
+    /// (e.g. a pipe). Produces the same IV-prefixed format, so the output
+    /// can be read back with aes256_decrypt or StreamDecryptor.
+    class StreamEncryptor
+    {
+    public:
+        explicit StreamEncryptor(const std::string& password);
+        ~StreamEncryptor();
+
+        StreamEncryptor(const StreamEncryptor&) = delete;
+        StreamEncryptor& operator=(const StreamEncryptor&) = delete;
+
+        /// Feed the next slice of plaintext; appends ciphertext (led by the
+        /// IV on the first call) to `out`
+        void update(const uint8_t* data, size_t len, std::vector<uint8_t>& out);
+
+        /// Append the final padded block
+        void finish(std::vector<uint8_t>& out);
+
+    private:
+        std::vector<uint8_t> iv_;     // written out before the first block
+        bool iv_sent_ = false;
+        void* ctx_ = nullptr;         // EVP_CIPHER_CTX
+    };
+
+    /// Incremental counterpart of aes256_decrypt for data that arrives in
+    /// pieces. Accepts the same IV-prefixed format, so a file can be
+    /// decrypted as it streams in without holding it all in memory.
+    class StreamDecryptor
+    {
+    public:
+        explicit StreamDecryptor(const std::string& password);
+        ~StreamDecryptor();
+
+        StreamDecryptor(const StreamDecryptor&) = delete;
+        StreamDecryptor& operator=(const StreamDecryptor&) = delete;
+
+        /// Feed the next slice of ciphertext; appends any plaintext to `out`
+        void update(const uint8_t* data, size_t len, std::vector<uint8_t>& out);
+
+        /// Verify padding and append the final block. Throws on a wrong
+        /// password or truncated input.
+        void finish(std::vector<uint8_t>& out);
+
+    private:
+        std::vector<uint8_t> key_;
+        std::vector<uint8_t> iv_;     // collected from the first 16 bytes
+        void* ctx_ = nullptr;         // EVP_CIPHER_CTX, created once the IV is known
+    };
+
     std::string generate_token();
 }
@@ -0,0 +1,359 @@
+#include "logging/logger.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace vault::logging
+{
+    namespace
+    {
+        using SystemClock = std::chrono::system_clock;
+
+        struct Record
+        {
+            Level level = Level::Info;
+            const char* component = "";
+            SystemClock::time_point time;
+            std::string message;
+        };
+
+        /// Single-producer / single-consumer ring. The owning thread pushes,
+        /// the writer thread drains; neither side ever takes a lock.
+        class Ring
+        {
+        public:
+            explicit Ring(std::size_t capacity) : slots_(capacity) {}
+
+            bool push(Record&& record)
+            {
+                auto head = head_.load(std::memory_order_relaxed);
+                auto tail = tail_.load(std::memory_order_acquire);
+                if (head - tail >= slots_.size()) return false;
+
+                slots_[head % slots_.size()] = std::move(record);
+                head_.store(head + 1, std::memory_order_release);
+                return true;
+            }
+
+            void drain(std::vector<Record>& out)
+            {
+                auto tail = tail_.load(std::memory_order_relaxed);
+                auto head = head_.load(std::memory_order_acquire);
+                for (; tail != head; ++tail)
+                {
+                    out.push_back(std::move(slots_[tail % slots_.size()]));
+                }
+                tail_.store(tail, std::memory_order_release);
+            }
+
+            bool empty() const
+            {
+                return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+            }
+
+            std::atomic<bool> orphaned{false};   // owning thread has exited
+
+        private:
+            std::vector<Record> slots_;
+            alignas(64) std::atomic<std::size_t> head_{0};
+            alignas(64) std::atomic<std::size_t> tail_{0};
+        };
+
+        struct State
+        {
+            std::atomic<bool> running{false};
+            std::atomic<int> min_level{static_cast<int>(Level::Info)};
+            Format format = Format::Text;
+            std::ostream* out = &std::cout;
+            std::size_t ring_capacity = 4096;
+            std::chrono::milliseconds flush_interval{20};
+
+            std::mutex registry_mutex;
+            std::vector<std::shared_ptr<Ring>> rings;
+
+            std::thread writer;
+            std::mutex wake_mutex;
+            std::condition_variable wake_cv;
+            bool stop_requested = false;
+
+            std::mutex output_mutex;             // writer output and synchronous fallback
+            std::atomic<std::uint64_t> dropped{0};
+            std::uint64_t dropped_reported = 0;
+        };
+
+        State& state()
+        {
+            static State s;
+            return s;
+        }
+
+        /// Marks the thread's ring as orphaned when the thread exits, so the
+        /// writer can reclaim it once drained
+        struct LocalRing
+        {
+            std::shared_ptr<Ring> ring;
+
+            ~LocalRing()
+            {
+                if (ring) ring->orphaned.store(true, std::memory_order_release);
+            }
+        };
+
+        thread_local LocalRing t_ring;
+
+        Ring& local_ring()
+        {
+            if (!t_ring.ring)
+            {
+                auto& s = state();
+                t_ring.ring = std::make_shared<Ring>(s.ring_capacity);
+                std::lock_guard<std::mutex> lock(s.registry_mutex);
+                s.rings.push_back(t_ring.ring);
+            }
+            return *t_ring.ring;
+        }
+
+        const char* level_name(Level level)
+        {
+            switch (level)
+            {
+                case Level::Debug: return "DEBUG";
+                case Level::Info:  return "INFO";
+                case Level::Warn:  return "WARN";
+                case Level::Error: return "ERROR";
+            }
+            return "INFO";
+        }
+
+        void format_record(std::string& out, const Record& record, Format format)
+        {
+            auto time_t_val = SystemClock::to_time_t(record.time);
+            auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(
+                record.time.time_since_epoch()).count() % 1000;
+
+            struct tm tm_buf;
+    #ifdef _WIN32
+            localtime_s(&tm_buf, &time_t_val);
+    #else
+            localtime_r(&time_t_val, &tm_buf);
+    #endif
+            char stamp[40];
+            std::size_t n = std::strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S", &tm_buf);
+            std::snprintf(stamp + n, sizeof(stamp) - n, ".%03d", static_cast<int>(millis));
+
+            if (format == Format::Json)
+            {
+                nlohmann::json line =
+                {
+                    {"ts", stamp},
+                    {"level", level_name(record.level)},
+                    {"component", record.component},
+                    {"msg", record.message},
+                };
+                out += line.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+            }
+            else
+            {
+                out += stamp;
+                out += ' ';
+                out += level_name(record.level);
+                out += " [";
+                out += record.component;
+                out += "] ";
+                out += record.message;
+            }
+            out += '\n';
+        }
+
+        void write_synchronously(const Record& record)
+        {
+            auto& s = state();
+            std::string line;
+            format_record(line, record, s.format);
+
+            std::lock_guard<std::mutex> lock(s.output_mutex);
+            *s.out << line << std::flush;
+        }
+
+        void drain_all()
+        {
+            auto& s = state();
+
+            std::vector<std::shared_ptr<Ring>> rings;
+            {
+                std::lock_guard<std::mutex> lock(s.registry_mutex);
+                rings = s.rings;
+            }
+
+            std::vector<Record> batch;
+            for (auto& ring : rings)
+            {
+                ring->drain(batch);
+            }
+
+            // Reclaim rings whose threads have exited and that are now empty
+            {
+                std::lock_guard<std::mutex> lock(s.registry_mutex);
+                s.rings.erase(std::remove_if(s.rings.begin(), s.rings.end(), [](const auto& ring)
+                {
+                    return ring->orphaned.load(std::memory_order_acquire) && ring->empty();
+                }), s.rings.end());
+            }
+
+            auto dropped = s.dropped.load(std::memory_order_relaxed);
+            if (batch.empty() && dropped == s.dropped_reported) return;
+
+            // Rings are per thread, so restore global order by timestamp
+            std::stable_sort(batch.begin(), batch.end(), [](const Record& a, const Record& b)
+            {
+                return a.time < b.time;
+            });
+
+            std::string text;
+            for (const auto& record : batch)
+            {
+                format_record(text, record, s.format);
+            }
+
+            if (dropped != s.dropped_reported)
+            {
+                Record note{Level::Warn, "Log", SystemClock::now(),
+                            std::to_string(dropped - s.dropped_reported) + " record(s) dropped, ring full"};
+                format_record(text, note, s.format);
+                s.dropped_reported = dropped;
+            }
+
+            std::lock_guard<std::mutex> lock(s.output_mutex);
+            *s.out << text << std::flush;
+        }
+
+        void writer_loop()
+        {
+            auto& s = state();
+            for (;;)
+            {
+                bool stopping;
+                {
+                    std::unique_lock<std::mutex> lock(s.wake_mutex);
+                    s.wake_cv.wait_for(lock, s.flush_interval, [&s] { return s.stop_requested; });
+                    stopping = s.stop_requested;
+                }
+
+                drain_all();
+                if (stopping) return;
+            }
+        }
+    }
+
+    void start(const Options& options)
+    {
+        auto& s = state();
+        if (s.running.load()) return;
+
+        s.min_level.store(static_cast<int>(options.min_level));
+        s.format = options.format;
+        s.out = options.out ? options.out : &std::cout;
+        s.ring_capacity = std::max<std::size_t>(options.ring_capacity, 16);
+        s.flush_interval = options.flush_interval;
+        s.stop_requested = false;
+
+        s.writer = std::thread(writer_loop);
+        s.running.store(true, std::memory_order_release);
+    }
+
+    void stop()
+    {
+        auto& s = state();
+        if (!s.running.exchange(false)) return;
+
+        {
+            std::lock_guard<std::mutex> lock(s.wake_mutex);
+            s.stop_requested = true;
+        }
+        s.wake_cv.notify_all();
+        if (s.writer.joinable()) s.writer.join();
+
+        // Catch records pushed while the writer was shutting down
+        drain_all();
+    }
+
+    bool enabled(Level level)
+    {
+        return static_cast<int>(level) >= state().min_level.load(std::memory_order_relaxed);
+    }
+
+    void log(Level level, const char* component, std::string message)
+    {
+        if (!enabled(level)) return;
+
+        auto& s = state();
+        Record record{level, component, SystemClock::now(), std::move(message)};
+
+        if (!s.running.load(std::memory_order_acquire))
+        {
+            write_synchronously(record);
+            return;
+        }
+
+        // PERF: Never block the caller; a full ring means the writer is behind
+        if (!local_ring().push(std::move(record)))
+        {
+            s.dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    std::uint64_t dropped()
+    {
+        return state().dropped.load(std::memory_order_relaxed);
+    }
+
+    Level parse_level(const std::string& name)
+    {
+        if (name == "debug") return Level::Debug;
+        if (name == "info")  return Level::Info;
+        if (name == "warn")  return Level::Warn;
+        if (name == "error") return Level::Error;
+        throw std::invalid_argument("Unknown log level: " + name);
+    }
+
+    // ─── Rate Limiting ──────────────────────────────────────────────────────────
+
+    bool RateLimit::allow()
+    {
+        auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        auto next = next_allowed_ns_.load(std::memory_order_relaxed);
+
+        if (now >= next &&
+            next_allowed_ns_.compare_exchange_strong(next, now + std::chrono::nanoseconds(interval_).count(),
+                                                     std::memory_order_relaxed))
+        {
+            return true;
+        }
+
+        suppressed_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    void log(RateLimit& limit, Level level, const char* component, std::string message)
+    {
+        if (!enabled(level) || !limit.allow()) return;
+
+        auto suppressed = limit.take_suppressed();
+        if (suppressed > 0)
+        {
+            message += " (" + std::to_string(suppressed) + " similar suppressed)";
+        }
+        log(level, component, std::move(message));
+    }
+
+}
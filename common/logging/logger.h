@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace vault::logging
+{
+
+    enum class Level { Debug, Info, Warn, Error };
+
+    enum class Format { Text, Json };
+
+    struct Options
+    {
+        Level min_level = Level::Info;
+        Format format = Format::Text;
+        std::size_t ring_capacity = 4096;                    // records per thread
+        std::chrono::milliseconds flush_interval{20};
+        std::ostream* out = nullptr;                         // nullptr = std::cout
+    };
+
+    /// Start the background writer. Until this is called (and after stop()),
+    /// records are written synchronously so startup messages are never lost.
+    void start(const Options& options = {});
+
+    /// Drain every pending record and join the writer thread
+    void stop();
+
+    /// Queue a record. Never blocks: each thread appends to its own lock-free
+    /// ring, and a record is dropped (and counted) if that ring is full.
+    /// `component` must outlive the logger, e.g. a string literal.
+    void log(Level level, const char* component, std::string message);
+
+    inline void debug(const char* component, std::string message) { log(Level::Debug, component, std::move(message)); }
+    inline void info(const char* component, std::string message)  { log(Level::Info, component, std::move(message)); }
+    inline void warn(const char* component, std::string message)  { log(Level::Warn, component, std::move(message)); }
+    inline void error(const char* component, std::string message) { log(Level::Error, component, std::move(message)); }
+
+    /// True if records at `level` are currently emitted (skip building costly messages)
+    bool enabled(Level level);
+
+    /// Records discarded because a thread's ring was full
+    std::uint64_t dropped();
+
+    /// Parse "debug" / "info" / "warn" / "error"; throws std::invalid_argument
+    Level parse_level(const std::string& name);
+
+    /// Per-call-site limiter for noisy messages:
+    ///
+    ///     static logging::RateLimit limit(std::chrono::seconds(1));
+    ///     logging::log(limit, Level::Warn, "Storage", "disk full");
+    class RateLimit
+    {
+    public:
+        explicit RateLimit(std::chrono::milliseconds interval) : interval_(interval) {}
+
+        /// Returns true if a message may be emitted now
+        bool allow();
+
+        /// Messages suppressed since the last allowed one (resets on read)
+        std::uint64_t take_suppressed() { return suppressed_.exchange(0, std::memory_order_relaxed); }
+
+    private:
+        std::chrono::milliseconds interval_;
+        std::atomic<std::int64_t> next_allowed_ns_{0};
+        std::atomic<std::uint64_t> suppressed_{0};
+    };
+
+    /// Log through a RateLimit, noting how many similar messages were suppressed
+    void log(RateLimit& limit, Level level, const char* component, std::string message);
+
+}
@@ -0,0 +1,260 @@
+#include "utils/binary_writers.h"
+
+#include <cstring>
+
+namespace vault::utils
+{
+    /// Append `value` as `bytes` big-endian bytes
+    static void put_be(std::string& out, std::uint64_t value, int bytes)
+    {
+        for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8)
+        {
+            out += static_cast<char>((value >> shift) & 0xFF);
+        }
+    }
+
+    static std::uint64_t double_bits(double number)
+    {
+        std::uint64_t bits;
+        std::memcpy(&bits, &number, sizeof(bits));
+        return bits;
+    }
+
+    // ─── CBOR ───────────────────────────────────────────────────────────────────
+
+    void CborWriter::write_head(std::uint8_t major, std::uint64_t argument)
+    {
+        auto mt = static_cast<std::uint8_t>(major << 5);
+        if (argument < 24)
+        {
+            out_ += static_cast<char>(mt | argument);
+        }
+        else if (argument <= 0xFF)
+        {
+            out_ += static_cast<char>(mt | 24);
+            put_be(out_, argument, 1);
+        }
+        else if (argument <= 0xFFFF)
+        {
+            out_ += static_cast<char>(mt | 25);
+            put_be(out_, argument, 2);
+        }
+        else if (argument <= 0xFFFFFFFFull)
+        {
+            out_ += static_cast<char>(mt | 26);
+            put_be(out_, argument, 4);
+        }
+        else
+        {
+            out_ += static_cast<char>(mt | 27);
+            put_be(out_, argument, 8);
+        }
+    }
+
+    CborWriter& CborWriter::begin_object(std::size_t count)
+    {
+        write_head(5, count);
+        return *this;
+    }
+
+    CborWriter& CborWriter::begin_array(std::size_t count)
+    {
+        write_head(4, count);
+        return *this;
+    }
+
+    CborWriter& CborWriter::value(std::string_view text)
+    {
+        write_head(3, text.size());
+        out_.append(text.data(), text.size());
+        return *this;
+    }
+
+    CborWriter& CborWriter::value(bool flag)
+    {
+        out_ += static_cast<char>(flag ? 0xF5 : 0xF4);
+        return *this;
+    }
+
+    CborWriter& CborWriter::value(double number)
+    {
+        out_ += static_cast<char>(0xFB);
+        put_be(out_, double_bits(number), 8);
+        return *this;
+    }
+
+    CborWriter& CborWriter::null()
+    {
+        out_ += static_cast<char>(0xF6);
+        return *this;
+    }
+
+    CborWriter& CborWriter::write_integer(std::int64_t number)
+    {
+        if (number >= 0)
+        {
+            write_head(0, static_cast<std::uint64_t>(number));
+        }
+        else
+        {
+            // Major type 1 encodes -1 - n
+            write_head(1, static_cast<std::uint64_t>(-(number + 1)));
+        }
+        return *this;
+    }
+
+    CborWriter& CborWriter::write_integer(std::uint64_t number)
+    {
+        write_head(0, number);
+        return *this;
+    }
+
+    // ─── MessagePack ────────────────────────────────────────────────────────────
+
+    MsgpackWriter& MsgpackWriter::begin_object(std::size_t count)
+    {
+        if (count < 16)
+        {
+            out_ += static_cast<char>(0x80 | count);
+        }
+        else if (count <= 0xFFFF)
+        {
+            out_ += static_cast<char>(0xDE);
+            put_be(out_, count, 2);
+        }
+        else
+        {
+            out_ += static_cast<char>(0xDF);
+            put_be(out_, count, 4);
+        }
+        return *this;
+    }
+
+    MsgpackWriter& MsgpackWriter::begin_array(std::size_t count)
+    {
+        if (count < 16)
+        {
+            out_ += static_cast<char>(0x90 | count);
+        }
+        else if (count <= 0xFFFF)
+        {
+            out_ += static_cast<char>(0xDC);
+            put_be(out_, count, 2);
+        }
+        else
+        {
+            out_ += static_cast<char>(0xDD);
+            put_be(out_, count, 4);
+        }
+        return *this;
+    }
+
+    MsgpackWriter& MsgpackWriter::value(std::string_view text)
+    {
+        auto size = text.size();
+        if (size < 32)
+        {
+            out_ += static_cast<char>(0xA0 | size);
+        }
+        else if (size <= 0xFF)
+        {
+            out_ += static_cast<char>(0xD9);
+            put_be(out_, size, 1);
+        }
+        else if (size <= 0xFFFF)
+        {
+            out_ += static_cast<char>(0xDA);
+            put_be(out_, size, 2);
+        }
+        else
+        {
+            out_ += static_cast<char>(0xDB);
+            put_be(out_, size, 4);
+        }
+        out_.append(text.data(), size);
+        return *this;
+    }
+
+    MsgpackWriter& MsgpackWriter::value(bool flag)
+    {
+        out_ += static_cast<char>(flag ? 0xC3 : 0xC2);
+        return *this;
+    }
+
+    MsgpackWriter& MsgpackWriter::value(double number)
+    {
+        out_ += static_cast<char>(0xCB);
+        put_be(out_, double_bits(number), 8);
+        return *this;
+    }
+
+    MsgpackWriter& MsgpackWriter::null()
+    {
+        out_ += static_cast<char>(0xC0);
+        return *this;
+    }
+
+    MsgpackWriter& MsgpackWriter::write_integer(std::int64_t number)
+    {
+        if (number >= 0)
+        {
+            return write_integer(static_cast<std::uint64_t>(number));
+        }
+
+        if (number >= -32)
+        {
+            out_ += static_cast<char>(number);   // negative fixint
+        }
+        else if (number >= INT8_MIN)
+        {
+            out_ += static_cast<char>(0xD0);
+            put_be(out_, static_cast<std::uint64_t>(number), 1);
+        }
+        else if (number >= INT16_MIN)
+        {
+            out_ += static_cast<char>(0xD1);
+            put_be(out_, static_cast<std::uint64_t>(number), 2);
+        }
+        else if (number >= INT32_MIN)
+        {
+            out_ += static_cast<char>(0xD2);
+            put_be(out_, static_cast<std::uint64_t>(number), 4);
+        }
+        else
+        {
+            out_ += static_cast<char>(0xD3);
+            put_be(out_, static_cast<std::uint64_t>(number), 8);
+        }
+        return *this;
+    }
+
+    MsgpackWriter& MsgpackWriter::write_integer(std::uint64_t number)
+    {
+        if (number < 128)
+        {
+            out_ += static_cast<char>(number);   // positive fixint
+        }
+        else if (number <= 0xFF)
+        {
+            out_ += static_cast<char>(0xCC);
+            put_be(out_, number, 1);
+        }
+        else if (number <= 0xFFFF)
+        {
+            out_ += static_cast<char>(0xCD);
+            put_be(out_, number, 2);
+        }
+        else if (number <= 0xFFFFFFFFull)
+        {
+            out_ += static_cast<char>(0xCE);
+            put_be(out_, number, 4);
+        }
+        else
+        {
+            out_ += static_cast<char>(0xCF);
+            put_be(out_, number, 8);
+        }
+        return *this;
+    }
+
+} // namespace vault::utils
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "utils/structured_writer.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace vault::utils
+{
+
+    /// Streaming CBOR (RFC 8949) encoder using definite-length containers
+    class CborWriter : public StructuredWriter
+    {
+    public:
+        explicit CborWriter(std::string& out) : out_(out) {}
+
+        using StructuredWriter::value;
+
+        CborWriter& begin_object(std::size_t count) override;
+        CborWriter& end_object() override { return *this; }
+        CborWriter& begin_array(std::size_t count) override;
+        CborWriter& end_array() override { return *this; }
+
+        CborWriter& key(std::string_view name) override { return value(name); }
+
+        CborWriter& value(std::string_view text) override;
+        CborWriter& value(bool flag) override;
+        CborWriter& value(double number) override;
+        CborWriter& null() override;
+
+    protected:
+        CborWriter& write_integer(std::int64_t number) override;
+        CborWriter& write_integer(std::uint64_t number) override;
+
+    private:
+        void write_head(std::uint8_t major, std::uint64_t argument);
+
+        std::string& out_;
+    };
+
+    /// Streaming MessagePack encoder
+    class MsgpackWriter : public StructuredWriter
+    {
+    public:
+        explicit MsgpackWriter(std::string& out) : out_(out) {}
+
+        using StructuredWriter::value;
+
+        MsgpackWriter& begin_object(std::size_t count) override;
+        MsgpackWriter& end_object() override { return *this; }
+        MsgpackWriter& begin_array(std::size_t count) override;
+        MsgpackWriter& end_array() override { return *this; }
+
+        MsgpackWriter& key(std::string_view name) override { return value(name); }
+
+        MsgpackWriter& value(std::string_view text) override;
+        MsgpackWriter& value(bool flag) override;
+        MsgpackWriter& value(double number) override;
+        MsgpackWriter& null() override;
+
+    protected:
+        MsgpackWriter& write_integer(std::int64_t number) override;
+        MsgpackWriter& write_integer(std::uint64_t number) override;
+
+    private:
+        std::string& out_;
+    };
+
+} // namespace vault::utils
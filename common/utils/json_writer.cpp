@@ -0,0 +1,150 @@
+#include "utils/json_writer.h"
+
+#include <charconv>
+#include <cmath>
+
+namespace vault::utils
+{
+
+    void JsonWriter::before_value()
+    {
+        if (after_key_)
+        {
+            after_key_ = false;
+            return;
+        }
+        if (!has_elements_.empty())
+        {
+            if (has_elements_.back()) out_ += ',';
+            has_elements_.back() = true;
+        }
+    }
+
+    JsonWriter& JsonWriter::begin_object(std::size_t)
+    {
+        before_value();
+        out_ += '{';
+        has_elements_.push_back(false);
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::end_object()
+    {
+        out_ += '}';
+        has_elements_.pop_back();
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::begin_array(std::size_t)
+    {
+        before_value();
+        out_ += '[';
+        has_elements_.push_back(false);
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::end_array()
+    {
+        out_ += ']';
+        has_elements_.pop_back();
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::key(std::string_view name)
+    {
+        before_value();
+        append_escaped(out_, name);
+        out_ += ':';
+        after_key_ = true;
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::value(std::string_view text)
+    {
+        before_value();
+        append_escaped(out_, text);
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::value(bool flag)
+    {
+        before_value();
+        out_ += flag ? "true" : "false";
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::value(double number)
+    {
+        before_value();
+        if (!std::isfinite(number))
+        {
+            out_ += "null";   // JSON has no NaN/Infinity
+            return *this;
+        }
+        char buf[32];
+        auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), number);
+        out_.append(buf, end);
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::null()
+    {
+        before_value();
+        out_ += "null";
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::write_integer(std::int64_t number)
+    {
+        before_value();
+        char buf[24];
+        auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), number);
+        out_.append(buf, end);
+        return *this;
+    }
+
+    JsonWriter& JsonWriter::write_integer(std::uint64_t number)
+    {
+        before_value();
+        char buf[24];
+        auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), number);
+        out_.append(buf, end);
+        return *this;
+    }
+
+    void JsonWriter::append_escaped(std::string& out, std::string_view text)
+    {
+        static constexpr char kHex[] = "0123456789abcdef";
+
+        out += '"';
+        std::size_t run_start = 0;
+        for (std::size_t i = 0; i < text.size(); ++i)
+        {
+            auto c = static_cast<unsigned char>(text[i]);
+            if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+            // Copy the clean run in one go, then the escape sequence
+            out.append(text.data() + run_start, i - run_start);
+            run_start = i + 1;
+
+            switch (c)
+            {
+                case '"':  out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\b': out += "\\b"; break;
+                case '\f': out += "\\f"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    out += "\\u00";
+                    out += kHex[c >> 4];
+                    out += kHex[c & 0xF];
+                    break;
+            }
+        }
+        out.append(text.data() + run_start, text.size() - run_start);
+        out += '"';
+    }
+
+} // namespace vault::utils
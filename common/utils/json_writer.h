@@ -0,0 +1,55 @@
+#pragma once
+
+#include "utils/structured_writer.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vault::utils
+{
+
+    /// Minimal streaming JSON serializer.
+    ///
+    /// Appends directly to a caller-owned buffer with no intermediate DOM, so
+    /// serializing N records costs one growing string instead of a tree of
+    /// heap nodes followed by a full copy. The caller is responsible for
+    /// emitting a well-formed sequence (keys only inside objects, balanced
+    /// begin/end calls).
+    class JsonWriter : public StructuredWriter
+    {
+    public:
+        explicit JsonWriter(std::string& out) : out_(out) {}
+
+        using StructuredWriter::value;
+
+        /// Element counts are only needed by the binary formats and are ignored
+        JsonWriter& begin_object(std::size_t count = 0) override;
+        JsonWriter& end_object() override;
+        JsonWriter& begin_array(std::size_t count = 0) override;
+        JsonWriter& end_array() override;
+
+        JsonWriter& key(std::string_view name) override;
+
+        JsonWriter& value(std::string_view text) override;
+        JsonWriter& value(bool flag) override;
+        JsonWriter& value(double number) override;
+        JsonWriter& null() override;
+
+        /// Append `text` as a quoted, escaped JSON string
+        static void append_escaped(std::string& out, std::string_view text);
+
+    protected:
+        JsonWriter& write_integer(std::int64_t number) override;
+        JsonWriter& write_integer(std::uint64_t number) override;
+
+    private:
+        void before_value();
+
+        std::string& out_;
+        std::vector<bool> has_elements_;   // one entry per open container
+        bool after_key_ = false;
+    };
+
+} // namespace vault::utils
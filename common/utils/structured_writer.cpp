@@ -0,0 +1,99 @@
+#include "utils/structured_writer.h"
+#include "utils/json_writer.h"
+#include "utils/binary_writers.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace vault::utils
+{
+
+    const char* content_type(Encoding encoding)
+    {
+        switch (encoding)
+        {
+            case Encoding::Cbor:    return "application/cbor";
+            case Encoding::Msgpack: return "application/msgpack";
+            case Encoding::Json:    break;
+        }
+        return "application/json";
+    }
+
+    static std::string to_lower(std::string_view text)
+    {
+        std::string lower(text);
+        std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c)
+        {
+            return static_cast<char>(std::tolower(c));
+        });
+        return lower;
+    }
+
+    static std::string_view trim(std::string_view text)
+    {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) text.remove_suffix(1);
+        return text;
+    }
+
+    /// True if a media range's parameters carry q=0 ("not acceptable")
+    static bool refused(std::string_view params)
+    {
+        while (!params.empty())
+        {
+            auto semi = params.find(';');
+            auto param = trim(params.substr(0, semi));
+            params = semi == std::string_view::npos ? std::string_view{} : params.substr(semi + 1);
+
+            if (param.size() < 2 || param[0] != 'q' || param[1] != '=') continue;
+            // q is at most three decimals; it is zero iff it has no non-zero digit
+            return std::none_of(param.begin() + 2, param.end(), [](char c) { return c >= '1' && c <= '9'; });
+        }
+        return false;
+    }
+
+    Encoding negotiate_encoding(std::string_view accept_header)
+    {
+        if (accept_header.empty()) return Encoding::Json;
+
+        // First binary type listed wins. q-values are not ranked, but q=0
+        // takes a type out of the running.
+        auto accept = to_lower(accept_header);
+        std::string_view rest = accept;
+        while (!rest.empty())
+        {
+            auto comma = rest.find(',');
+            auto range = rest.substr(0, comma);
+            rest = comma == std::string_view::npos ? std::string_view{} : rest.substr(comma + 1);
+
+            auto semi = range.find(';');
+            auto type = trim(range.substr(0, semi));
+            if (semi != std::string_view::npos && refused(range.substr(semi + 1))) continue;
+
+            if (type == "application/cbor") return Encoding::Cbor;
+            if (type == "application/msgpack" || type == "application/x-msgpack") return Encoding::Msgpack;
+        }
+        return Encoding::Json;
+    }
+
+    Encoding encoding_from_content_type(std::string_view content_type_header)
+    {
+        auto type = to_lower(content_type_header);
+        if (type.rfind("application/cbor", 0) == 0) return Encoding::Cbor;
+        if (type.rfind("application/msgpack", 0) == 0 ||
+            type.rfind("application/x-msgpack", 0) == 0) return Encoding::Msgpack;
+        return Encoding::Json;
+    }
+
+    std::unique_ptr<StructuredWriter> make_writer(Encoding encoding, std::string& out)
+    {
+        switch (encoding)
+        {
+            case Encoding::Cbor:    return std::make_unique<CborWriter>(out);
+            case Encoding::Msgpack: return std::make_unique<MsgpackWriter>(out);
+            case Encoding::Json:    break;
+        }
+        return std::make_unique<JsonWriter>(out);
+    }
+
+} // namespace vault::utils
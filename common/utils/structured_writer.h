@@ -0,0 +1,76 @@
+#pragma once
+
+#include <concepts>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace vault::utils
+{
+
+    /// Wire formats understood by the server and client
+    enum class Encoding { Json, Cbor, Msgpack };
+
+    /// MIME type for an encoding, e.g. "application/cbor"
+    const char* content_type(Encoding encoding);
+
+    /// Pick a response encoding from an Accept header.
+    /// Binary formats are only used when explicitly asked for (and not
+    /// with q=0); JSON otherwise.
+    Encoding negotiate_encoding(std::string_view accept_header);
+
+    /// Encoding named by a Content-Type header, or Json if unrecognized
+    Encoding encoding_from_content_type(std::string_view content_type_header);
+
+    /// Streaming serializer interface shared by the JSON, CBOR and
+    /// MessagePack writers. Containers take their element count up front
+    /// because the binary formats encode it in the header; the JSON writer
+    /// ignores it.
+    class StructuredWriter
+    {
+    public:
+        virtual ~StructuredWriter() = default;
+
+        virtual StructuredWriter& begin_object(std::size_t count) = 0;
+        virtual StructuredWriter& end_object() = 0;
+        virtual StructuredWriter& begin_array(std::size_t count) = 0;
+        virtual StructuredWriter& end_array() = 0;
+
+        virtual StructuredWriter& key(std::string_view name) = 0;
+
+        virtual StructuredWriter& value(std::string_view text) = 0;
+        virtual StructuredWriter& value(bool flag) = 0;
+        virtual StructuredWriter& value(double number) = 0;
+        virtual StructuredWriter& null() = 0;
+
+        StructuredWriter& value(const char* text) { return value(std::string_view(text)); }
+        StructuredWriter& value(const std::string& text) { return value(std::string_view(text)); }
+
+        template <std::integral T>
+        StructuredWriter& value(T number)
+        {
+            if constexpr (std::is_signed_v<T>)
+                return write_integer(static_cast<std::int64_t>(number));
+            else
+                return write_integer(static_cast<std::uint64_t>(number));
+        }
+
+        /// key(name).value(v) in one call
+        template <typename T>
+        StructuredWriter& field(std::string_view name, const T& v)
+        {
+            key(name);
+            return value(v);
+        }
+
+    protected:
+        virtual StructuredWriter& write_integer(std::int64_t number) = 0;
+        virtual StructuredWriter& write_integer(std::uint64_t number) = 0;
+    };
+
+    /// Create a writer for `encoding` that appends to `out`
+    std::unique_ptr<StructuredWriter> make_writer(Encoding encoding, std::string& out);
+
+} // namespace vault::utils
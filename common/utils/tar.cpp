@@ -0,0 +1,274 @@
+#include "utils/tar.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace vault::utils
+{
+    // ustar header field offsets
+    static constexpr std::size_t kNameOffset = 0;
+    static constexpr std::size_t kNameSize = 100;
+    static constexpr std::size_t kModeOffset = 100;
+    static constexpr std::size_t kUidOffset = 108;
+    static constexpr std::size_t kGidOffset = 116;
+    static constexpr std::size_t kSizeOffset = 124;
+    static constexpr std::size_t kMtimeOffset = 136;
+    static constexpr std::size_t kChecksumOffset = 148;
+    static constexpr std::size_t kTypeOffset = 156;
+    static constexpr std::size_t kMagicOffset = 257;
+
+    static constexpr char kLongNameMarker[] = "././@LongLink";
+
+    /// Write `value` as a zero-padded octal number terminated by NUL
+    static void put_octal(char* field, std::size_t width, std::uint64_t value)
+    {
+        field[width - 1] = '\0';
+        for (std::size_t i = width - 1; i-- > 0;)
+        {
+            field[i] = static_cast<char>('0' + (value & 7));
+            value >>= 3;
+        }
+    }
+
+    /// Sizes that don't fit 11 octal digits (8 GiB) use the GNU base-256 form
+    static void put_size(char* field, std::uint64_t size)
+    {
+        if (size < (1ull << 33))
+        {
+            put_octal(field, 12, size);
+            return;
+        }
+        std::memset(field, 0, 12);
+        field[0] = static_cast<char>(0x80);
+        for (int i = 11; i >= 4; --i)
+        {
+            field[i] = static_cast<char>(size & 0xFF);
+            size >>= 8;
+        }
+    }
+
+    static std::uint64_t get_size(const char* field)
+    {
+        std::uint64_t value = 0;
+        if (static_cast<unsigned char>(field[0]) & 0x80)
+        {
+            for (int i = 4; i < 12; ++i)
+            {
+                value = (value << 8) | static_cast<unsigned char>(field[i]);
+            }
+            return value;
+        }
+        for (int i = 0; i < 12 && field[i] >= '0' && field[i] <= '7'; ++i)
+        {
+            value = (value << 3) | static_cast<std::uint64_t>(field[i] - '0');
+        }
+        return value;
+    }
+
+    static unsigned block_checksum(const char* block)
+    {
+        unsigned sum = 0;
+        for (std::size_t i = 0; i < kTarBlockSize; ++i)
+        {
+            bool in_checksum = i >= kChecksumOffset && i < kChecksumOffset + 8;
+            sum += in_checksum ? ' ' : static_cast<unsigned char>(block[i]);
+        }
+        return sum;
+    }
+
+    static std::string make_block(const std::string& name, std::uint64_t size,
+                                  std::int64_t mtime, char type)
+    {
+        std::string block(kTarBlockSize, '\0');
+        char* b = block.data();
+
+        std::memcpy(b + kNameOffset, name.data(), std::min(name.size(), kNameSize));
+        put_octal(b + kModeOffset, 8, 0600);
+        put_octal(b + kUidOffset, 8, 0);
+        put_octal(b + kGidOffset, 8, 0);
+        put_size(b + kSizeOffset, size);
+        put_octal(b + kMtimeOffset, 12, static_cast<std::uint64_t>(std::max<std::int64_t>(mtime, 0)));
+        b[kTypeOffset] = type;
+        std::memcpy(b + kMagicOffset, "ustar\0" "00", 8);
+
+        put_octal(b + kChecksumOffset, 7, block_checksum(b));
+        b[kChecksumOffset + 7] = ' ';
+        return block;
+    }
+
+    // ─── Writing ────────────────────────────────────────────────────────────────
+
+    std::string tar_entry_header(const std::string& name, std::uint64_t size, std::int64_t mtime)
+    {
+        std::string out;
+        if (name.size() > kNameSize)
+        {
+            // GNU long name: a pseudo-entry whose data is the real name
+            out += make_block(kLongNameMarker, name.size() + 1, mtime, 'L');
+            out += name;
+            out.append(1 + tar_padding(name.size() + 1), '\0');
+        }
+        out += make_block(name, size, mtime, '0');
+        return out;
+    }
+
+    std::size_t tar_padding(std::uint64_t size)
+    {
+        auto rem = static_cast<std::size_t>(size % kTarBlockSize);
+        return rem == 0 ? 0 : kTarBlockSize - rem;
+    }
+
+    std::uint64_t tar_entry_size(const std::string& name, std::uint64_t size)
+    {
+        std::uint64_t header = kTarBlockSize;
+        if (name.size() > kNameSize)
+        {
+            header += kTarBlockSize + (name.size() + 1) + tar_padding(name.size() + 1);
+        }
+        return header + size + tar_padding(size);
+    }
+
+    std::string tar_end_of_archive()
+    {
+        return std::string(2 * kTarBlockSize, '\0');
+    }
+
+    // ─── Reading ────────────────────────────────────────────────────────────────
+
+    bool TarReader::fail(const std::string& message)
+    {
+        error_ = message;
+        return false;
+    }
+
+    bool TarReader::parse_header()
+    {
+        const char* b = block_.data();
+
+        if (std::all_of(block_.begin(), block_.end(), [](char c) { return c == '\0'; }))
+        {
+            if (++zero_blocks_ == 2) state_ = State::Done;
+            return true;
+        }
+        zero_blocks_ = 0;
+
+        unsigned stored = 0;
+        std::size_t i = kChecksumOffset;
+        while (i < kChecksumOffset + 8 && b[i] == ' ') ++i;   // some writers left-pad
+        for (; i < kChecksumOffset + 8 && b[i] >= '0' && b[i] <= '7'; ++i)
+        {
+            stored = (stored << 3) | static_cast<unsigned>(b[i] - '0');
+        }
+        if (stored != block_checksum(b))
+        {
+            return fail("Corrupt tar header (checksum mismatch)");
+        }
+
+        std::uint64_t size = get_size(b + kSizeOffset);
+        char type = b[kTypeOffset];
+
+        if (type == 'L')
+        {
+            long_name_.clear();
+            remaining_ = size;
+            padding_ = tar_padding(size);
+            state_ = State::LongName;
+            return true;
+        }
+
+        std::string name;
+        if (!long_name_.empty())
+        {
+            name = std::move(long_name_);
+            long_name_.clear();
+        }
+        else
+        {
+            name.assign(b + kNameOffset, strnlen(b + kNameOffset, kNameSize));
+        }
+
+        remaining_ = size;
+        padding_ = tar_padding(size);
+        skipping_ = !(type == '0' || type == '\0');
+        state_ = State::Data;
+
+        if (!skipping_ && on_entry && !on_entry(name, size))
+        {
+            return fail("Aborted");
+        }
+        return true;
+    }
+
+    bool TarReader::feed(const char* data, std::size_t size)
+    {
+        while (size > 0)
+        {
+            switch (state_)
+            {
+                case State::Done:
+                    return true;   // trailing zero padding after the end marker
+
+                case State::Header:
+                {
+                    auto take = std::min(size, kTarBlockSize - block_.size());
+                    block_.append(data, take);
+                    data += take;
+                    size -= take;
+                    if (block_.size() < kTarBlockSize) break;
+                    bool ok = parse_header();
+                    block_.clear();
+                    if (!ok) return false;
+                    break;
+                }
+
+                case State::LongName:
+                case State::Data:
+                {
+                    auto take = static_cast<std::size_t>(std::min<std::uint64_t>(size, remaining_));
+                    if (state_ == State::LongName)
+                    {
+                        long_name_.append(data, take);
+                    }
+                    else if (!skipping_ && take > 0 && on_data && !on_data(data, take))
+                    {
+                        return fail("Aborted");
+                    }
+                    data += take;
+                    size -= take;
+                    remaining_ -= take;
+                    if (remaining_ > 0) break;
+
+                    if (state_ == State::LongName)
+                    {
+                        long_name_.resize(strnlen(long_name_.data(), long_name_.size()));
+                    }
+                    else if (!skipping_ && on_entry_end && !on_entry_end())
+                    {
+                        return fail("Aborted");
+                    }
+                    state_ = padding_ > 0 ? State::Padding : State::Header;
+                    break;
+                }
+
+                case State::Padding:
+                {
+                    auto take = std::min(size, padding_);
+                    data += take;
+                    size -= take;
+                    padding_ -= take;
+                    if (padding_ == 0) state_ = State::Header;
+                    break;
+                }
+            }
+        }
+
+        // A zero-length entry completes as soon as its header is parsed
+        if (state_ == State::Data && remaining_ == 0)
+        {
+            if (!skipping_ && on_entry_end && !on_entry_end()) return fail("Aborted");
+            state_ = padding_ > 0 ? State::Padding : State::Header;
+        }
+        return true;
+    }
+
+} // namespace vault::utils
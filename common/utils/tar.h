@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace vault::utils
+{
+
+    // ─── Tar Archive Writing ────────────────────────────────────────────────────
+
+    constexpr std::size_t kTarBlockSize = 512;
+
+    /// Header block(s) for a regular file entry. Names longer than 100 bytes
+    /// are preceded by a GNU long-name record, so the result may span
+    /// several blocks.
+    std::string tar_entry_header(const std::string& name, std::uint64_t size,
+                                 std::int64_t mtime = 0);
+
+    /// Zero bytes needed after `size` bytes of data to reach a block boundary
+    std::size_t tar_padding(std::uint64_t size);
+
+    /// Total archive bytes an entry occupies: header(s) + data + padding
+    std::uint64_t tar_entry_size(const std::string& name, std::uint64_t size);
+
+    /// The two zero blocks that terminate an archive
+    std::string tar_end_of_archive();
+
+    // ─── Tar Archive Reading ────────────────────────────────────────────────────
+
+    /// Incremental tar parser: feed it bytes as they arrive and it reports
+    /// entries through callbacks without ever buffering file contents.
+    /// Understands ustar regular files and GNU long names; other entry
+    /// types are skipped.
+    class TarReader
+    {
+    public:
+        /// Called when an entry starts. Return false to abort.
+        std::function<bool(const std::string& name, std::uint64_t size)> on_entry;
+
+        /// Called with consecutive slices of the current entry's data
+        std::function<bool(const char* data, std::size_t size)> on_data;
+
+        /// Called once the current entry's data is complete
+        std::function<bool()> on_entry_end;
+
+        /// Consume bytes. Returns false on malformed input or if a callback aborted.
+        bool feed(const char* data, std::size_t size);
+
+        /// True once the end-of-archive marker has been read
+        bool finished() const { return state_ == State::Done; }
+
+        const std::string& error() const { return error_; }
+
+    private:
+        enum class State { Header, Data, LongName, Padding, Done };
+
+        bool parse_header();
+        bool fail(const std::string& message);
+
+        State state_ = State::Header;
+        std::string block_;              // partial header block
+        std::string long_name_;          // pending GNU long name
+        std::uint64_t remaining_ = 0;    // data bytes left in the entry
+        std::size_t padding_ = 0;        // padding bytes left to skip
+        bool skipping_ = false;          // current entry is not reported
+        int zero_blocks_ = 0;
+        std::string error_;
+    };
+
+} // namespace vault::utils
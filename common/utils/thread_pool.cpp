@@ -0,0 +1,72 @@
+#include "utils/thread_pool.h"
+
+namespace vault::utils
+{
+
+    ThreadPool::ThreadPool(std::size_t threads, std::size_t max_queued)
+        : max_queued_(max_queued)
+    {
+        if (threads == 0) threads = 1;
+        workers_.reserve(threads);
+        for (std::size_t i = 0; i < threads; ++i)
+        {
+            workers_.emplace_back([this] { worker_loop(); });
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        shutdown();
+    }
+
+    bool ThreadPool::try_submit(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) return false;
+            if (max_queued_ != 0 && queue_.size() >= max_queued_) return false;
+            queue_.push_back(std::move(task));
+        }
+        cv_.notify_one();
+        return true;
+    }
+
+    void ThreadPool::shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_ && workers_.empty()) return;
+            stopping_ = true;
+        }
+        cv_.notify_all();
+
+        for (auto& worker : workers_)
+        {
+            if (worker.joinable()) worker.join();
+        }
+        workers_.clear();
+    }
+
+    std::size_t ThreadPool::queued() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return queue_.size();
+    }
+
+    void ThreadPool::worker_loop()
+    {
+        for (;;)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+                if (queue_.empty()) return; // stopping and drained
+                task = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            task();
+        }
+    }
+
+} // namespace vault::utils
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace vault::utils
+{
+
+    /// Fixed-size worker pool with an optional bound on queued tasks.
+    /// When the bound is reached, try_submit() refuses work instead of
+    /// letting the backlog (and caller latency) grow without limit.
+    class ThreadPool
+    {
+    public:
+        /// max_queued = 0 means the queue is unbounded
+        explicit ThreadPool(std::size_t threads, std::size_t max_queued = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /// Queue a task. Returns false if the pool is saturated or stopped.
+        bool try_submit(std::function<void()> task);
+
+        /// Queue a task and get a future for its result.
+        /// Returns std::nullopt if the pool is saturated or stopped.
+        template <typename F>
+        auto try_async(F&& fn) -> std::optional<std::future<std::invoke_result_t<F>>>
+        {
+            using R = std::invoke_result_t<F>;
+            auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(fn));
+            auto future = task->get_future();
+            if (!try_submit([task] { (*task)(); }))
+            {
+                return std::nullopt;
+            }
+            return future;
+        }
+
+        /// Stop accepting work, finish queued tasks and join the workers
+        void shutdown();
+
+        std::size_t thread_count() const { return workers_.size(); }
+        std::size_t max_queued() const { return max_queued_; }
+
+        /// Number of tasks waiting for a worker
+        std::size_t queued() const;
+
+    private:
+        void worker_loop();
+
+        std::vector<std::thread> workers_;
+        std::deque<std::function<void()>> queue_;
+        std::size_t max_queued_;
+        bool stopping_ = false;
+
+        mutable std::mutex mutex_;
+        std::condition_variable cv_;
+    };
+
+} // namespace vault::utils
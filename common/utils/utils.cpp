@@ -6,6 +6,7 @@
 #include <stdexcept>
 #include <chrono>
 #include <ctime>
+#include <cstdio>
 
 namespace vault::utils
 {
@@ -114,4 +115,80 @@ namespace vault::utils
         return std::filesystem::path(path).filename().string();
     }
 
-}
\ No newline at end of file
+    // ─── HTTP Dates ─────────────────────────────────────────────────────────────
+
+    static const char* const kWeekdays[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+    static const char* const kMonths[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                          "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+    /// Days since 1970-01-01 for a proleptic Gregorian date (no timegm on all platforms)
+    static std::int64_t days_from_civil(std::int64_t y, unsigned m, unsigned d)
+    {
+        y -= m <= 2;
+        std::int64_t era = (y >= 0 ? y : y - 399) / 400;
+        auto yoe = static_cast<unsigned>(y - era * 400);
+        unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+        unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return era * 146097 + static_cast<std::int64_t>(doe) - 719468;
+    }
+
+    std::string format_http_date(std::int64_t unix_time)
+    {
+        auto time_t_val = static_cast<std::time_t>(unix_time);
+        struct tm tm_buf;
+
+    #ifdef _WIN32
+        gmtime_s(&tm_buf, &time_t_val);
+    #else
+        gmtime_r(&time_t_val, &tm_buf);
+    #endif
+
+        // Names are spelled out rather than using %a/%b, which follow the locale
+        char buf[40];
+        std::snprintf(buf, sizeof(buf), "%s, %02d %s %04d %02d:%02d:%02d GMT",
+                      kWeekdays[tm_buf.tm_wday], tm_buf.tm_mday, kMonths[tm_buf.tm_mon],
+                      tm_buf.tm_year + 1900, tm_buf.tm_hour, tm_buf.tm_min, tm_buf.tm_sec);
+        return buf;
+    }
+
+    std::optional<std::int64_t> parse_http_date(const std::string& value)
+    {
+        char weekday[4] = {};
+        char month[4] = {};
+        int day = 0, year = 0, hour = 0, minute = 0, second = 0;
+        if (std::sscanf(value.c_str(), "%3s, %d %3s %d %d:%d:%d GMT",
+                        weekday, &day, month, &year, &hour, &minute, &second) != 7)
+        {
+            return std::nullopt;
+        }
+
+        unsigned mon = 0;
+        while (mon < 12 && std::string(kMonths[mon]) != month) ++mon;
+        if (mon == 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60)
+        {
+            return std::nullopt;
+        }
+
+        return days_from_civil(year, mon + 1, static_cast<unsigned>(day)) * 86400 +
+               hour * 3600 + minute * 60 + second;
+    }
+
+    std::optional<std::int64_t> parse_iso8601(const std::string& value)
+    {
+        int year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0;
+        if (std::sscanf(value.c_str(), "%4d-%2d-%2dT%2d:%2d:%2d",
+                        &year, &month, &day, &hour, &minute, &second) != 6 ||
+            value.empty() || value.back() != 'Z')
+        {
+            return std::nullopt;
+        }
+        if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60)
+        {
+            return std::nullopt;
+        }
+
+        return days_from_civil(year, static_cast<unsigned>(month), static_cast<unsigned>(day)) * 86400 +
+               hour * 3600 + minute * 60 + second;
+    }
+
+}
@@ -4,6 +4,7 @@
 #include <vector>
 #include <cstdint>
 #include <filesystem>
+#include <optional>
 
 namespace vault::utils 
 {
@@ -27,4 +28,14 @@ namespace vault::utils
     /// Get the filename from a path string
     std::string extract_filename(const std::string& path);
 
+    /// Format a Unix time as an HTTP date, e.g. "Sun, 06 Nov 1994 08:49:37 GMT"
+    std::string format_http_date(std::int64_t unix_time);
+
+    /// Parse an HTTP date (IMF-fixdate). Returns nullopt if malformed.
+    std::optional<std::int64_t> parse_http_date(const std::string& value);
+
+    /// Parse an ISO 8601 UTC time, e.g. "2009-10-12T17:50:30.000Z" (fractional
+    /// seconds are dropped). Returns nullopt if malformed.
+    std::optional<std::int64_t> parse_iso8601(const std::string& value);
+
 } // namespace vault::utils
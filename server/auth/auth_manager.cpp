@@ -1,16 +1,19 @@
 #include "auth/auth_manager.h"
 #include "crypto/crypto.h"
+#include "logging/logger.h"
 
 #include <fstream>
 #include <sstream>
-#include <iostream>
 
 namespace vault::server 
 {
 
-    AuthManager::AuthManager(const std::filesystem::path& data_dir)
+    AuthManager::AuthManager(const std::filesystem::path& data_dir,
+                             std::size_t hash_threads,
+                             std::size_t hash_queue)
         : data_dir_(data_dir)
         , users_file_(data_dir / "users.dat")
+        , hash_pool_(hash_threads, hash_queue)
     {
         std::filesystem::create_directories(data_dir_);
         load_users();
@@ -35,11 +38,13 @@ namespace vault::server
                 users_[username] = models::User{username, hash, salt};
             }
         }
-        std::cout << "[Auth] Loaded " << users_.size() << " user(s)\n";
+        logging::info("Auth", "Loaded " + std::to_string(users_.size()) + " user(s)");
     }
 
     void AuthManager::save_user(const models::User& user) 
     {
+        std::lock_guard<std::mutex> lock(file_mutex_);
+
         std::ofstream file(users_file_, std::ios::app);
         if (!file.is_open()) 
         {
@@ -49,54 +54,135 @@ namespace vault::server
         file << user.username << ":" << user.password_hash << ":" << user.salt << "\n";
     }
 
+    std::string AuthManager::hash_password(const std::string& password,
+                                           const std::string& salt)
+    {
+        // PERF: Hashing is deliberately expensive, so it runs on a bounded pool.
+        // When the pool is full we fail fast rather than queueing unbounded work.
+        auto job = hash_pool_.try_async([&password, &salt]
+        {
+            return crypto::sha256_hash(password, salt);
+        });
+        if (!job)
+        {
+            throw AuthBusyError(1);
+        }
+        return job->get();
+    }
+
     bool AuthManager::register_user(const std::string& username,
                                      const std::string& password) 
     {
-        std::lock_guard<std::mutex> lock(mutex_);
-
-        // Check if user already exists
-        if (users_.find(username) != users_.end()) 
+        // Cheap early rejection before paying for a hash
         {
-            return false;
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (users_.find(username) != users_.end()) 
+            {
+                return false;
+            }
         }
 
         // SECURITY: Generate unique salt per user, hash password with salt
         std::string salt = crypto::generate_salt();
-        std::string hash = crypto::sha256_hash(password, salt);
+        std::string hash = hash_password(password, salt);
 
         models::User user{username, hash, salt};
-        users_[username] = user;
-        save_user(user);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
 
-        std::cout << "[Auth] Registered user: " << username << "\n";
+            // Re-check: another request may have registered the name meanwhile
+            if (!users_.emplace(username, user).second) 
+            {
+                return false;
+            }
+        }
+
+        try 
+        {
+            save_user(user);
+        } 
+        catch (...) 
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            users_.erase(username);
+            throw;
+        }
+
+        logging::info("Auth", "Registered user: " + username);
+        if (register_observer_) register_observer_(user);
         return true;
     }
 
-    std::optional<std::string> AuthManager::login(const std::string& username,
-                                                   const std::string& password) 
+    bool AuthManager::add_user(const models::User& user) 
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!users_.emplace(user.username, user).second) 
+            {
+                return false;
+            }
+        }
+
+        try 
+        {
+            save_user(user);
+        } 
+        catch (...) 
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            users_.erase(user.username);
+            throw;
+        }
+
+        logging::info("Auth", "Replicated user: " + user.username);
+        return true;
+    }
+
+    std::vector<models::User> AuthManager::users() const 
     {
         std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<models::User> all;
+        all.reserve(users_.size());
+        for (const auto& [name, user] : users_) 
+        {
+            all.push_back(user);
+        }
+        return all;
+    }
 
-        auto it = users_.find(username);
-        if (it == users_.end()) 
+    std::optional<std::string> AuthManager::login(const std::string& username,
+                                                   const std::string& password) 
+    {
+        std::string salt;
+        std::string expected_hash;
         {
-            return std::nullopt; // User not found
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            auto it = users_.find(username);
+            if (it == users_.end()) 
+            {
+                return std::nullopt; // User not found
+            }
+            salt = it->second.salt;
+            expected_hash = it->second.password_hash;
         }
 
         // SECURITY: Re-hash the provided password with the stored salt and compare
-        const auto& user = it->second;
-        std::string hash = crypto::sha256_hash(password, user.salt);
+        std::string hash = hash_password(password, salt);
 
-        if (hash != user.password_hash) 
+        if (hash != expected_hash) 
         {
             return std::nullopt; // Wrong password
         }
 
         // Generate session token
         std::string token = crypto::generate_token();
-        sessions_[token] = username;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            sessions_[token] = username;
+        }
 
-        std::cout << "[Auth] User logged in: " << username << "\n";
+        logging::info("Auth", "User logged in: " + username);
         return token;
     }
 
@@ -118,4 +204,16 @@ namespace vault::server
         sessions_.erase(token);
     }
 
+    std::size_t AuthManager::user_count() const 
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return users_.size();
+    }
+
+    std::size_t AuthManager::session_count() const 
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return sessions_.size();
+    }
+
 } 
@@ -1,26 +1,67 @@
 #pragma once
 
 #include "models/user.h"
+#include "utils/thread_pool.h"
 
 #include <string>
+#include <functional>
+#include <stdexcept>
 #include <optional>
 #include <unordered_map>
 #include <mutex>
 #include <filesystem>
+#include <vector>
 
 namespace vault::server 
 {
 
+    /// Thrown when the password hashing pool is saturated.
+    /// Callers should answer 503 and ask the client to retry later.
+    class AuthBusyError : public std::runtime_error
+    {
+    public:
+        explicit AuthBusyError(int retry_after_seconds)
+            : std::runtime_error("Authentication service busy, please retry")
+            , retry_after_seconds_(retry_after_seconds)
+        {
+        }
+
+        int retry_after_seconds() const { return retry_after_seconds_; }
+
+    private:
+        int retry_after_seconds_;
+    };
+
     /// Manages user registration, authentication, and session tokens
     class AuthManager 
     {
     public:
-        explicit AuthManager(const std::filesystem::path& data_dir = "data");
+        /// Called with each newly registered account once it is saved
+        using RegisterObserver = std::function<void(const models::User&)>;
+
+        /// hash_threads / hash_queue size the password hashing pool.
+        /// Hashing never runs under the session lock.
+        explicit AuthManager(const std::filesystem::path& data_dir = "data",
+                             std::size_t hash_threads = 2,
+                             std::size_t hash_queue = 32);
 
         /// Register a new user. Returns false if username already exists.
+        /// Throws AuthBusyError if the hashing pool is saturated.
         bool register_user(const std::string& username, const std::string& password);
 
+        /// Add an account copied from a primary server, keeping its hash and
+        /// salt. Returns false if the username already exists.
+        bool add_user(const models::User& user);
+
+        /// Every registered account, for copying to a replica
+        std::vector<models::User> users() const;
+
+        /// Observe registrations (e.g. to log them for replicas). Set before
+        /// serving requests; it runs on the registering thread.
+        void set_register_observer(RegisterObserver observer) { register_observer_ = std::move(observer); }
+
         /// Authenticate user. Returns session token on success.
+        /// Throws AuthBusyError if the hashing pool is saturated.
         std::optional<std::string> login(const std::string& username,
                                          const std::string& password);
 
@@ -30,17 +71,30 @@ namespace vault::server
         /// Remove a session token (logout)
         void logout(const std::string& token);
 
+        /// Number of registered users
+        std::size_t user_count() const;
+
+        /// Number of live session tokens
+        std::size_t session_count() const;
+
     private:
         void load_users();
         void save_user(const models::User& user);
 
+        /// Run the password hash on the bounded hashing pool
+        std::string hash_password(const std::string& password, const std::string& salt);
+
         std::filesystem::path data_dir_;
         std::filesystem::path users_file_;
 
         std::unordered_map<std::string, models::User> users_;      // username → User
         std::unordered_map<std::string, std::string> sessions_;    // token → username
 
-        mutable std::mutex mutex_;
+        mutable std::mutex mutex_;       // guards users_ and sessions_
+        std::mutex file_mutex_;          // serializes appends to users_file_
+
+        utils::ThreadPool hash_pool_;
+        RegisterObserver register_observer_;
     };
 
 } 
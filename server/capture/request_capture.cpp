@@ -0,0 +1,97 @@
+#include "capture/request_capture.h"
+#include "crypto/crypto.h"
+
+#include <stdexcept>
+
+namespace vault::server
+{
+
+    static const std::string kEncSuffix = ".enc";
+
+    RequestCapture::RequestCapture(Options options)
+        : options_(std::move(options)),
+          salt_(crypto::generate_token()),
+          epoch_(std::chrono::steady_clock::now())
+    {
+        out_.open(options_.path, std::ios::app | std::ios::binary);
+        if (!out_)
+        {
+            throw std::runtime_error("Cannot open capture file: " + options_.path.string());
+        }
+        writer_ = std::thread([this] { run(); });
+    }
+
+    RequestCapture::~RequestCapture()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_one();
+        writer_.join();
+    }
+
+    std::string RequestCapture::hash(const std::string& prefix, const std::string& value) const
+    {
+        std::string keyed = salt_ + '\0' + value;
+        return prefix + crypto::sha256_hex(keyed.data(), keyed.size()).substr(0, 16);
+    }
+
+    std::string RequestCapture::user_pseudonym(const std::string& username) const
+    {
+        return hash("u", username);
+    }
+
+    std::string RequestCapture::file_pseudonym(const std::string& filename) const
+    {
+        bool enc = filename.size() > kEncSuffix.size() &&
+                   filename.compare(filename.size() - kEncSuffix.size(), kEncSuffix.size(), kEncSuffix) == 0;
+        std::string base = enc ? filename.substr(0, filename.size() - kEncSuffix.size()) : filename;
+        return hash("f", base) + (enc ? kEncSuffix : "");
+    }
+
+    void RequestCapture::write(std::string line)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (pending_.size() >= options_.max_pending)
+            {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            pending_.push_back(std::move(line));
+        }
+        cv_.notify_one();
+    }
+
+    void RequestCapture::run()
+    {
+        std::vector<std::string> batch;
+        for (;;)
+        {
+            bool stopping;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+                batch.swap(pending_);
+                stopping = stopping_;
+            }
+
+            // PERF: One flush per batch, not per line
+            for (const auto& line : batch)
+            {
+                out_ << line << '\n';
+            }
+            out_.flush();
+            written_.fetch_add(batch.size(), std::memory_order_relaxed);
+            batch.clear();
+
+            if (stopping)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (pending_.empty()) return;
+            }
+        }
+    }
+
+} // namespace vault::server
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vault::server
+{
+
+    /// Appends one JSON line per finished request to a trace file, for
+    /// vault_replay to play back later.
+    ///
+    /// Usernames and filenames are replaced by salted hashes. The salt is
+    /// random per capture and never written, so a trace can't be matched
+    /// against guessed names, yet the same name always maps to the same
+    /// pseudonym within one trace. Passwords and file contents are never
+    /// recorded.
+    ///
+    /// Lines are handed to a background thread, so a slow disk never stalls
+    /// a request. If the writer falls behind by more than `max_pending`
+    /// lines, further lines are dropped and counted.
+    class RequestCapture
+    {
+    public:
+        struct Options
+        {
+            std::filesystem::path path;
+            bool payloads = false;            // also record small JSON request bodies
+            std::size_t max_pending = 65536;  // queued lines before dropping
+        };
+
+        /// Opens (appends to) the trace. Throws std::runtime_error if it can't.
+        explicit RequestCapture(Options options);
+
+        /// Writes out everything queued, then closes the file
+        ~RequestCapture();
+
+        RequestCapture(const RequestCapture&) = delete;
+        RequestCapture& operator=(const RequestCapture&) = delete;
+
+        bool payloads() const { return options_.payloads; }
+
+        /// Time zero of the trace; each line's "t_us" is relative to it
+        std::chrono::steady_clock::time_point epoch() const { return epoch_; }
+
+        /// Stable pseudonym for a username
+        std::string user_pseudonym(const std::string& username) const;
+
+        /// Stable pseudonym for a filename. A trailing ".enc" is kept as is
+        /// and left out of the hash, so "a.txt" and "a.txt.enc" still refer to
+        /// the same stored object after pseudonymisation.
+        std::string file_pseudonym(const std::string& filename) const;
+
+        /// Queue one complete JSON line (without the newline)
+        void write(std::string line);
+
+        std::uint64_t written() const { return written_.load(std::memory_order_relaxed); }
+        std::uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    private:
+        std::string hash(const std::string& prefix, const std::string& value) const;
+        void run();
+
+        Options options_;
+        std::string salt_;
+        std::chrono::steady_clock::time_point epoch_;
+        std::ofstream out_;
+
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        std::vector<std::string> pending_;
+        bool stopping_ = false;
+        std::atomic<std::uint64_t> written_{0};
+        std::atomic<std::uint64_t> dropped_{0};
+        std::thread writer_;
+    };
+
+} // namespace vault::server
@@ -0,0 +1,463 @@
+#include "config/server_config.h"
+#include "core/work_stealing_queue.h"
+#include "logging/logger.h"
+#include "storage/local_backend.h"
+#include "storage/memory_backend.h"
+#include "storage/s3_backend.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <sys/socket.h>
+#endif
+
+using json = nlohmann::json;
+
+namespace vault::server
+{
+
+    std::size_t ServerConfig::effective_worker_threads() const
+    {
+        if (worker_threads != 0) return worker_threads;
+
+        // Same sizing rule httplib uses for its own default pool
+        unsigned hw = std::thread::hardware_concurrency();
+        return hw > 0 ? std::max<std::size_t>(8, hw - 1) : 8;
+    }
+
+    std::size_t ServerConfig::threads_per_listener() const
+    {
+        std::size_t n = std::max<std::size_t>(1, listeners);
+        return (effective_worker_threads() + n - 1) / n;
+    }
+
+    // ─── Config File ────────────────────────────────────────────────────────────
+
+    static RateLimit parse_rate_limit(const json& j)
+    {
+        RateLimit limit;
+        limit.rate = j.value("rate", 0.0);
+        limit.burst = j.value("burst", limit.rate);
+        return limit;
+    }
+
+    void load_config_file(const std::filesystem::path& path, ServerConfig& config)
+    {
+        std::ifstream file(path);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("Cannot open config file: " + path.string());
+        }
+
+        json j = json::parse(file, nullptr, false);
+        if (j.is_discarded() || !j.is_object())
+        {
+            throw std::runtime_error("Invalid JSON in config file: " + path.string());
+        }
+
+        config.host                 = j.value("host", config.host);
+        config.port                 = j.value("port", config.port);
+        config.data_dir             = j.value("data_dir", config.data_dir.string());
+        config.storage_dir          = j.value("storage_dir", config.storage_dir.string());
+        config.storage_backend      = j.value("storage_backend", config.storage_backend);
+        config.s3_endpoint          = j.value("s3_endpoint", config.s3_endpoint);
+        config.s3_bucket            = j.value("s3_bucket", config.s3_bucket);
+        config.s3_region            = j.value("s3_region", config.s3_region);
+        config.s3_prefix            = j.value("s3_prefix", config.s3_prefix);
+        config.s3_access_key        = j.value("s3_access_key", config.s3_access_key);
+        config.s3_secret_key        = j.value("s3_secret_key", config.s3_secret_key);
+        config.s3_part_size         = j.value("s3_part_size", config.s3_part_size);
+        config.core                 = j.value("core", config.core);
+        config.listeners            = j.value("listeners", config.listeners);
+        config.worker_threads       = j.value("worker_threads", config.worker_threads);
+        config.max_queued_requests  = j.value("max_queued_requests", config.max_queued_requests);
+        config.task_queue           = j.value("task_queue", config.task_queue);
+        config.keep_alive_max_count = j.value("keep_alive_max_count", config.keep_alive_max_count);
+        config.keep_alive_timeout   = j.value("keep_alive_timeout", config.keep_alive_timeout);
+        config.read_timeout         = j.value("read_timeout", config.read_timeout);
+        config.write_timeout        = j.value("write_timeout", config.write_timeout);
+        config.payload_max_length   = j.value("payload_max_length", config.payload_max_length);
+        config.tcp_nodelay          = j.value("tcp_nodelay", config.tcp_nodelay);
+        config.hash_threads         = j.value("hash_threads", config.hash_threads);
+        config.hash_queue           = j.value("hash_queue", config.hash_queue);
+        config.store_threads        = j.value("store_threads", config.store_threads);
+        config.scrub_rate           = j.value("scrub_rate", config.scrub_rate);
+        config.scrub_interval       = j.value("scrub_interval", config.scrub_interval);
+        config.rate_limit           = j.value("rate_limit", config.rate_limit);
+        config.replicate_from       = j.value("replicate_from", config.replicate_from);
+        config.replication_secret   = j.value("replication_secret", config.replication_secret);
+        config.replication_log      = j.value("replication_log", config.replication_log);
+        config.log_level            = j.value("log_level", config.log_level);
+        config.log_format           = j.value("log_format", config.log_format);
+        config.capture_file         = j.value("capture_file", config.capture_file.string());
+        config.capture_payloads     = j.value("capture_payloads", config.capture_payloads);
+
+        // "rate_limits": { "/login": { "per_ip": {"rate": 5, "burst": 10} }, "*": {...} }
+        if (j.contains("rate_limits") && j["rate_limits"].is_object())
+        {
+            for (const auto& [route, limits] : j["rate_limits"].items())
+            {
+                RouteRateLimits parsed;
+                if (limits.contains("per_ip"))   parsed.per_ip = parse_rate_limit(limits["per_ip"]);
+                if (limits.contains("per_user")) parsed.per_user = parse_rate_limit(limits["per_user"]);
+                config.route_limits[route] = parsed;
+            }
+        }
+    }
+
+    // ─── Command Line ───────────────────────────────────────────────────────────
+
+    static void print_usage()
+    {
+        std::cout << "Usage: vault_server [options]\n"
+                  << "  --config, -c <file>        JSON config file (flags override it)\n"
+                  << "  --port, -p <port>          Server port (default: 8080)\n"
+                  << "  --host, -h <host>          Bind address (default: 0.0.0.0)\n"
+                  << "  --data-dir <dir>           User database directory (default: data)\n"
+                  << "  --storage-dir <dir>        Encrypted file storage (default: storage)\n"
+                  << "  --storage-backend <kind>   local | memory | s3 (default: local)\n"
+                  << "  --s3-endpoint <url>        S3-compatible endpoint (default: http://127.0.0.1:9000)\n"
+                  << "  --s3-bucket <name>         Bucket for --storage-backend s3\n"
+                  << "  --s3-region <region>       Signing region (default: us-east-1)\n"
+                  << "  --s3-prefix <prefix>       Prepended to every object key\n"
+                  << "  --s3-part-size <MiB>       Multipart part and read window size (default: 8)\n"
+                  << "  --core <kind>              threads | event (default: threads)\n"
+                  << "  --listeners <n>            Accept loops sharing the port (default: 1)\n"
+                  << "  --threads <n>              HTTP worker threads (default: auto)\n"
+                  << "  --queue-depth <n>          Max queued connections, 0 = unbounded\n"
+                  << "  --task-queue <kind>        pool | work-stealing (default: pool)\n"
+                  << "  --keep-alive-max <n>       Requests per keep-alive connection (default: 5)\n"
+                  << "  --keep-alive-timeout <s>   Idle keep-alive timeout (default: 5)\n"
+                  << "  --read-timeout <s>         Socket read timeout (default: 5)\n"
+                  << "  --write-timeout <s>        Socket write timeout (default: 5)\n"
+                  << "  --max-payload <bytes>      Max request body, 0 = unlimited\n"
+                  << "  --hash-threads <n>         Password hashing threads (default: 2)\n"
+                  << "  --hash-queue <n>           Queued hashes before 503 (default: 32)\n"
+                  << "  --store-threads <n>        Parallel file writes per upload (default: 4)\n"
+                  << "  --scrub-rate <MiB/s>       Background integrity check rate, 0 = off (default: 8)\n"
+                  << "  --scrub-interval <s>       Pause between integrity passes (default: 86400)\n"
+                  << "  --no-rate-limit            Disable per-IP/per-user throttling\n"
+                  << "  --replicate-from <url>     Run as a read-only replica of this primary\n"
+                  << "  --replication-secret-file <f>\n"
+                  << "                             Secret shared with replicas (or $VAULT_REPLICATION_SECRET)\n"
+                  << "  --replication-log <n>      Changes a primary keeps for replicas (default: 100000)\n"
+                  << "  --log-level <level>        debug | info | warn | error (default: info)\n"
+                  << "  --log-format <fmt>         text | json (default: text)\n"
+                  << "  --capture <file>           Append a JSONL trace of every request\n"
+                  << "  --capture-payloads         Include small JSON bodies (passwords removed)\n"
+                  << "  --help                     Show this help\n";
+    }
+
+    /// First line of `path`. Secrets are never taken from argv, where other
+    /// users of the host could see them.
+    static std::string read_secret_file(const std::string& path)
+    {
+        std::ifstream in(path);
+        std::string line;
+        if (!in || !std::getline(in, line) || line.empty())
+        {
+            throw std::invalid_argument("Cannot read a secret from " + path);
+        }
+        if (line.back() == '\r') line.pop_back();
+        return line;
+    }
+
+    static std::size_t to_size(const std::string& value)
+    {
+        return static_cast<std::size_t>(std::stoull(value));
+    }
+
+    bool parse_command_line(int argc, char* argv[], ServerConfig& config)
+    {
+        // Load the config file first so explicit flags take precedence
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if ((arg == "--config" || arg == "-c") && i + 1 < argc)
+            {
+                load_config_file(argv[i + 1], config);
+            }
+        }
+
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            bool has_value = i + 1 < argc;
+
+            if ((arg == "--config" || arg == "-c") && has_value) {
+                ++i; // already loaded
+            } else if ((arg == "--port" || arg == "-p") && has_value) {
+                config.port = std::stoi(argv[++i]);
+            } else if ((arg == "--host" || arg == "-h") && has_value) {
+                config.host = argv[++i];
+            } else if (arg == "--data-dir" && has_value) {
+                config.data_dir = argv[++i];
+            } else if (arg == "--storage-dir" && has_value) {
+                config.storage_dir = argv[++i];
+            } else if (arg == "--storage-backend" && has_value) {
+                config.storage_backend = argv[++i];
+            } else if (arg == "--s3-endpoint" && has_value) {
+                config.s3_endpoint = argv[++i];
+            } else if (arg == "--s3-bucket" && has_value) {
+                config.s3_bucket = argv[++i];
+            } else if (arg == "--s3-region" && has_value) {
+                config.s3_region = argv[++i];
+            } else if (arg == "--s3-prefix" && has_value) {
+                config.s3_prefix = argv[++i];
+            } else if (arg == "--s3-part-size" && has_value) {
+                config.s3_part_size = to_size(argv[++i]);
+            } else if (arg == "--core" && has_value) {
+                config.core = argv[++i];
+            } else if (arg == "--listeners" && has_value) {
+                config.listeners = to_size(argv[++i]);
+            } else if (arg == "--threads" && has_value) {
+                config.worker_threads = to_size(argv[++i]);
+            } else if (arg == "--queue-depth" && has_value) {
+                config.max_queued_requests = to_size(argv[++i]);
+            } else if (arg == "--task-queue" && has_value) {
+                config.task_queue = argv[++i];
+            } else if (arg == "--keep-alive-max" && has_value) {
+                config.keep_alive_max_count = to_size(argv[++i]);
+            } else if (arg == "--keep-alive-timeout" && has_value) {
+                config.keep_alive_timeout = std::stol(argv[++i]);
+            } else if (arg == "--read-timeout" && has_value) {
+                config.read_timeout = std::stol(argv[++i]);
+            } else if (arg == "--write-timeout" && has_value) {
+                config.write_timeout = std::stol(argv[++i]);
+            } else if (arg == "--max-payload" && has_value) {
+                config.payload_max_length = to_size(argv[++i]);
+            } else if (arg == "--hash-threads" && has_value) {
+                config.hash_threads = to_size(argv[++i]);
+            } else if (arg == "--hash-queue" && has_value) {
+                config.hash_queue = to_size(argv[++i]);
+            } else if (arg == "--store-threads" && has_value) {
+                config.store_threads = to_size(argv[++i]);
+            } else if (arg == "--scrub-rate" && has_value) {
+                config.scrub_rate = to_size(argv[++i]);
+            } else if (arg == "--scrub-interval" && has_value) {
+                config.scrub_interval = std::stol(argv[++i]);
+            } else if (arg == "--no-rate-limit") {
+                config.rate_limit = false;
+            } else if (arg == "--replicate-from" && has_value) {
+                config.replicate_from = argv[++i];
+            } else if (arg == "--replication-secret-file" && has_value) {
+                config.replication_secret = read_secret_file(argv[++i]);
+            } else if (arg == "--replication-log" && has_value) {
+                config.replication_log = to_size(argv[++i]);
+            } else if (arg == "--log-level" && has_value) {
+                config.log_level = argv[++i];
+            } else if (arg == "--log-format" && has_value) {
+                config.log_format = argv[++i];
+            } else if (arg == "--capture" && has_value) {
+                config.capture_file = argv[++i];
+            } else if (arg == "--capture-payloads") {
+                config.capture_payloads = true;
+            } else if (arg == "--help") {
+                print_usage();
+                return false;
+            } else {
+                throw std::invalid_argument("Unknown or incomplete option: " + arg);
+            }
+        }
+
+        if (config.replication_secret.empty())
+        {
+            const char* secret = std::getenv("VAULT_REPLICATION_SECRET");
+            if (secret) config.replication_secret = secret;
+        }
+
+        if (config.task_queue != "pool" && config.task_queue != "work-stealing")
+        {
+            throw std::invalid_argument("--task-queue must be 'pool' or 'work-stealing'");
+        }
+        if (config.core != "threads" && config.core != "event")
+        {
+            throw std::invalid_argument("--core must be 'threads' or 'event'");
+        }
+        if (config.core == "event" && !event_core_supported())
+        {
+            throw std::invalid_argument("--core event needs epoll, which this platform lacks");
+        }
+        if (config.listeners == 0)
+        {
+            throw std::invalid_argument("--listeners must be at least 1");
+        }
+        if (config.listeners > 1 && !multi_listener_supported())
+        {
+            throw std::invalid_argument("--listeners > 1 needs SO_REUSEPORT, which this platform lacks");
+        }
+        if (config.storage_backend != "local" && config.storage_backend != "memory" &&
+            config.storage_backend != "s3")
+        {
+            throw std::invalid_argument("--storage-backend must be 'local', 'memory' or 's3'");
+        }
+        if (config.storage_backend == "s3" && config.s3_bucket.empty())
+        {
+            throw std::invalid_argument("--storage-backend s3 needs --s3-bucket");
+        }
+        if (config.storage_backend == "s3" && config.s3_part_size < 5)
+        {
+            throw std::invalid_argument("--s3-part-size must be at least 5 (the S3 minimum part size)");
+        }
+        if (!config.replicate_from.empty() && config.replication_secret.empty())
+        {
+            throw std::invalid_argument("--replicate-from needs a replication secret "
+                                        "(--replication-secret-file, $VAULT_REPLICATION_SECRET "
+                                        "or \"replication_secret\" in the config file)");
+        }
+        if (config.replication_log == 0)
+        {
+            throw std::invalid_argument("--replication-log must be at least 1");
+        }
+        if (config.log_format != "text" && config.log_format != "json")
+        {
+            throw std::invalid_argument("--log-format must be 'text' or 'json'");
+        }
+        logging::parse_level(config.log_level);  // validate early
+        return true;
+    }
+
+    // ─── Applying Settings ──────────────────────────────────────────────────────
+
+    bool multi_listener_supported()
+    {
+#ifdef SO_REUSEPORT
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    /// httplib's defaults plus SO_REUSEPORT, so every listener can bind the
+    /// same address and the kernel spreads new connections across them
+    static void reuse_port_socket_options(httplib::socket_t sock)
+    {
+        int yes = 1;
+        setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&yes), sizeof(yes));
+#ifdef SO_REUSEPORT
+        setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, reinterpret_cast<const char*>(&yes), sizeof(yes));
+#endif
+    }
+
+    void apply_server_config(httplib::Server& server, const ServerConfig& config)
+    {
+        std::size_t threads = config.threads_per_listener();
+        std::size_t max_queued = config.max_queued_requests;
+
+        // PERF: httplib owns and deletes the queue it gets from this hook
+        if (config.task_queue == "work-stealing")
+        {
+            server.new_task_queue = [threads, max_queued]
+            {
+                return new WorkStealingQueue(threads, max_queued);
+            };
+        }
+        else
+        {
+            server.new_task_queue = [threads, max_queued]
+            {
+                return new httplib::ThreadPool(threads, max_queued);
+            };
+        }
+
+        server.set_keep_alive_max_count(config.keep_alive_max_count);
+        server.set_keep_alive_timeout(config.keep_alive_timeout);
+        server.set_read_timeout(config.read_timeout);
+        server.set_write_timeout(config.write_timeout);
+        server.set_tcp_nodelay(config.tcp_nodelay);
+        if (config.listeners > 1)
+        {
+            server.set_socket_options(reuse_port_socket_options);
+        }
+        server.set_payload_max_length(config.payload_max_length == 0
+            ? std::numeric_limits<std::size_t>::max()
+            : config.payload_max_length);
+    }
+
+    bool event_core_supported()
+    {
+#ifdef __linux__
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    EventServer::Options event_server_options(const ServerConfig& config)
+    {
+        EventServer::Options options;
+        options.loops = config.listeners;
+        options.workers = config.effective_worker_threads();
+        options.payload_max_length = config.payload_max_length;
+        options.keep_alive_max_count = config.keep_alive_max_count;
+        options.keep_alive_timeout = std::chrono::seconds(config.keep_alive_timeout);
+        options.read_timeout = std::chrono::seconds(config.read_timeout);
+        options.write_timeout = std::chrono::seconds(config.write_timeout);
+        options.tcp_nodelay = config.tcp_nodelay;
+        return options;
+    }
+
+    Replica::Options replica_options(const ServerConfig& config)
+    {
+        Replica::Options options;
+        options.primary = config.replicate_from;
+        options.secret = config.replication_secret;
+        return options;
+    }
+
+    /// Config value if set, else the environment variable the AWS tools use
+    static std::string credential(const std::string& configured, const char* env)
+    {
+        if (!configured.empty()) return configured;
+        const char* value = std::getenv(env);
+        return value ? value : "";
+    }
+
+    std::unique_ptr<StorageBackend> make_storage_backend(const ServerConfig& config)
+    {
+        if (config.storage_backend == "memory")
+        {
+            return std::make_unique<MemoryBackend>();
+        }
+        if (config.storage_backend == "s3")
+        {
+            S3Backend::Options options;
+            options.endpoint = config.s3_endpoint;
+            options.bucket = config.s3_bucket;
+            options.region = config.s3_region;
+            options.prefix = config.s3_prefix;
+            options.access_key = credential(config.s3_access_key, "AWS_ACCESS_KEY_ID");
+            options.secret_key = credential(config.s3_secret_key, "AWS_SECRET_ACCESS_KEY");
+            options.part_size = config.s3_part_size * 1024 * 1024;
+            options.range_size = options.part_size;
+            return std::make_unique<S3Backend>(std::move(options));
+        }
+        return std::make_unique<LocalBackend>(config.storage_dir);
+    }
+
+    void apply_rate_limits(RateLimiter& limiter, const ServerConfig& config)
+    {
+        for (const auto& [route, limits] : config.route_limits)
+        {
+            if (route == "*")
+            {
+                limiter.set_default_limits(limits);
+            }
+            else
+            {
+                limiter.set_route_limits(route, limits);
+            }
+        }
+    }
+
+}
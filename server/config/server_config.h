@@ -0,0 +1,126 @@
+#pragma once
+
+#include "core/event_server.h"
+#include "replication/replica.h"
+#include "routes/rate_limiter.h"
+#include "storage/storage_backend.h"
+
+#include <httplib.h>
+
+#include <cstddef>
+#include <ctime>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace vault::server
+{
+
+    /// Tunables for vault_server. Values come from defaults, then an optional
+    /// JSON config file, then command line flags (last one wins).
+    struct ServerConfig
+    {
+        std::string host = "0.0.0.0";
+        int port = 8080;
+
+        std::filesystem::path data_dir = "data";
+        std::filesystem::path storage_dir = "storage";
+
+        // ── Storage backend ─────────────────────────────────────────────
+        std::string storage_backend = "local";   // "local" (storage_dir), "memory" or "s3"
+        std::string s3_endpoint = "http://127.0.0.1:9000";
+        std::string s3_bucket;
+        std::string s3_region = "us-east-1";
+        std::string s3_prefix;                   // prepended to every object key
+        std::string s3_access_key;               // empty = $AWS_ACCESS_KEY_ID
+        std::string s3_secret_key;               // empty = $AWS_SECRET_ACCESS_KEY; config file only
+        std::size_t s3_part_size = 8;            // MiB per multipart part and ranged GET
+
+        // ── HTTP worker pool ────────────────────────────────────────────
+        std::string core = "threads";            // "threads" (httplib) or "event" (epoll, Linux only)
+        std::size_t listeners = 1;               // accept loops sharing the port (SO_REUSEPORT)
+        std::size_t worker_threads = 0;          // 0 = one per hardware thread; split across listeners
+        std::size_t max_queued_requests = 0;     // 0 = unbounded
+        std::string task_queue = "pool";         // "pool" or "work-stealing"
+
+        // ── Connections ─────────────────────────────────────────────────
+        std::size_t keep_alive_max_count = 5;
+        std::time_t keep_alive_timeout = 5;      // seconds
+        std::time_t read_timeout = 5;            // seconds
+        std::time_t write_timeout = 5;           // seconds
+        std::size_t payload_max_length = 0;      // bytes, 0 = unlimited
+        bool tcp_nodelay = true;
+
+        // ── Password hashing pool ───────────────────────────────────────
+        std::size_t hash_threads = 2;
+        std::size_t hash_queue = 32;
+
+        // ── Storage writer pool ─────────────────────────────────────────
+        std::size_t store_threads = 4;           // parallel writes per multi-file upload
+
+        // ── Integrity scrubbing ─────────────────────────────────────────
+        std::size_t scrub_rate = 8;              // MiB/s re-read by the scrubber, 0 = off
+        std::time_t scrub_interval = 86400;      // seconds between passes
+
+        // ── Replication ─────────────────────────────────────────────────
+        std::string replicate_from;              // primary URL; set = run as a read-only replica
+        std::string replication_secret;          // shared with replicas; empty = replication off.
+                                                 // Config file, --replication-secret-file or
+                                                 // $VAULT_REPLICATION_SECRET; never a plain flag
+        std::size_t replication_log = 100000;    // changes a primary keeps for lagging replicas
+
+        // ── Logging ─────────────────────────────────────────────────────
+        std::string log_level = "info";          // debug | info | warn | error
+        std::string log_format = "text";         // text | json
+
+        // ── Request capture ─────────────────────────────────────────────
+        std::filesystem::path capture_file;      // empty = off; JSONL trace for vault_replay
+        bool capture_payloads = false;           // also record small JSON bodies (redacted)
+
+        // ── Rate limiting ───────────────────────────────────────────────
+        bool rate_limit = true;
+        std::unordered_map<std::string, RouteRateLimits> route_limits;  // per route, "*" = default
+
+        /// Worker count after resolving 0 to the hardware concurrency
+        std::size_t effective_worker_threads() const;
+
+        /// Each listener's share of the worker threads (rounded up)
+        std::size_t threads_per_listener() const;
+    };
+
+    /// Merge settings from a JSON config file into `config`.
+    /// Throws std::runtime_error if the file cannot be read or parsed.
+    void load_config_file(const std::filesystem::path& path, ServerConfig& config);
+
+    /// Parse command line flags into `config` (loading --config first).
+    /// Returns false if the program should exit (e.g. --help was printed).
+    /// Throws std::invalid_argument on malformed values.
+    bool parse_command_line(int argc, char* argv[], ServerConfig& config);
+
+    /// True if this platform can run more than one listener on a port
+    bool multi_listener_supported();
+
+    /// Apply worker pool, keep-alive, timeout and payload settings to the
+    /// server, and SO_REUSEPORT when several listeners share the port
+    void apply_server_config(httplib::Server& server, const ServerConfig& config);
+
+    /// True if this platform can run the event-driven core
+    bool event_core_supported();
+
+    /// EventServer settings for --core event: one event loop per listener,
+    /// worker_threads handler threads shared by all of them
+    EventServer::Options event_server_options(const ServerConfig& config);
+
+    /// The backend StorageManager keeps its objects in. Throws
+    /// std::invalid_argument for incomplete settings and std::runtime_error
+    /// if the store can't be reached.
+    std::unique_ptr<StorageBackend> make_storage_backend(const ServerConfig& config);
+
+    /// Replica settings for --replicate-from
+    Replica::Options replica_options(const ServerConfig& config);
+
+    /// Apply configured per-route overrides to the rate limiter
+    void apply_rate_limits(RateLimiter& limiter, const ServerConfig& config);
+
+}
@@ -0,0 +1,1523 @@
+#include "core/event_server.h"
+#include "logging/logger.h"
+#include "utils/thread_pool.h"
+
+#include <stdexcept>
+
+#ifdef __linux__
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#endif
+
+namespace vault::server
+{
+
+#ifdef __linux__
+
+    static constexpr std::size_t kMaxHeadBytes = 64 * 1024;      // request line + headers
+    static constexpr std::size_t kMaxChunkLine = 1024;           // chunk size line or trailer
+    static constexpr std::size_t kReadChunk = 64 * 1024;         // bytes asked of each recv()
+    static constexpr std::size_t kIdleBufferBytes = 4 * 1024;    // kept between requests
+    static constexpr std::size_t kPipeCapacity = 1024 * 1024;    // request body buffered ahead of a handler
+    static constexpr std::size_t kWriteBatch = 256 * 1024;       // provider output per drain
+    static constexpr int kMaxEvents = 256;
+
+    struct Loop;
+    struct Connection;
+    class BodyPipe;
+
+    // ─── Coroutine Types ───
+
+    /// The coroutine serving one connection. It starts suspended; its loop
+    /// resumes it and closes the connection once it has finished.
+    struct ConnectionTask
+    {
+        struct promise_type
+        {
+            ConnectionTask get_return_object()
+            {
+                return ConnectionTask(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            void return_void() noexcept {}
+            void unhandled_exception() noexcept {}
+        };
+
+        ConnectionTask() = default;
+        explicit ConnectionTask(std::coroutine_handle<promise_type> h) : handle(h) {}
+        ConnectionTask(ConnectionTask&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+        ConnectionTask& operator=(ConnectionTask&& other) noexcept
+        {
+            if (this != &other)
+            {
+                if (handle) handle.destroy();
+                handle = std::exchange(other.handle, {});
+            }
+            return *this;
+        }
+        ~ConnectionTask()
+        {
+            if (handle) handle.destroy();
+        }
+
+        bool done() const { return handle && handle.done(); }
+
+        std::coroutine_handle<promise_type> handle;
+    };
+
+    /// A nested coroutine that returns a value to whoever co_awaits it.
+    /// Lazily started; control passes straight back to the awaiter when it
+    /// finishes, so nesting costs no extra trips through the loop.
+    template <typename T>
+    class Task
+    {
+    public:
+        struct promise_type
+        {
+            T value{};
+            std::exception_ptr error;
+            std::coroutine_handle<> continuation;
+
+            Task get_return_object()
+            {
+                return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            auto final_suspend() noexcept
+            {
+                struct Final
+                {
+                    bool await_ready() noexcept { return false; }
+                    std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept
+                    {
+                        return h.promise().continuation;
+                    }
+                    void await_resume() noexcept {}
+                };
+                return Final{};
+            }
+            void return_value(T v) { value = std::move(v); }
+            void unhandled_exception() { error = std::current_exception(); }
+        };
+
+        explicit Task(std::coroutine_handle<promise_type> h) : handle_(h) {}
+        Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+        ~Task()
+        {
+            if (handle_) handle_.destroy();
+        }
+
+        bool await_ready() const noexcept { return false; }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+        {
+            handle_.promise().continuation = awaiting;
+            return handle_;
+        }
+        T await_resume()
+        {
+            if (handle_.promise().error) std::rethrow_exception(handle_.promise().error);
+            return std::move(handle_.promise().value);
+        }
+
+    private:
+        std::coroutine_handle<promise_type> handle_;
+    };
+
+    // ─── Server State ───
+
+    struct Route
+    {
+        RouteRegistrar::Handler handler;
+        RouteRegistrar::HandlerWithContentReader reader;
+    };
+
+    struct ServerState
+    {
+        EventServer::Options options;
+        std::unordered_map<std::string, Route> routes;    // "METHOD /path"
+        RouteRegistrar::PreRoutingHandler pre_routing;
+        RouteRegistrar::Logger logger;
+
+        std::unique_ptr<utils::ThreadPool> pool;
+        std::vector<std::unique_ptr<Loop>> loops;
+        std::atomic<bool> stopping{false};
+        std::atomic<std::size_t> open{0};
+        int port = -1;
+
+        const Route* find(const std::string& method, const std::string& path) const
+        {
+            auto it = routes.find(method + ' ' + path);
+            return it == routes.end() ? nullptr : &it->second;
+        }
+    };
+
+    struct Connection
+    {
+        Loop* loop = nullptr;
+        int fd = -1;
+        std::string remote_addr;
+        int remote_port = -1;
+
+        std::string in;              // received bytes; unread input starts at in_pos
+        std::size_t in_pos = 0;
+        std::string out;             // bytes waiting to be sent
+
+        // Edge-triggered readiness, cleared when a call hits EAGAIN
+        bool readable = false;
+        bool writable = false;
+        bool hangup = false;
+
+        // Set while the coroutine waits for readiness
+        std::coroutine_handle<> waiter;
+        std::uint32_t waiting_for = 0;
+        std::chrono::steady_clock::time_point deadline;
+        bool timed_out = false;
+
+        BodyPipe* pipe = nullptr;    // while a handler streams the request body
+        ConnectionTask task;
+
+        bool ready(std::uint32_t event) const
+        {
+            return hangup || (event == EPOLLIN ? readable : writable);
+        }
+    };
+
+    struct Loop
+    {
+        explicit Loop(ServerState& server) : server(server) {}
+        ~Loop();
+
+        ServerState& server;
+        int epoll_fd = -1;
+        int listen_fd = -1;
+        int wake_fd = -1;
+        std::unordered_map<Connection*, std::unique_ptr<Connection>> connections;
+
+        std::mutex ready_mutex;
+        std::vector<std::pair<Connection*, std::coroutine_handle<>>> ready;
+
+        /// Any thread: resume a coroutine on this loop
+        void post(Connection* conn, std::coroutine_handle<> handle);
+        void wake();
+
+        void run();
+        void accept_all();
+        void run_ready();
+        void expire_timeouts();
+        void resume(Connection& conn, std::coroutine_handle<> handle);
+        void close(Connection& conn);
+    };
+
+    /// Everything about one request/response. Heap-allocated per request so
+    /// an idle connection's frame stays small.
+    struct Exchange
+    {
+        httplib::Request req;
+        httplib::Response res;
+        RequestTiming timing;
+        bool screened = false;           // pre-routing has already run
+    };
+
+    enum class Outcome
+    {
+        Respond,
+        RespondAndClose,
+        Close
+    };
+
+    // ─── Awaiters ───
+
+    /// Wait until the socket is readable (EPOLLIN) or writable (EPOLLOUT).
+    /// Resumes with false if the timeout passes first.
+    struct Readiness
+    {
+        Connection& conn;
+        std::uint32_t event;
+        std::chrono::seconds timeout;
+
+        bool await_ready() const noexcept { return conn.ready(event); }
+        void await_suspend(std::coroutine_handle<> handle) noexcept
+        {
+            conn.waiter = handle;
+            conn.waiting_for = event;
+            conn.deadline = std::chrono::steady_clock::now() + timeout;
+            conn.timed_out = false;
+        }
+        bool await_resume() noexcept
+        {
+            conn.waiter = {};
+            conn.waiting_for = 0;
+            return !conn.timed_out;
+        }
+    };
+
+    /// Work handed to the pool. co_await it to wait for finish(), which the
+    /// worker calls last.
+    class Job
+    {
+    public:
+        explicit Job(Connection& conn) : conn_(conn) {}
+
+        void finish()
+        {
+            std::coroutine_handle<> waiter;
+            Connection* conn = &conn_;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                done_ = true;
+                waiter = std::exchange(waiter_, {});
+            }
+            // Without a waiter the Job may already be gone; touch nothing
+            if (waiter) conn->loop->post(conn, waiter);
+        }
+
+        bool await_ready()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return done_;
+        }
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (done_) return false;
+            waiter_ = handle;
+            return true;
+        }
+        void await_resume() const noexcept {}
+
+    private:
+        Connection& conn_;
+        std::mutex mutex_;
+        bool done_ = false;
+        std::coroutine_handle<> waiter_;
+    };
+
+    /// Carries a request body from the loop (producer) to a handler blocked
+    /// in its ContentReader on a worker (consumer). Bounded: the producer
+    /// stops reading the socket while kPipeCapacity bytes are waiting, so
+    /// TCP flow control pushes back on a client that uploads faster than
+    /// the handler stores.
+    class BodyPipe
+    {
+    public:
+        explicit BodyPipe(Connection& conn) : conn_(conn) {}
+
+        struct Space
+        {
+            BodyPipe& pipe;
+            bool await_ready() { return pipe.has_space(); }
+            bool await_suspend(std::coroutine_handle<> handle) { return pipe.wait_for_space(handle); }
+            void await_resume() const noexcept {}
+        };
+
+        /// Producer: wait until there is room, or nobody left to read
+        Space space() { return Space{*this}; }
+
+        /// Producer: false once the handler has stopped reading
+        bool push(std::string_view data)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (consumer_gone_) return false;
+                chunks_.emplace_back(data);
+                buffered_ += data.size();
+            }
+            cv_.notify_one();
+            return true;
+        }
+
+        /// Producer: the body ended (complete) or cannot be finished
+        void finish(bool complete)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                finished_ = true;
+                complete_ = complete;
+            }
+            cv_.notify_one();
+        }
+
+        /// Consumer: feed the body to receiver; false if it was cut short
+        bool read(const httplib::ContentReceiver& receiver)
+        {
+            for (;;)
+            {
+                std::string chunk;
+                std::coroutine_handle<> producer;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    cv_.wait(lock, [this] { return !chunks_.empty() || finished_; });
+                    if (finished_ && !complete_) return false;
+                    if (chunks_.empty()) return true;
+                    chunk = std::move(chunks_.front());
+                    chunks_.pop_front();
+                    buffered_ -= chunk.size();
+                    consumed_ += chunk.size();
+                    if (producer_ && buffered_ <= kPipeCapacity / 2)
+                    {
+                        producer = std::exchange(producer_, {});
+                    }
+                }
+                if (producer) conn_.loop->post(&conn_, producer);
+                if (!receiver(chunk.data(), chunk.size())) return false;
+            }
+        }
+
+        /// Consumer: the handler has returned; wake the producer so it stops
+        void close_consumer()
+        {
+            std::coroutine_handle<> producer;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                consumer_gone_ = true;
+                producer = std::exchange(producer_, {});
+            }
+            if (producer) conn_.loop->post(&conn_, producer);
+        }
+
+        std::uint64_t consumed() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return consumed_;
+        }
+
+    private:
+        bool has_space()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return buffered_ < kPipeCapacity || consumer_gone_;
+        }
+
+        bool wait_for_space(std::coroutine_handle<> handle)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (buffered_ < kPipeCapacity || consumer_gone_) return false;
+            producer_ = handle;
+            return true;
+        }
+
+        Connection& conn_;
+        mutable std::mutex mutex_;
+        std::condition_variable cv_;
+        std::deque<std::string> chunks_;
+        std::size_t buffered_ = 0;
+        std::uint64_t consumed_ = 0;
+        bool finished_ = false;
+        bool complete_ = false;
+        bool consumer_gone_ = false;
+        std::coroutine_handle<> producer_;
+    };
+
+    // ─── Parsing ───
+
+    static bool iequals(std::string_view a, std::string_view b)
+    {
+        return a.size() == b.size() &&
+               std::equal(a.begin(), a.end(), b.begin(), [](char x, char y)
+               {
+                   return std::tolower(static_cast<unsigned char>(x)) ==
+                          std::tolower(static_cast<unsigned char>(y));
+               });
+    }
+
+    static std::string_view trim(std::string_view s)
+    {
+        while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+        while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+        return s;
+    }
+
+    /// Request line and headers, without the blank line that ends them
+    static bool parse_head(std::string_view head, httplib::Request& req)
+    {
+        std::size_t eol = head.find("\r\n");
+        std::string_view line = head.substr(0, eol);
+        std::size_t sp1 = line.find(' ');
+        std::size_t sp2 = line.rfind(' ');
+        if (sp1 == std::string_view::npos || sp2 == sp1) return false;
+
+        req.method = line.substr(0, sp1);
+        req.target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+        req.version = line.substr(sp2 + 1);
+        if (req.version != "HTTP/1.1" && req.version != "HTTP/1.0") return false;
+        if (req.target.empty() || req.target.front() != '/') return false;
+
+        std::size_t query = req.target.find('?');
+        req.path = httplib::detail::decode_url(req.target.substr(0, query), false);
+        if (query != std::string::npos)
+        {
+            httplib::detail::parse_query_text(req.target.substr(query + 1), req.params);
+        }
+
+        std::size_t pos = eol == std::string_view::npos ? head.size() : eol + 2;
+        while (pos < head.size())
+        {
+            std::size_t end = head.find("\r\n", pos);
+            if (end == std::string_view::npos) end = head.size();
+            line = head.substr(pos, end - pos);
+            pos = end + 2;
+
+            // SECURITY: No whitespace in a field name, before the colon
+            // (RFC 9112 §5.1) or as obs-fold, which proxies read differently
+            std::size_t colon = line.find(':');
+            if (colon == std::string_view::npos || colon == 0) return false;
+            if (line.substr(0, colon).find_first_of(" \t") != std::string_view::npos) return false;
+            req.headers.emplace(std::string(line.substr(0, colon)),
+                                std::string(trim(line.substr(colon + 1))));
+        }
+        return true;
+    }
+
+    static bool wants_keep_alive(const httplib::Request& req)
+    {
+        std::string connection = req.get_header_value("Connection");
+        if (req.version == "HTTP/1.0") return iequals(connection, "keep-alive");
+        return !iequals(connection, "close");
+    }
+
+    /// How the request body is delimited, and where the reader has got to
+    struct BodyState
+    {
+        bool chunked = false;
+        std::uint64_t remaining = 0;     // left in the body, or in the current chunk
+        bool chunk_crlf = false;         // CRLF after a chunk's data not yet read
+        bool trailers = false;           // past the last chunk
+        bool done = true;
+    };
+
+    /// SECURITY: Framing that another hop could read differently is refused
+    /// (RFC 9112 §6.1, §6.3): Transfer-Encoding together with Content-Length,
+    /// more than one Transfer-Encoding, or Content-Lengths that disagree
+    static bool body_framing(const httplib::Request& req, BodyState& body)
+    {
+        const bool has_length = req.has_header("Content-Length");
+        if (req.has_header("Transfer-Encoding"))
+        {
+            if (has_length || req.get_header_value_count("Transfer-Encoding") > 1) return false;
+            if (!iequals(req.get_header_value("Transfer-Encoding"), "chunked")) return false;
+            body.chunked = true;
+            body.done = false;
+            return true;
+        }
+
+        if (!has_length) return true;
+        std::string length = req.get_header_value("Content-Length");
+        auto lengths = req.headers.equal_range("Content-Length");
+        for (auto it = lengths.first; it != lengths.second; ++it)
+        {
+            if (it->second != length) return false;
+        }
+        if (length.empty() || length.size() > 18) return false;
+        std::uint64_t n = 0;
+        for (char ch : length)
+        {
+            if (ch < '0' || ch > '9') return false;
+            n = n * 10 + static_cast<std::uint64_t>(ch - '0');
+        }
+        body.remaining = n;
+        body.done = n == 0;
+        return true;
+    }
+
+    static bool parse_chunk_size(std::string_view line, std::uint64_t& size)
+    {
+        line = trim(line.substr(0, line.find(';')));
+        if (line.empty() || line.size() > 15) return false;
+        size = 0;
+        for (char ch : line)
+        {
+            int digit = ch >= '0' && ch <= '9' ? ch - '0'
+                      : ch >= 'a' && ch <= 'f' ? ch - 'a' + 10
+                      : ch >= 'A' && ch <= 'F' ? ch - 'A' + 10
+                      : -1;
+            if (digit < 0) return false;
+            size = size * 16 + static_cast<std::uint64_t>(digit);
+        }
+        return true;
+    }
+
+    static bool is_multipart(const httplib::Request& req)
+    {
+        return req.get_header_value("Content-Type").rfind("multipart/form-data", 0) == 0;
+    }
+
+    /// Split a buffered multipart body into req.files, as httplib does
+    static bool parse_multipart(httplib::Request& req)
+    {
+        std::string boundary;
+        if (!httplib::detail::parse_multipart_boundary(req.get_header_value("Content-Type"), boundary))
+        {
+            return false;
+        }
+
+        httplib::detail::MultipartFormDataParser parser;
+        parser.set_boundary(std::move(boundary));
+        auto current = req.files.end();
+        bool ok = parser.parse(req.body.data(), req.body.size(),
+            [&current](const char* data, std::size_t length)
+            {
+                current->second.content.append(data, length);
+                return true;
+            },
+            [&req, &current](const httplib::MultipartFormData& file)
+            {
+                current = req.files.emplace(file.name, file);
+                return true;
+            });
+
+        std::string().swap(req.body);
+        return ok && parser.is_valid();
+    }
+
+    // ─── Socket I/O ───
+
+    /// Read whatever is available into conn.in; false on EOF, error or timeout
+    static Task<bool> fill(Connection& conn, std::chrono::seconds timeout)
+    {
+        if (conn.in_pos == conn.in.size())
+        {
+            conn.in.clear();
+            conn.in_pos = 0;
+        }
+        else if (conn.in_pos >= kReadChunk)
+        {
+            conn.in.erase(0, conn.in_pos);
+            conn.in_pos = 0;
+        }
+
+        for (;;)
+        {
+            std::size_t used = conn.in.size();
+            conn.in.resize(used + kReadChunk);
+            ssize_t n = ::recv(conn.fd, conn.in.data() + used, kReadChunk, 0);
+            int err = errno;
+            conn.in.resize(used + static_cast<std::size_t>(std::max<ssize_t>(n, 0)));
+
+            if (n > 0) co_return true;
+            if (n == 0) co_return false;
+            if (err == EINTR) continue;
+            if (err != EAGAIN && err != EWOULDBLOCK) co_return false;
+
+            // PERF: An idle connection holds no buffer while it waits
+            if (used == 0) std::string().swap(conn.in);
+            conn.readable = false;
+            if (!co_await Readiness{conn, EPOLLIN, timeout}) co_return false;
+        }
+    }
+
+    /// Send all of conn.out
+    static Task<bool> flush(Connection& conn)
+    {
+        const auto timeout = conn.loop->server.options.write_timeout;
+        std::size_t sent = 0;
+        while (sent < conn.out.size())
+        {
+            ssize_t n = ::send(conn.fd, conn.out.data() + sent, conn.out.size() - sent, MSG_NOSIGNAL);
+            if (n > 0)
+            {
+                sent += static_cast<std::size_t>(n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) co_return false;
+
+            conn.writable = false;
+            if (!co_await Readiness{conn, EPOLLOUT, timeout}) co_return false;
+        }
+        conn.out.clear();
+        co_return true;
+    }
+
+    static Task<bool> send_status(Connection& conn, int status)
+    {
+        conn.out += "HTTP/1.1 " + std::to_string(status) + " " + httplib::status_message(status) +
+                    "\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        co_return co_await flush(conn);
+    }
+
+    /// Next run of body bytes, as a view into conn.in that is valid until
+    /// the next call. Empty only once the body is done.
+    static Task<bool> next_piece(Connection& conn, BodyState& body, std::string_view& piece)
+    {
+        const auto timeout = conn.loop->server.options.read_timeout;
+        piece = {};
+        while (!body.done)
+        {
+            if (body.remaining > 0)
+            {
+                if (conn.in_pos == conn.in.size() && !co_await fill(conn, timeout)) co_return false;
+                std::size_t n = static_cast<std::size_t>(
+                    std::min<std::uint64_t>(body.remaining, conn.in.size() - conn.in_pos));
+                piece = std::string_view(conn.in).substr(conn.in_pos, n);
+                conn.in_pos += n;
+                body.remaining -= n;
+                if (body.remaining == 0)
+                {
+                    if (body.chunked) body.chunk_crlf = true;
+                    else body.done = true;
+                }
+                co_return true;
+            }
+
+            // Chunked framing: the CRLF after a chunk, a size line or a trailer
+            std::size_t eol;
+            while ((eol = conn.in.find("\r\n", conn.in_pos)) == std::string::npos)
+            {
+                if (conn.in.size() - conn.in_pos > kMaxChunkLine) co_return false;
+                if (!co_await fill(conn, timeout)) co_return false;
+            }
+            std::string_view line = std::string_view(conn.in).substr(conn.in_pos, eol - conn.in_pos);
+            conn.in_pos = eol + 2;
+
+            if (body.chunk_crlf)
+            {
+                if (!line.empty()) co_return false;
+                body.chunk_crlf = false;
+            }
+            else if (body.trailers)
+            {
+                if (line.empty()) body.done = true;
+            }
+            else
+            {
+                std::uint64_t size;
+                if (!parse_chunk_size(line, size)) co_return false;
+                if (size == 0) body.trailers = true;
+                else body.remaining = size;
+            }
+        }
+        co_return true;
+    }
+
+    // ─── Handlers ───
+
+    /// Run fn on the worker pool and wait for it without blocking the loop
+    static Task<bool> run_job(Connection& conn, std::function<bool()> fn)
+    {
+        Job job(conn);
+        bool result = false;
+        bool queued = conn.loop->server.pool->try_submit([&]
+        {
+            try
+            {
+                result = fn();
+            }
+            catch (const std::exception& e)
+            {
+                logging::error("Server", std::string("Handler failed: ") + e.what());
+            }
+            job.finish();
+        });
+        if (!queued) co_return false;
+        co_await job;
+        co_return result;
+    }
+
+    /// Worker side: pre-routing, then the 404 for a path with no route.
+    /// True if either has answered the request in ex.res.
+    static bool screen(ServerState& server, Exchange& ex, const Route* route)
+    {
+        ex.timing.start = std::chrono::steady_clock::now();
+        ex.screened = true;
+        if (server.pre_routing &&
+            server.pre_routing(ex.req, ex.res) == httplib::Server::HandlerResponse::Handled)
+        {
+            return true;
+        }
+        if (!route)
+        {
+            ex.res.status = 404;
+            return true;
+        }
+        return false;
+    }
+
+    /// Worker side: pre-routing unless already done, then the route
+    static void dispatch(ServerState& server, Exchange& ex, const Route* route,
+                         const httplib::ContentReader* reader)
+    {
+        if (!ex.screened && screen(server, ex, route)) return;
+
+        try
+        {
+            if (reader) route->reader(ex.req, ex.res, *reader);
+            else route->handler(ex.req, ex.res);
+            if (ex.res.status == -1) ex.res.status = 200;
+        }
+        catch (const std::exception& e)
+        {
+            logging::error("Server", ex.req.method + " " + ex.req.path + " threw: " + e.what());
+            ex.res = httplib::Response();
+            ex.res.status = 500;
+        }
+    }
+
+    /// Read the whole body, then run the handler on the pool
+    static Task<Outcome> buffered_exchange(Connection& conn, Exchange& ex, BodyState& body,
+                                           const Route* route)
+    {
+        ServerState& server = conn.loop->server;
+        const std::size_t max_payload = server.options.payload_max_length;
+
+        std::string_view piece;
+        while (!body.done)
+        {
+            if (!co_await next_piece(conn, body, piece)) co_return Outcome::Close;
+            if (max_payload && ex.req.body.size() + piece.size() > max_payload)
+            {
+                ex.res.status = 413;
+                co_return Outcome::RespondAndClose;
+            }
+            ex.req.body.append(piece);
+        }
+
+        bool ran = co_await run_job(conn, [&]
+        {
+            if (is_multipart(ex.req) && !parse_multipart(ex.req))
+            {
+                ex.res.status = 400;
+                return true;
+            }
+            dispatch(server, ex, route, nullptr);
+            return true;
+        });
+        co_return ran ? Outcome::Respond : Outcome::Close;
+    }
+
+    /// Start the handler on the pool, then feed it the body through a pipe
+    /// as it arrives
+    static Task<Outcome> streamed_exchange(Connection& conn, Exchange& ex, BodyState& body,
+                                           const Route& route)
+    {
+        ServerState& server = conn.loop->server;
+        const std::size_t max_payload = server.options.payload_max_length;
+
+        auto pipe = std::make_unique<BodyPipe>(conn);
+        Job job(conn);
+        bool queued = server.pool->try_submit([&]
+        {
+            httplib::ContentReader reader(
+                [&pipe](httplib::ContentReceiver receiver)
+                {
+                    return pipe->read(receiver);
+                },
+                [&pipe, &ex](httplib::MultipartContentHeader header, httplib::ContentReceiver receiver)
+                {
+                    std::string boundary;
+                    if (!httplib::detail::parse_multipart_boundary(ex.req.get_header_value("Content-Type"),
+                                                                   boundary))
+                    {
+                        return false;
+                    }
+                    httplib::detail::MultipartFormDataParser parser;
+                    parser.set_boundary(std::move(boundary));
+                    return pipe->read([&](const char* data, std::size_t length)
+                    {
+                        return parser.parse(data, length, receiver, header);
+                    }) && parser.is_valid();
+                });
+            dispatch(server, ex, &route, &reader);
+            pipe->close_consumer();
+            job.finish();
+        });
+        if (!queued) co_return Outcome::Close;
+        conn.pipe = pipe.get();
+
+        bool socket_ok = true;
+        bool complete = true;
+        bool too_large = false;
+        std::uint64_t received = 0;
+        std::string_view piece;
+        // The handler references this frame, so nothing may leave it before
+        // the job below has finished
+        try
+        {
+            while (!body.done)
+            {
+                if (!co_await next_piece(conn, body, piece))
+                {
+                    socket_ok = false;
+                    break;
+                }
+                if (piece.empty()) break;
+
+                received += piece.size();
+                if (max_payload && received > max_payload)
+                {
+                    complete = false;
+                    too_large = true;
+                    break;
+                }
+                co_await pipe->space();
+                // The handler returned without reading everything
+                if (!pipe->push(piece))
+                {
+                    complete = false;
+                    break;
+                }
+            }
+        }
+        catch (const std::exception&)
+        {
+            socket_ok = false;
+        }
+        pipe->finish(socket_ok && complete);
+
+        co_await job;
+        conn.pipe = nullptr;
+        ex.timing.streamed_in = pipe->consumed();
+
+        if (!socket_ok) co_return Outcome::Close;
+        if (too_large)
+        {
+            ex.res = httplib::Response();
+            ex.res.status = 413;
+        }
+        co_return complete && body.done ? Outcome::Respond : Outcome::RespondAndClose;
+    }
+
+    // ─── Responses ───
+
+    /// Run a content provider on the pool, one batch per drain of the socket
+    static Task<bool> produce(Connection& conn, httplib::Response& res, bool chunked)
+    {
+        const std::size_t length = res.content_length_;
+        std::size_t offset = 0;
+        bool done = false;
+
+        httplib::DataSink sink;
+        sink.write = [&](const char* data, std::size_t n)
+        {
+            if (chunked)
+            {
+                if (n == 0) return true;
+                char size[20];
+                std::snprintf(size, sizeof(size), "%zx\r\n", n);
+                conn.out += size;
+                conn.out.append(data, n);
+                conn.out += "\r\n";
+            }
+            else
+            {
+                conn.out.append(data, n);
+            }
+            offset += n;
+            return true;
+        };
+        sink.is_writable = [] { return true; };
+        sink.done = [&done] { done = true; };
+        sink.done_with_trailer = [&done](const httplib::Headers&) { done = true; };
+
+        while (!done)
+        {
+            bool produced = co_await run_job(conn, [&]
+            {
+                while (!done && conn.out.size() < kWriteBatch)
+                {
+                    if (!chunked && offset >= length)
+                    {
+                        done = true;
+                        break;
+                    }
+                    if (!res.content_provider_(offset, chunked ? 0 : length - offset, sink)) return false;
+                }
+                return true;
+            });
+            if (!produced) co_return false;
+            if (!co_await flush(conn)) co_return false;
+        }
+
+        if (chunked)
+        {
+            conn.out += "0\r\n\r\n";
+            co_return co_await flush(conn);
+        }
+        co_return true;
+    }
+
+    static Task<bool> write_response(Connection& conn, httplib::Response& res, bool keep_alive)
+    {
+        const bool provider = static_cast<bool>(res.content_provider_);
+        // A provider without a length is framed as chunked too
+        const bool chunked = provider && (res.is_chunked_content_provider_ || res.content_length_ == 0);
+
+        std::string& out = conn.out;
+        out += "HTTP/1.1 ";
+        out += std::to_string(res.status);
+        out += ' ';
+        out += httplib::status_message(res.status);
+        out += "\r\n";
+        for (const auto& [name, value] : res.headers)
+        {
+            out += name;
+            out += ": ";
+            out += value;
+            out += "\r\n";
+        }
+        if (chunked)
+        {
+            out += "Transfer-Encoding: chunked\r\n";
+        }
+        else
+        {
+            out += "Content-Length: ";
+            out += std::to_string(provider ? res.content_length_ : res.body.size());
+            out += "\r\n";
+        }
+        out += keep_alive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+
+        if (!provider)
+        {
+            out += res.body;
+            co_return co_await flush(conn);
+        }
+
+        // ~Response() hands this to the resource releaser
+        res.content_provider_success_ = co_await produce(conn, res, chunked);
+        co_return res.content_provider_success_;
+    }
+
+    // ─── Connection ───
+
+    static ConnectionTask serve(Connection& conn)
+    {
+        ServerState& server = conn.loop->server;
+        const auto& options = server.options;
+
+        try
+        {
+            for (std::size_t served = 0;; ++served)
+            {
+                if (conn.out.capacity() > kIdleBufferBytes) std::string().swap(conn.out);
+
+                std::size_t head_end;
+                while ((head_end = conn.in.find("\r\n\r\n", conn.in_pos)) == std::string::npos)
+                {
+                    if (conn.in.size() - conn.in_pos > kMaxHeadBytes)
+                    {
+                        co_await send_status(conn, 431);
+                        co_return;
+                    }
+                    bool idle = conn.in_pos == conn.in.size();
+                    if (!co_await fill(conn, idle ? options.keep_alive_timeout : options.read_timeout))
+                    {
+                        co_return;
+                    }
+                }
+
+                auto ex = std::make_unique<Exchange>();
+                bool parsed = parse_head(std::string_view(conn.in).substr(conn.in_pos, head_end - conn.in_pos),
+                                         ex->req);
+                conn.in_pos = head_end + 4;
+
+                BodyState body;
+                if (!parsed || !body_framing(ex->req, body))
+                {
+                    co_await send_status(conn, 400);
+                    co_return;
+                }
+                if (!body.chunked && options.payload_max_length && body.remaining > options.payload_max_length)
+                {
+                    co_await send_status(conn, 413);
+                    co_return;
+                }
+
+                ex->req.remote_addr = conn.remote_addr;
+                ex->req.remote_port = conn.remote_port;
+                bool keep_alive = wants_keep_alive(ex->req) && !server.stopping.load() &&
+                                  (options.keep_alive_max_count == 0 || served + 1 < options.keep_alive_max_count);
+
+                const Route* route = server.find(ex->req.method, ex->req.path);
+
+                // SECURITY: A request that pre-routing turns away (rate limited,
+                // say) or that has no route is answered before its body is read,
+                // and the connection closed rather than spent draining it
+                if (!body.done)
+                {
+                    bool handled = false;
+                    if (!co_await run_job(conn, [&]
+                    {
+                        handled = screen(server, *ex, route);
+                        return true;
+                    }))
+                    {
+                        co_return;
+                    }
+                    if (handled)
+                    {
+                        co_await write_response(conn, ex->res, false);
+                        if (server.logger)
+                        {
+                            server.logger(ex->req, ex->res, ex->timing);
+                        }
+                        co_return;
+                    }
+
+                    if (iequals(ex->req.get_header_value("Expect"), "100-continue"))
+                    {
+                        conn.out += "HTTP/1.1 100 Continue\r\n\r\n";
+                        if (!co_await flush(conn)) co_return;
+                    }
+                }
+
+                Outcome outcome;
+                if (route && route->reader)
+                {
+                    outcome = co_await streamed_exchange(conn, *ex, body, *route);
+                }
+                else
+                {
+                    outcome = co_await buffered_exchange(conn, *ex, body, route);
+                }
+                if (outcome == Outcome::Close) co_return;
+                if (outcome == Outcome::RespondAndClose) keep_alive = false;
+
+                bool written = co_await write_response(conn, ex->res, keep_alive);
+                if (server.logger)
+                {
+                    server.logger(ex->req, ex->res, ex->timing);
+                }
+                if (!written || !keep_alive) co_return;
+            }
+        }
+        catch (const std::exception& e)
+        {
+            logging::warn("Server", std::string("Connection from ") + conn.remote_addr + " failed: " + e.what());
+        }
+    }
+
+    // ─── Event Loop ───
+
+    Loop::~Loop()
+    {
+        for (auto& [ptr, conn] : connections)
+        {
+            ::close(conn->fd);
+        }
+        if (listen_fd >= 0) ::close(listen_fd);
+        if (wake_fd >= 0) ::close(wake_fd);
+        if (epoll_fd >= 0) ::close(epoll_fd);
+    }
+
+    void Loop::post(Connection* conn, std::coroutine_handle<> handle)
+    {
+        {
+            std::lock_guard<std::mutex> lock(ready_mutex);
+            ready.emplace_back(conn, handle);
+        }
+        wake();
+    }
+
+    void Loop::wake()
+    {
+        // write() on an eventfd is async-signal-safe
+        std::uint64_t one = 1;
+        ssize_t n = ::write(wake_fd, &one, sizeof(one));
+        (void)n;
+    }
+
+    void Loop::run()
+    {
+        epoll_event events[kMaxEvents];
+        auto last_sweep = std::chrono::steady_clock::now();
+
+        while (!server.stopping.load())
+        {
+            int n = ::epoll_wait(epoll_fd, events, kMaxEvents, 1000);
+            if (n < 0 && errno != EINTR)
+            {
+                logging::error("Server", std::string("epoll_wait failed: ") + std::strerror(errno));
+                return;
+            }
+
+            for (int i = 0; i < n; ++i)
+            {
+                void* tag = events[i].data.ptr;
+                if (tag == &listen_fd)
+                {
+                    accept_all();
+                    continue;
+                }
+                if (tag == &wake_fd)
+                {
+                    std::uint64_t count;
+                    ssize_t r = ::read(wake_fd, &count, sizeof(count));
+                    (void)r;
+                    continue;
+                }
+
+                // An earlier event in this batch may have closed it
+                auto* conn = static_cast<Connection*>(tag);
+                if (!connections.count(conn)) continue;
+
+                std::uint32_t ev = events[i].events;
+                if (ev & (EPOLLIN | EPOLLRDHUP)) conn->readable = true;
+                if (ev & EPOLLOUT) conn->writable = true;
+                if (ev & (EPOLLHUP | EPOLLERR)) conn->hangup = true;
+                if (conn->waiter && conn->ready(conn->waiting_for))
+                {
+                    resume(*conn, conn->waiter);
+                }
+            }
+
+            run_ready();
+
+            auto now = std::chrono::steady_clock::now();
+            if (now - last_sweep >= std::chrono::seconds(1))
+            {
+                last_sweep = now;
+                expire_timeouts();
+            }
+        }
+    }
+
+    void Loop::accept_all()
+    {
+        for (;;)
+        {
+            sockaddr_storage addr{};
+            socklen_t addr_len = sizeof(addr);
+            int fd = ::accept4(listen_fd, reinterpret_cast<sockaddr*>(&addr), &addr_len,
+                               SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0)
+            {
+                if (errno == EINTR) continue;
+                if (errno == EMFILE || errno == ENFILE)
+                {
+                    static logging::RateLimit limit(std::chrono::milliseconds(1000));
+                    logging::log(limit, logging::Level::Warn, "Server",
+                                 "Out of file descriptors; connections are waiting in the backlog");
+                }
+                return;
+            }
+
+            if (server.options.tcp_nodelay)
+            {
+                int on = 1;
+                ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+            }
+
+            auto owned = std::make_unique<Connection>();
+            Connection& conn = *owned;
+            conn.loop = this;
+            conn.fd = fd;
+            char host[NI_MAXHOST];
+            char service[NI_MAXSERV];
+            if (::getnameinfo(reinterpret_cast<sockaddr*>(&addr), addr_len, host, sizeof(host),
+                              service, sizeof(service), NI_NUMERICHOST | NI_NUMERICSERV) == 0)
+            {
+                conn.remote_addr = host;
+                conn.remote_port = std::atoi(service);
+            }
+
+            epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+            ev.data.ptr = &conn;
+            if (::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0)
+            {
+                ::close(fd);
+                continue;
+            }
+
+            server.open.fetch_add(1, std::memory_order_relaxed);
+            connections.emplace(&conn, std::move(owned));
+            conn.task = serve(conn);
+            resume(conn, conn.task.handle);
+        }
+    }
+
+    void Loop::run_ready()
+    {
+        std::vector<std::pair<Connection*, std::coroutine_handle<>>> batch;
+        {
+            std::lock_guard<std::mutex> lock(ready_mutex);
+            batch.swap(ready);
+        }
+        for (auto& [conn, handle] : batch)
+        {
+            if (connections.count(conn)) resume(*conn, handle);
+        }
+    }
+
+    void Loop::expire_timeouts()
+    {
+        auto now = std::chrono::steady_clock::now();
+        std::vector<Connection*> expired;
+        for (auto& [ptr, conn] : connections)
+        {
+            if (conn->waiter && conn->deadline <= now) expired.push_back(ptr);
+        }
+        for (Connection* conn : expired)
+        {
+            if (!connections.count(conn) || !conn->waiter) continue;
+            conn->timed_out = true;
+            resume(*conn, conn->waiter);
+        }
+    }
+
+    void Loop::resume(Connection& conn, std::coroutine_handle<> handle)
+    {
+        handle.resume();
+        if (conn.task.done()) close(conn);
+    }
+
+    void Loop::close(Connection& conn)
+    {
+        ::close(conn.fd);
+        server.open.fetch_sub(1, std::memory_order_relaxed);
+        connections.erase(&conn);
+    }
+
+    // ─── Setup ───
+
+    static int listen_socket(const std::string& host, int port, bool reuse_port)
+    {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_PASSIVE;
+        addrinfo* result = nullptr;
+        std::string service = std::to_string(port);
+        if (::getaddrinfo(host.empty() ? nullptr : host.c_str(), service.c_str(), &hints, &result) != 0)
+        {
+            return -1;
+        }
+
+        int fd = -1;
+        for (addrinfo* ai = result; ai; ai = ai->ai_next)
+        {
+            fd = ::socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, ai->ai_protocol);
+            if (fd < 0) continue;
+            int on = 1;
+            ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+            if (reuse_port) ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+            if (::bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 && ::listen(fd, SOMAXCONN) == 0) break;
+            ::close(fd);
+            fd = -1;
+        }
+        ::freeaddrinfo(result);
+        return fd;
+    }
+
+    static int bound_port(int fd)
+    {
+        sockaddr_storage addr{};
+        socklen_t len = sizeof(addr);
+        if (::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) return -1;
+        if (addr.ss_family == AF_INET6) return ntohs(reinterpret_cast<sockaddr_in6*>(&addr)->sin6_port);
+        return ntohs(reinterpret_cast<sockaddr_in*>(&addr)->sin_port);
+    }
+
+    /// Every connection is a descriptor; the default soft limit (often 1024)
+    /// would cap the server long before memory does
+    static void raise_fd_limit()
+    {
+        rlimit limit{};
+        if (::getrlimit(RLIMIT_NOFILE, &limit) != 0 || limit.rlim_cur >= limit.rlim_max) return;
+        limit.rlim_cur = limit.rlim_max;
+        if (::setrlimit(RLIMIT_NOFILE, &limit) == 0)
+        {
+            logging::info("Server", "Open file limit raised to " + std::to_string(limit.rlim_cur));
+        }
+    }
+
+    struct EventServer::Impl
+    {
+        ServerState state;
+    };
+
+    EventServer::EventServer(Options options)
+        : impl_(std::make_unique<Impl>())
+    {
+        if (options.loops == 0) options.loops = 1;
+        if (options.workers == 0) options.workers = 1;
+        impl_->state.options = options;
+        impl_->state.pool = std::make_unique<utils::ThreadPool>(options.workers);
+        raise_fd_limit();
+    }
+
+    EventServer::~EventServer()
+    {
+        impl_->state.pool->shutdown();
+    }
+
+    void EventServer::get(const std::string& path, Handler handler)
+    {
+        impl_->state.routes["GET " + path].handler = std::move(handler);
+    }
+
+    void EventServer::post(const std::string& path, Handler handler)
+    {
+        impl_->state.routes["POST " + path].handler = std::move(handler);
+    }
+
+    void EventServer::put(const std::string& path, HandlerWithContentReader handler)
+    {
+        impl_->state.routes["PUT " + path].reader = std::move(handler);
+    }
+
+    void EventServer::set_pre_routing_handler(PreRoutingHandler handler)
+    {
+        impl_->state.pre_routing = std::move(handler);
+    }
+
+    void EventServer::set_logger(Logger logger)
+    {
+        impl_->state.logger = std::move(logger);
+    }
+
+    bool EventServer::bind(const std::string& host, int port)
+    {
+        ServerState& state = impl_->state;
+        const bool reuse_port = state.options.loops > 1;
+
+        std::vector<std::unique_ptr<Loop>> loops;
+        int bound = port;
+        for (std::size_t i = 0; i < state.options.loops; ++i)
+        {
+            auto loop = std::make_unique<Loop>(state);
+            // Later sockets join whatever port the first one got
+            loop->listen_fd = listen_socket(host, bound, reuse_port);
+            if (loop->listen_fd < 0) return false;
+            if (i == 0) bound = bound_port(loop->listen_fd);
+
+            loop->epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+            loop->wake_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (loop->epoll_fd < 0 || loop->wake_fd < 0) return false;
+
+            epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLET;
+            ev.data.ptr = &loop->listen_fd;
+            ::epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->listen_fd, &ev);
+            ev.events = EPOLLIN;
+            ev.data.ptr = &loop->wake_fd;
+            ::epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->wake_fd, &ev);
+
+            loops.push_back(std::move(loop));
+        }
+
+        state.loops = std::move(loops);
+        state.port = bound;
+        return true;
+    }
+
+    int EventServer::port() const
+    {
+        return impl_->state.port;
+    }
+
+    void EventServer::run()
+    {
+        ServerState& state = impl_->state;
+        if (state.loops.empty())
+        {
+            throw std::runtime_error("EventServer::run() called before bind()");
+        }
+
+        std::vector<std::thread> threads;
+        for (std::size_t i = 1; i < state.loops.size(); ++i)
+        {
+            threads.emplace_back([loop = state.loops[i].get(), this]
+            {
+                loop->run();
+                stop();
+            });
+        }
+        state.loops[0]->run();
+        stop();
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+
+        // Loops are idle now. Let in-flight handlers finish, releasing any
+        // that wait on a request body, before their connections go away.
+        for (auto& loop : state.loops)
+        {
+            for (auto& [ptr, conn] : loop->connections)
+            {
+                if (conn->pipe) conn->pipe->finish(false);
+            }
+        }
+        state.pool->shutdown();
+        for (auto& loop : state.loops)
+        {
+            for (auto& [ptr, conn] : loop->connections)
+            {
+                ::close(conn->fd);
+            }
+            state.open.fetch_sub(loop->connections.size(), std::memory_order_relaxed);
+            loop->connections.clear();
+        }
+    }
+
+    void EventServer::stop()
+    {
+        ServerState& state = impl_->state;
+        state.stopping.store(true);
+        for (auto& loop : state.loops)
+        {
+            loop->wake();
+        }
+    }
+
+    std::size_t EventServer::open_connections() const
+    {
+        return impl_->state.open.load(std::memory_order_relaxed);
+    }
+
+#else
+
+    struct EventServer::Impl
+    {
+    };
+
+    EventServer::EventServer(Options)
+    {
+        throw std::runtime_error("The event server core requires Linux (epoll)");
+    }
+
+    EventServer::~EventServer() = default;
+    void EventServer::get(const std::string&, Handler) {}
+    void EventServer::post(const std::string&, Handler) {}
+    void EventServer::put(const std::string&, HandlerWithContentReader) {}
+    void EventServer::set_pre_routing_handler(PreRoutingHandler) {}
+    void EventServer::set_logger(Logger) {}
+    bool EventServer::bind(const std::string&, int) { return false; }
+    int EventServer::port() const { return -1; }
+    void EventServer::run() {}
+    void EventServer::stop() {}
+    std::size_t EventServer::open_connections() const { return 0; }
+
+#endif
+
+} // namespace vault::server
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "core/route_registrar.h"
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace vault::server
+{
+
+    /// Event-driven HTTP/1.1 server for many mostly idle connections.
+    ///
+    /// Each event loop thread owns an epoll set and its own listening socket
+    /// bound with SO_REUSEPORT. A connection is a C++20 coroutine on its
+    /// loop, so an idle keep-alive connection costs a socket and a small
+    /// frame rather than a thread. Handlers may block (password hashing,
+    /// disk I/O), so they run on a fixed worker pool and the coroutine
+    /// resumes on its loop when they finish. Content providers fill the
+    /// socket buffer in bounded batches, one batch per drain, so a slow
+    /// reader pins at most one batch of memory.
+    ///
+    /// Linux only; elsewhere the constructor throws.
+    class EventServer : public RouteRegistrar
+    {
+    public:
+        struct Options
+        {
+            std::size_t loops = 1;                          // event loop threads, one listening socket each
+            std::size_t workers = 8;                        // handler threads
+            std::size_t payload_max_length = 0;             // bytes, 0 = unlimited
+            std::size_t keep_alive_max_count = 0;           // requests per connection, 0 = unlimited
+            std::chrono::seconds keep_alive_timeout{5};     // idle time allowed between requests
+            std::chrono::seconds read_timeout{5};
+            std::chrono::seconds write_timeout{5};
+            bool tcp_nodelay = true;
+        };
+
+        explicit EventServer(Options options);
+        ~EventServer() override;
+
+        EventServer(const EventServer&) = delete;
+        EventServer& operator=(const EventServer&) = delete;
+
+        void get(const std::string& path, Handler handler) override;
+        void post(const std::string& path, Handler handler) override;
+        void put(const std::string& path, HandlerWithContentReader handler) override;
+        void set_pre_routing_handler(PreRoutingHandler handler) override;
+        void set_logger(Logger logger) override;
+
+        /// Open one listening socket per loop. Port 0 picks a free port.
+        bool bind(const std::string& host, int port);
+
+        /// Port actually bound, once bind() has succeeded
+        int port() const;
+
+        /// Serve until stop(). The calling thread runs the first loop.
+        void run();
+
+        /// Async-signal-safe: sets a flag and wakes the loops
+        void stop();
+
+        std::size_t open_connections() const;
+
+    private:
+        struct Impl;
+        std::unique_ptr<Impl> impl_;
+    };
+
+} // namespace vault::server
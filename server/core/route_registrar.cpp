@@ -0,0 +1,81 @@
+#include "core/route_registrar.h"
+
+namespace vault::server
+{
+
+    // httplib runs the pre-routing handler, the route and the logger for a
+    // request on the same worker thread, so per-request state can live here.
+    static thread_local std::chrono::steady_clock::time_point t_request_start;
+    static thread_local std::uint64_t t_streamed_in = 0;
+
+    HttplibRegistrar::HttplibRegistrar(httplib::Server& server)
+        : server_(server), hooks_(std::make_shared<Hooks>())
+    {
+        server_.set_pre_routing_handler([hooks = hooks_](const httplib::Request& req, httplib::Response& res)
+        {
+            t_request_start = std::chrono::steady_clock::now();
+            t_streamed_in = 0;
+            return hooks->pre_routing ? hooks->pre_routing(req, res)
+                                      : httplib::Server::HandlerResponse::Unhandled;
+        });
+
+        server_.set_logger([hooks = hooks_](const httplib::Request& req, const httplib::Response& res)
+        {
+            // Cleared so a request that never reached routing (e.g. a parse
+            // error) doesn't inherit the previous request's start time
+            RequestTiming timing{t_request_start, t_streamed_in};
+            t_request_start = {};
+            t_streamed_in = 0;
+            if (hooks->logger) hooks->logger(req, res, timing);
+        });
+    }
+
+    void HttplibRegistrar::get(const std::string& path, Handler handler)
+    {
+        server_.Get(path, std::move(handler));
+    }
+
+    void HttplibRegistrar::post(const std::string& path, Handler handler)
+    {
+        server_.Post(path, std::move(handler));
+    }
+
+    void HttplibRegistrar::put(const std::string& path, HandlerWithContentReader handler)
+    {
+        // Count what the handler reads; a chunked body has no Content-Length
+        server_.Put(path, [handler = std::move(handler)](const httplib::Request& req,
+                                                         httplib::Response& res,
+                                                         const httplib::ContentReader& content_reader)
+        {
+            httplib::ContentReader counted(
+                [&content_reader](httplib::ContentReceiver receiver)
+                {
+                    return content_reader([&receiver](const char* data, size_t length)
+                    {
+                        t_streamed_in += length;
+                        return receiver(data, length);
+                    });
+                },
+                [&content_reader](httplib::MultipartContentHeader header, httplib::ContentReceiver receiver)
+                {
+                    return content_reader(std::move(header), [&receiver](const char* data, size_t length)
+                    {
+                        t_streamed_in += length;
+                        return receiver(data, length);
+                    });
+                });
+            handler(req, res, counted);
+        });
+    }
+
+    void HttplibRegistrar::set_pre_routing_handler(PreRoutingHandler handler)
+    {
+        hooks_->pre_routing = std::move(handler);
+    }
+
+    void HttplibRegistrar::set_logger(Logger logger)
+    {
+        hooks_->logger = std::move(logger);
+    }
+
+} // namespace vault::server
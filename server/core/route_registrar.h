@@ -0,0 +1,74 @@
+#pragma once
+
+#include <httplib.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace vault::server
+{
+
+    /// What the server core knows about a request beyond the Request itself
+    struct RequestTiming
+    {
+        std::chrono::steady_clock::time_point start;   // routing began; zero if it never did
+        std::uint64_t streamed_in = 0;                 // body bytes pulled through a ContentReader
+    };
+
+    /// Where setup_routes() registers its handlers. Handlers keep httplib's
+    /// Request/Response types whichever core serves them, so the route table
+    /// is written once and runs on either the thread-per-connection httplib
+    /// server or the event-driven EventServer.
+    class RouteRegistrar
+    {
+    public:
+        using Handler = httplib::Server::Handler;
+        using HandlerWithContentReader = httplib::Server::HandlerWithContentReader;
+        using PreRoutingHandler = httplib::Server::HandlerWithResponse;
+        using Logger = std::function<void(const httplib::Request&, const httplib::Response&,
+                                          const RequestTiming&)>;
+
+        virtual ~RouteRegistrar() = default;
+
+        /// Register a handler for an exact path
+        virtual void get(const std::string& path, Handler handler) = 0;
+        virtual void post(const std::string& path, Handler handler) = 0;
+
+        /// The handler pulls the body itself, so it can be streamed to disk
+        virtual void put(const std::string& path, HandlerWithContentReader handler) = 0;
+
+        /// Runs before routing; returning Handled skips the route
+        virtual void set_pre_routing_handler(PreRoutingHandler handler) = 0;
+
+        /// Runs once the response has been written
+        virtual void set_logger(Logger logger) = 0;
+    };
+
+    /// RouteRegistrar for httplib::Server. Registration only: the server
+    /// keeps everything it needs, so this can be a temporary.
+    class HttplibRegistrar : public RouteRegistrar
+    {
+    public:
+        explicit HttplibRegistrar(httplib::Server& server);
+
+        void get(const std::string& path, Handler handler) override;
+        void post(const std::string& path, Handler handler) override;
+        void put(const std::string& path, HandlerWithContentReader handler) override;
+        void set_pre_routing_handler(PreRoutingHandler handler) override;
+        void set_logger(Logger logger) override;
+
+    private:
+        struct Hooks
+        {
+            PreRoutingHandler pre_routing;
+            Logger logger;
+        };
+
+        httplib::Server& server_;
+        std::shared_ptr<Hooks> hooks_;
+    };
+
+} // namespace vault::server
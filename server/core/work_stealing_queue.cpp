@@ -0,0 +1,125 @@
+#include "core/work_stealing_queue.h"
+
+#include <thread>
+
+namespace vault::server
+{
+
+    WorkStealingQueue::WorkStealingQueue(std::size_t threads, std::size_t max_queued)
+        : max_queued_(max_queued)
+    {
+        if (threads == 0) threads = 1;
+
+        lanes_.reserve(threads);
+        for (std::size_t i = 0; i < threads; ++i)
+        {
+            lanes_.push_back(std::make_unique<Lane>());
+        }
+
+        threads_.reserve(threads);
+        for (std::size_t i = 0; i < threads; ++i)
+        {
+            threads_.emplace_back([this, i] { worker_loop(i); });
+        }
+    }
+
+    WorkStealingQueue::~WorkStealingQueue()
+    {
+        shutdown();
+    }
+
+    bool WorkStealingQueue::enqueue(std::function<void()> fn)
+    {
+        if (stopping_.load(std::memory_order_relaxed)) return false;
+
+        // Admission control: httplib closes the connection when we refuse it
+        if (max_queued_ != 0 &&
+            queued_.load(std::memory_order_relaxed) >= static_cast<std::ptrdiff_t>(max_queued_))
+        {
+            return false;
+        }
+
+        auto index = next_lane_.fetch_add(1, std::memory_order_relaxed) % lanes_.size();
+        {
+            std::lock_guard<std::mutex> lock(lanes_[index]->mutex);
+            lanes_[index]->tasks.push_back(std::move(fn));
+        }
+
+        // Counted only once it can be popped, so a worker that sees it
+        // always finds it. The epoch bump is what a sleeping worker waits on;
+        // notify_one is a no-op when nobody is waiting.
+        queued_.fetch_add(1, std::memory_order_release);
+        wake_epoch_.fetch_add(1, std::memory_order_release);
+        wake_epoch_.notify_one();
+        return true;
+    }
+
+    void WorkStealingQueue::shutdown()
+    {
+        if (stopping_.exchange(true) && threads_.empty()) return;
+        wake_epoch_.fetch_add(1, std::memory_order_release);
+        wake_epoch_.notify_all();
+
+        for (auto& thread : threads_)
+        {
+            if (thread.joinable()) thread.join();
+        }
+        threads_.clear();
+    }
+
+    bool WorkStealingQueue::try_pop(std::size_t index, std::function<void()>& task)
+    {
+        auto& lane = *lanes_[index];
+        std::lock_guard<std::mutex> lock(lane.mutex);
+        if (lane.tasks.empty()) return false;
+
+        task = std::move(lane.tasks.front());
+        lane.tasks.pop_front();
+        return true;
+    }
+
+    bool WorkStealingQueue::try_steal(std::size_t thief, std::function<void()>& task)
+    {
+        for (std::size_t offset = 1; offset < lanes_.size(); ++offset)
+        {
+            auto& lane = *lanes_[(thief + offset) % lanes_.size()];
+            std::unique_lock<std::mutex> lock(lane.mutex, std::try_to_lock);
+            if (!lock.owns_lock() || lane.tasks.empty()) continue;
+
+            // Steal from the opposite end to the owner to limit contention
+            task = std::move(lane.tasks.back());
+            lane.tasks.pop_back();
+            return true;
+        }
+        return false;
+    }
+
+    void WorkStealingQueue::worker_loop(std::size_t index)
+    {
+        for (;;)
+        {
+            // Read before looking, so an enqueue that lands after the search
+            // has moved the epoch and the wait below returns at once
+            auto epoch = wake_epoch_.load(std::memory_order_acquire);
+
+            std::function<void()> task;
+            if (try_pop(index, task) || try_steal(index, task))
+            {
+                queued_.fetch_sub(1, std::memory_order_relaxed);
+                task();
+                continue;
+            }
+
+            if (queued_.load(std::memory_order_acquire) > 0)
+            {
+                // A try_lock steal skipped a busy lane; look again
+                std::this_thread::yield();
+                continue;
+            }
+            if (stopping_.load()) return;
+
+            wake_epoch_.wait(epoch, std::memory_order_acquire);
+        }
+    }
+
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <httplib.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vault::server
+{
+
+    /// httplib::TaskQueue with one deque per worker.
+    /// New connections are spread round-robin across the deques; a worker
+    /// whose own deque is empty steals from the back of its neighbours'.
+    /// This keeps workers busy when connection lifetimes are uneven. Enqueue
+    /// locks only the lane it pushes to and wakes an idle worker through an
+    /// atomic, so there is no single shared queue lock as in
+    /// httplib::ThreadPool.
+    class WorkStealingQueue : public httplib::TaskQueue
+    {
+    public:
+        /// max_queued = 0 means unbounded
+        WorkStealingQueue(std::size_t threads, std::size_t max_queued = 0);
+        ~WorkStealingQueue() override;
+
+        bool enqueue(std::function<void()> fn) override;
+        void shutdown() override;
+
+    private:
+        struct Lane
+        {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        void worker_loop(std::size_t index);
+        bool try_pop(std::size_t index, std::function<void()>& task);
+        bool try_steal(std::size_t thief, std::function<void()>& task);
+
+        std::vector<std::unique_ptr<Lane>> lanes_;
+        std::vector<std::thread> threads_;
+        std::size_t max_queued_;
+
+        std::atomic<std::size_t> next_lane_{0};
+        // Counted after the push and uncounted after the pop, so a worker
+        // can briefly take it below zero
+        std::atomic<std::ptrdiff_t> queued_{0};
+        std::atomic<bool> stopping_{false};
+
+        // Bumped on every enqueue; idle workers wait for it to move
+        std::atomic<std::uint32_t> wake_epoch_{0};
+    };
+
+}
@@ -1,39 +1,80 @@
 #include "auth/auth_manager.h"
 #include "storage/storage_manager.h"
+#include "storage/scrubber.h"
+#include "replication/change_log.h"
+#include "replication/replica.h"
 #include "routes/routes.h"
+#include "capture/request_capture.h"
+#include "config/server_config.h"
+#include "core/event_server.h"
+#include "logging/logger.h"
 
 #include <httplib.h>
+#include <chrono>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 #include <csignal>
 
-static httplib::Server* g_server = nullptr;
+// One per listener; filled before the signal handlers are installed
+static std::vector<std::unique_ptr<httplib::Server>> g_servers;
+
+// Set instead of g_servers under --core event
+static vault::server::EventServer* g_event_server = nullptr;
 
 static void signal_handler(int) {
-    if (g_server) {
-        std::cout << "\n[Server] Shutting down...\n";
-        g_server->stop();
+    // Only stop() here: logging allocates and is not async-signal-safe
+    for (auto& server : g_servers) {
+        server->stop();
+    }
+    if (g_event_server) {
+        g_event_server->stop();
     }
 }
 
+// ── --core event: one epoll loop per listener, handlers on a shared pool ──
+static int run_event_server(const vault::server::ServerConfig& config,
+                            vault::server::AuthManager& auth,
+                            vault::server::StorageManager& storage,
+                            const vault::server::RouteOptions& route_options) {
+    vault::server::EventServer server(vault::server::event_server_options(config));
+    vault::server::setup_routes(server, auth, storage, route_options);
+    route_options.metrics->add_gauge("vault_open_connections", "Client connections held open by the server",
+                                     [&server] { return static_cast<double>(server.open_connections()); });
+
+    if (!server.bind(config.host, config.port)) {
+        vault::logging::error("Server", "Failed to start on " + config.host + ":" +
+                                        std::to_string(config.port));
+        return 1;
+    }
+
+    g_event_server = &server;
+    std::signal(SIGINT, signal_handler);
+    std::signal(SIGTERM, signal_handler);
+
+    vault::logging::info("Server", "Listening on " + config.host + ":" + std::to_string(config.port));
+    vault::logging::info("Server", std::to_string(config.listeners) + " event loop(s), " +
+                                   std::to_string(config.effective_worker_threads()) + " handler thread(s)");
+    vault::logging::info("Server", "Press Ctrl+C to stop");
+
+    server.run();
+    g_event_server = nullptr;
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
     // ── Parse command line arguments ────────────────────────────────────
-    int port = 8080;
-    std::string host = "0.0.0.0";
-
-    for (int i = 1; i < argc; ++i) {
-        std::string arg = argv[i];
-        if ((arg == "--port" || arg == "-p") && i + 1 < argc) {
-            port = std::stoi(argv[++i]);
-        } else if ((arg == "--host" || arg == "-h") && i + 1 < argc) {
-            host = argv[++i];
-        } else if (arg == "--help") {
-            std::cout << "Usage: vault_server [options]\n"
-                      << "  --port, -p <port>  Server port (default: 8080)\n"
-                      << "  --host, -h <host>  Bind address (default: 0.0.0.0)\n"
-                      << "  --help             Show this help\n";
+    vault::server::ServerConfig config;
+    try {
+        if (!vault::server::parse_command_line(argc, argv, config)) {
             return 0;
         }
+    } catch (const std::exception& e) {
+        std::cerr << "[Server] " << e.what() << "\n"
+                  << "Run with --help for usage\n";
+        return 1;
     }
 
     // ── Print startup banner ────────────────────────────────────────────
@@ -46,29 +87,144 @@ int main(int argc, char* argv[]) {
  ╚══════════════════════════════════════════════════╝
 )" << std::endl;
 
+    // ── Start the asynchronous logger ───────────────────────────────────
+    vault::logging::Options log_options;
+    log_options.min_level = vault::logging::parse_level(config.log_level);
+    log_options.format = config.log_format == "json" ? vault::logging::Format::Json
+                                                     : vault::logging::Format::Text;
+    vault::logging::start(log_options);
+
     // ── Initialize components ───────────────────────────────────────────
-    vault::server::AuthManager auth("data");
-    vault::server::StorageManager storage("storage");
+    vault::server::AuthManager auth(config.data_dir, config.hash_threads, config.hash_queue);
+    std::unique_ptr<vault::server::StorageBackend> backend;
+    try {
+        backend = vault::server::make_storage_backend(config);
+    } catch (const std::exception& e) {
+        vault::logging::error("Server", std::string("Storage unavailable: ") + e.what());
+        vault::logging::stop();
+        return 1;
+    }
+    vault::server::StorageManager storage(std::move(backend), config.store_threads);
+
+    // Re-verifies stored files in the background; stops before storage goes away
+    std::unique_ptr<vault::server::Scrubber> scrubber;
+    if (config.scrub_rate > 0) {
+        vault::server::Scrubber::Options scrub_options;
+        scrub_options.bytes_per_second = static_cast<std::uint64_t>(config.scrub_rate) * 1024 * 1024;
+        scrub_options.interval = std::chrono::seconds(config.scrub_interval);
+        scrubber = std::make_unique<vault::server::Scrubber>(storage, scrub_options);
+    }
+
+    // ── Replication ─────────────────────────────────────────────────────
+    // A primary logs every change for its replicas; a replica applies them.
+    // Both go before the listeners start and after storage is up.
+    std::unique_ptr<vault::server::ChangeLog> change_log;
+    std::unique_ptr<vault::server::Replica> replica;
+    if (!config.replicate_from.empty()) {
+        try {
+            replica = std::make_unique<vault::server::Replica>(auth, storage,
+                                                               vault::server::replica_options(config));
+        } catch (const std::exception& e) {
+            vault::logging::error("Server", e.what());
+            vault::logging::stop();
+            return 1;
+        }
+    } else if (!config.replication_secret.empty()) {
+        change_log = std::make_unique<vault::server::ChangeLog>(config.replication_log);
+        change_log->attach(auth, storage);
+        vault::logging::info("Server", "Serving replicas; keeping the last " +
+                                       std::to_string(config.replication_log) + " change(s)");
+    }
+
+    // ── Setup routes ────────────────────────────────────────────────────
+    vault::server::RateLimiter rate_limiter;
+    vault::server::apply_rate_limits(rate_limiter, config);
 
-    httplib::Server server;
-    g_server = &server;
+    vault::server::Metrics metrics;
+
+    // Outlives listen(); its destructor writes out whatever is still queued
+    std::unique_ptr<vault::server::RequestCapture> capture;
+    if (!config.capture_file.empty()) {
+        try {
+            capture = std::make_unique<vault::server::RequestCapture>(
+                vault::server::RequestCapture::Options{config.capture_file, config.capture_payloads});
+        } catch (const std::exception& e) {
+            vault::logging::error("Server", e.what());
+            vault::logging::stop();
+            return 1;
+        }
+        vault::logging::info("Server", "Capturing requests to " + config.capture_file.string() +
+                                       (config.capture_payloads ? " (with payloads)" : ""));
+    }
+
+    vault::server::RouteOptions route_options;
+    route_options.metrics = &metrics;
+    route_options.capture = capture.get();
+    route_options.scrubber = scrubber.get();
+    route_options.change_log = change_log.get();
+    route_options.replica = replica.get();
+    route_options.replication_secret = config.replication_secret;
+    if (config.rate_limit) {
+        route_options.rate_limiter = &rate_limiter;
+    }
+
+    if (config.core == "event") {
+        int rc = run_event_server(config, auth, storage, route_options);
+        if (rc == 0) {
+            vault::logging::info("Server", "Stopped");
+        }
+        vault::logging::stop();
+        return rc;
+    }
+
+    // PERF: Every listener binds the same port with SO_REUSEPORT and has its
+    // own accept loop and worker pool; the kernel spreads connections across
+    // them. Auth, storage, metrics and capture are shared.
+    for (std::size_t i = 0; i < config.listeners; ++i) {
+        auto server = std::make_unique<httplib::Server>();
+        vault::server::apply_server_config(*server, config);
+        vault::server::setup_routes(*server, auth, storage, route_options);
+        g_servers.push_back(std::move(server));
+    }
 
     // Register signal handler for graceful shutdown (Ctrl+C)
     std::signal(SIGINT, signal_handler);
     std::signal(SIGTERM, signal_handler);
 
-    // ── Setup routes ────────────────────────────────────────────────────
-    vault::server::setup_routes(server, auth, storage);
-
     // ── Start listening ─────────────────────────────────────────────────
-    std::cout << "[Server] Listening on " << host << ":" << port << "\n";
-    std::cout << "[Server] Press Ctrl+C to stop\n\n";
+    // Bind every socket before accepting on any, so a failure is all-or-nothing
+    for (auto& server : g_servers) {
+        if (!server->bind_to_port(config.host, config.port)) {
+            vault::logging::error("Server", "Failed to start on " + config.host + ":" +
+                                            std::to_string(config.port));
+            vault::logging::stop();
+            return 1;
+        }
+    }
 
-    if (!server.listen(host, port)) {
-        std::cerr << "[Server] Failed to start on " << host << ":" << port << "\n";
-        return 1;
+    vault::logging::info("Server", "Listening on " + config.host + ":" + std::to_string(config.port));
+    vault::logging::info("Server", std::to_string(config.listeners) + " listener(s) x " +
+                                   std::to_string(config.threads_per_listener()) +
+                                   " worker thread(s), " + config.task_queue + " task queue");
+    vault::logging::info("Server", "Press Ctrl+C to stop");
+
+    // The first listener runs here; when any of them stops, all do
+    std::vector<std::thread> extra;
+    for (std::size_t i = 1; i < g_servers.size(); ++i) {
+        extra.emplace_back([i] {
+            g_servers[i]->listen_after_bind();
+            g_servers[0]->stop();
+        });
+    }
+    g_servers[0]->listen_after_bind();
+    for (auto& server : g_servers) {
+        server->stop();
+    }
+    for (auto& t : extra) {
+        t.join();
     }
 
-    std::cout << "[Server] Stopped\n";
+    vault::logging::info("Server", "Stopped");
+    vault::logging::stop();
     return 0;
 }
@@ -0,0 +1,287 @@
+#include "metrics/metrics.h"
+
+#include <algorithm>
+#include <bit>
+#include <iomanip>
+#include <sstream>
+
+namespace vault::server
+{
+    namespace
+    {
+        std::atomic<std::uint64_t> g_next_metrics_id{1};
+
+        struct LocalShard
+        {
+            std::uint64_t owner;
+            void* shard;
+        };
+
+        // Almost always one entry per thread: the process-wide Metrics instance
+        thread_local std::vector<LocalShard> t_local_shards;
+
+        // Prometheus histogram boundaries in seconds, derived from the fine buckets
+        constexpr double kExportBounds[] =
+        {
+            0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025,
+            0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0, 30.0
+        };
+
+        constexpr double kQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+    }
+
+    Metrics::Metrics()
+        : id_(g_next_metrics_id.fetch_add(1))
+    {
+        other_route_ = add_route("other");
+    }
+
+    Metrics::~Metrics() = default;
+
+    std::size_t Metrics::add_route(const std::string& route)
+    {
+        std::lock_guard<std::mutex> lock(shards_mutex_);
+
+        auto it = route_slots_.find(route);
+        if (it != route_slots_.end()) return it->second;
+
+        // Shards are sized at creation; late routes fall back to "other"
+        if (!shards_.empty()) return other_route_;
+
+        routes_.push_back(route);
+        route_slots_[route] = routes_.size() - 1;
+        return routes_.size() - 1;
+    }
+
+    std::size_t Metrics::route_index(const std::string& path) const
+    {
+        auto it = route_slots_.find(path);
+        return it != route_slots_.end() ? it->second : other_route_;
+    }
+
+    // ─── Bucketing ──────────────────────────────────────────────────────────────
+
+    std::size_t Metrics::latency_bucket(std::uint64_t micros)
+    {
+        if (micros < kSubBuckets) return static_cast<std::size_t>(micros);
+
+        std::size_t exponent = static_cast<std::size_t>(std::bit_width(micros)) - 1;
+        if (exponent > kMaxExponent) return kLatencyBuckets - 1;
+
+        // Top kSubBucketBits bits below the leading one select the sub-bucket
+        std::size_t sub = static_cast<std::size_t>(micros >> (exponent - kSubBucketBits)) - kSubBuckets;
+        return kSubBuckets + (exponent - kSubBucketBits) * kSubBuckets + sub;
+    }
+
+    std::uint64_t Metrics::bucket_upper_bound(std::size_t index)
+    {
+        if (index < kSubBuckets) return index + 1;
+
+        std::size_t exponent = (index - kSubBuckets) / kSubBuckets + kSubBucketBits;
+        std::size_t sub = (index - kSubBuckets) % kSubBuckets;
+        return static_cast<std::uint64_t>(kSubBuckets + sub + 1) << (exponent - kSubBucketBits);
+    }
+
+    std::size_t Metrics::status_slot(int status)
+    {
+        for (std::size_t i = 0; i < kTrackedStatus.size(); ++i)
+        {
+            if (kTrackedStatus[i] == status) return i;
+        }
+        return kTrackedStatus.size();
+    }
+
+    // ─── Recording ──────────────────────────────────────────────────────────────
+
+    Metrics::ThreadShard& Metrics::local_shard()
+    {
+        for (const auto& entry : t_local_shards)
+        {
+            if (entry.owner == id_) return *static_cast<ThreadShard*>(entry.shard);
+        }
+
+        // First request on this thread: allocate and publish a private shard
+        std::lock_guard<std::mutex> lock(shards_mutex_);
+        auto shard = std::make_shared<ThreadShard>(routes_.size());
+        shards_.push_back(shard);
+        t_local_shards.push_back({id_, shard.get()});
+        return *shard;
+    }
+
+    void Metrics::record(std::size_t route, int status,
+                         std::uint64_t bytes_in, std::uint64_t bytes_out,
+                         std::chrono::nanoseconds latency)
+    {
+        auto& stats = local_shard().stats[route < routes_.size() ? route : other_route_];
+        auto micros = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+
+        // PERF: Only this thread writes the shard; relaxed adds are enough
+        constexpr auto relaxed = std::memory_order_relaxed;
+        stats.bytes_in.fetch_add(bytes_in, relaxed);
+        stats.bytes_out.fetch_add(bytes_out, relaxed);
+        stats.latency_sum_us.fetch_add(micros, relaxed);
+        stats.status[status_slot(status)].fetch_add(1, relaxed);
+        stats.latency[latency_bucket(micros)].fetch_add(1, relaxed);
+    }
+
+    void Metrics::add_gauge(const std::string& name, const std::string& help,
+                            std::function<double()> sample)
+    {
+        add_sampled({name, help, "gauge", std::move(sample)});
+    }
+
+    void Metrics::add_counter(const std::string& name, const std::string& help,
+                              std::function<double()> sample)
+    {
+        add_sampled({name, help, "counter", std::move(sample)});
+    }
+
+    void Metrics::add_sampled(Sampled sampled)
+    {
+        // Every listener wires up the same registry; the last one wins
+        for (auto& existing : sampled_)
+        {
+            if (existing.name == sampled.name)
+            {
+                existing = std::move(sampled);
+                return;
+            }
+        }
+        sampled_.push_back(std::move(sampled));
+    }
+
+    // ─── Exposition ─────────────────────────────────────────────────────────────
+
+    std::string Metrics::render() const
+    {
+        struct Merged
+        {
+            std::uint64_t bytes_in = 0;
+            std::uint64_t bytes_out = 0;
+            std::uint64_t latency_sum_us = 0;
+            std::array<std::uint64_t, kStatusSlots> status{};
+            std::array<std::uint64_t, kLatencyBuckets> latency{};
+        };
+
+        std::vector<Merged> merged(routes_.size());
+        {
+            std::lock_guard<std::mutex> lock(shards_mutex_);
+            constexpr auto relaxed = std::memory_order_relaxed;
+            for (const auto& shard : shards_)
+            {
+                for (std::size_t r = 0; r < routes_.size(); ++r)
+                {
+                    const auto& src = shard->stats[r];
+                    auto& dst = merged[r];
+                    dst.bytes_in += src.bytes_in.load(relaxed);
+                    dst.bytes_out += src.bytes_out.load(relaxed);
+                    dst.latency_sum_us += src.latency_sum_us.load(relaxed);
+                    for (std::size_t i = 0; i < kStatusSlots; ++i)
+                        dst.status[i] += src.status[i].load(relaxed);
+                    for (std::size_t i = 0; i < kLatencyBuckets; ++i)
+                        dst.latency[i] += src.latency[i].load(relaxed);
+                }
+            }
+        }
+
+        std::ostringstream out;
+        out << std::setprecision(10);
+
+        out << "# HELP vault_http_requests_total Requests handled, by route and status\n"
+            << "# TYPE vault_http_requests_total counter\n";
+        for (std::size_t r = 0; r < routes_.size(); ++r)
+        {
+            for (std::size_t i = 0; i < kStatusSlots; ++i)
+            {
+                if (merged[r].status[i] == 0) continue;
+                out << "vault_http_requests_total{route=\"" << routes_[r] << "\",status=\""
+                    << (i < kTrackedStatus.size() ? std::to_string(kTrackedStatus[i]) : "other")
+                    << "\"} " << merged[r].status[i] << "\n";
+            }
+        }
+
+        out << "# HELP vault_http_request_bytes_total Request body bytes received\n"
+            << "# TYPE vault_http_request_bytes_total counter\n";
+        for (std::size_t r = 0; r < routes_.size(); ++r)
+        {
+            out << "vault_http_request_bytes_total{route=\"" << routes_[r] << "\"} "
+                << merged[r].bytes_in << "\n";
+        }
+
+        out << "# HELP vault_http_response_bytes_total Response body bytes sent\n"
+            << "# TYPE vault_http_response_bytes_total counter\n";
+        for (std::size_t r = 0; r < routes_.size(); ++r)
+        {
+            out << "vault_http_response_bytes_total{route=\"" << routes_[r] << "\"} "
+                << merged[r].bytes_out << "\n";
+        }
+
+        out << "# HELP vault_http_request_duration_seconds Request latency\n"
+            << "# TYPE vault_http_request_duration_seconds histogram\n";
+        for (std::size_t r = 0; r < routes_.size(); ++r)
+        {
+            const auto& m = merged[r];
+            std::uint64_t count = 0;
+            for (auto c : m.latency) count += c;
+            if (count == 0) continue;
+
+            // A fine bucket counts towards `le` once its upper bound fits under it
+            std::size_t bucket = 0;
+            std::uint64_t cumulative = 0;
+            for (double bound : kExportBounds)
+            {
+                auto bound_us = static_cast<std::uint64_t>(bound * 1e6);
+                while (bucket < kLatencyBuckets && bucket_upper_bound(bucket) <= bound_us)
+                {
+                    cumulative += m.latency[bucket++];
+                }
+                out << "vault_http_request_duration_seconds_bucket{route=\"" << routes_[r]
+                    << "\",le=\"" << bound << "\"} " << cumulative << "\n";
+            }
+            out << "vault_http_request_duration_seconds_bucket{route=\"" << routes_[r]
+                << "\",le=\"+Inf\"} " << count << "\n"
+                << "vault_http_request_duration_seconds_sum{route=\"" << routes_[r] << "\"} "
+                << static_cast<double>(m.latency_sum_us) / 1e6 << "\n"
+                << "vault_http_request_duration_seconds_count{route=\"" << routes_[r] << "\"} "
+                << count << "\n";
+        }
+
+        // Exact-bucket quantiles: the full-resolution view the coarse histogram loses
+        out << "# HELP vault_http_request_duration_quantile_seconds Latency quantiles (upper bucket bound)\n"
+            << "# TYPE vault_http_request_duration_quantile_seconds gauge\n";
+        for (std::size_t r = 0; r < routes_.size(); ++r)
+        {
+            const auto& m = merged[r];
+            std::uint64_t count = 0;
+            for (auto c : m.latency) count += c;
+            if (count == 0) continue;
+
+            for (double q : kQuantiles)
+            {
+                auto rank = static_cast<std::uint64_t>(q * static_cast<double>(count - 1)) + 1;
+                std::uint64_t seen = 0;
+                std::size_t bucket = 0;
+                for (; bucket < kLatencyBuckets; ++bucket)
+                {
+                    seen += m.latency[bucket];
+                    if (seen >= rank) break;
+                }
+                bucket = std::min(bucket, kLatencyBuckets - 1);
+                out << "vault_http_request_duration_quantile_seconds{route=\"" << routes_[r]
+                    << "\",quantile=\"" << q << "\"} "
+                    << static_cast<double>(bucket_upper_bound(bucket)) / 1e6 << "\n";
+            }
+        }
+
+        for (const auto& s : sampled_)
+        {
+            out << "# HELP " << s.name << " " << s.help << "\n"
+                << "# TYPE " << s.name << " " << s.type << "\n"
+                << s.name << " " << s.sample() << "\n";
+        }
+
+        return out.str();
+    }
+
+}
@@ -0,0 +1,95 @@
+#include "replication/change_log.h"
+#include "crypto/crypto.h"
+
+#include <algorithm>
+
+namespace vault::server
+{
+
+    static std::int64_t now_ms()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    ChangeLog::ChangeLog(std::size_t capacity)
+        : capacity_(std::max<std::size_t>(1, capacity)),
+          epoch_(crypto::generate_token().substr(0, 16))
+    {
+    }
+
+    void ChangeLog::attach(AuthManager& auth, StorageManager& storage)
+    {
+        auth.set_register_observer([this](const models::User& user) { append_user(user); });
+        storage.set_write_observer([this](const std::string& username, const std::string& filename,
+                                          const StorageManager::ObjectInfo& info)
+        {
+            append_object(username, filename, info);
+        });
+    }
+
+    void ChangeLog::append_user(const models::User& user)
+    {
+        Entry entry;
+        entry.kind = Entry::Kind::User;
+        entry.username = user.username;
+        entry.password_hash = user.password_hash;
+        entry.salt = user.salt;
+        append(std::move(entry));
+    }
+
+    void ChangeLog::append_object(const std::string& username, const std::string& filename,
+                                  const StorageManager::ObjectInfo& info)
+    {
+        Entry entry;
+        entry.kind = Entry::Kind::Object;
+        entry.username = username;
+        entry.filename = filename;
+        entry.sha256 = info.sha256;
+        entry.size = info.size;
+        append(std::move(entry));
+    }
+
+    void ChangeLog::append(Entry entry)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            entry.seq = ++head_;
+            entry.time_ms = now_ms();
+            entries_.push_back(std::move(entry));
+            if (entries_.size() > capacity_) entries_.pop_front();
+        }
+        appended_.notify_all();
+    }
+
+    std::uint64_t ChangeLog::head() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return head_;
+    }
+
+    std::optional<std::vector<ChangeLog::Entry>> ChangeLog::read(std::uint64_t after, std::size_t limit,
+                                                                 std::chrono::milliseconds wait)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        // A replica ahead of us followed an earlier process
+        if (after > head_) return std::nullopt;
+
+        // PERF: A caught-up replica parks here, so a write reaches it as
+        // soon as it is logged rather than on its next poll
+        appended_.wait_for(lock, wait, [this, after] { return head_ > after; });
+
+        std::uint64_t first = head_ - entries_.size() + 1;
+        if (after + 1 < first) return std::nullopt;
+
+        std::vector<Entry> batch;
+        for (auto i = static_cast<std::size_t>(after + 1 - first);
+             i < entries_.size() && batch.size() < limit; ++i)
+        {
+            batch.push_back(entries_[i]);
+        }
+        return batch;
+    }
+
+} // namespace vault::server
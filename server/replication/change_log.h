@@ -0,0 +1,85 @@
+#pragma once
+
+#include "auth/auth_manager.h"
+#include "storage/storage_manager.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace vault::server
+{
+
+    /// Ordered record of every mutation on a primary server, for replicas
+    /// to tail: registrations and completed object writes, numbered from 1
+    /// in the order they became visible.
+    ///
+    /// The log lives in memory and keeps the newest `capacity` entries. Its
+    /// epoch is new with every process, so after a restart, or when a
+    /// replica has fallen further behind than the log reaches, the replica
+    /// starts over from a snapshot instead. Object entries carry no bytes;
+    /// replicas fetch the current copy, so replaying an entry twice or out
+    /// of date still converges on what the primary holds.
+    class ChangeLog
+    {
+    public:
+        struct Entry
+        {
+            enum class Kind
+            {
+                User,      // username, password_hash, salt
+                Object     // username, filename, sha256, size
+            };
+
+            std::uint64_t seq = 0;
+            std::int64_t time_ms = 0;    // primary's wall clock when logged
+            Kind kind = Kind::Object;
+            std::string username;
+            std::string filename;
+            std::string sha256;
+            std::uint64_t size = 0;
+            std::string password_hash;
+            std::string salt;
+        };
+
+        explicit ChangeLog(std::size_t capacity = 100000);
+
+        /// Log every registration on `auth` and every write to `storage`.
+        /// Call before serving requests.
+        void attach(AuthManager& auth, StorageManager& storage);
+
+        void append_user(const models::User& user);
+        void append_object(const std::string& username, const std::string& filename,
+                           const StorageManager::ObjectInfo& info);
+
+        /// Identifies this process's sequence numbers
+        const std::string& epoch() const { return epoch_; }
+
+        /// Sequence number of the newest entry, 0 while empty
+        std::uint64_t head() const;
+
+        /// Up to `limit` entries after `after`, waiting up to `wait` for the
+        /// first if there are none yet. nullopt if entries after `after`
+        /// have already been dropped.
+        std::optional<std::vector<Entry>> read(std::uint64_t after, std::size_t limit,
+                                               std::chrono::milliseconds wait);
+
+    private:
+        void append(Entry entry);
+
+        std::size_t capacity_;
+        std::string epoch_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable appended_;
+        std::deque<Entry> entries_;      // seqs head_ - size() + 1 .. head_
+        std::uint64_t head_ = 0;
+    };
+
+} // namespace vault::server
@@ -0,0 +1,340 @@
+#include "replication/replica.h"
+#include "logging/logger.h"
+#include "utils/utils.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+using json = nlohmann::json;
+
+namespace vault::server
+{
+
+    static std::int64_t now_ms()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    /// One entry of a /replication/log response
+    static ChangeLog::Entry parse_entry(const json& j)
+    {
+        ChangeLog::Entry entry;
+        entry.seq = j.at("seq").get<std::uint64_t>();
+        entry.time_ms = j.value("time", std::int64_t{0});
+        entry.kind = j.at("type").get<std::string>() == "user" ? ChangeLog::Entry::Kind::User
+                                                                : ChangeLog::Entry::Kind::Object;
+        entry.username = j.at("user").get<std::string>();
+        entry.filename = j.value("file", "");
+        entry.sha256 = j.value("sha256", "");
+        entry.size = j.value("size", std::uint64_t{0});
+        entry.password_hash = j.value("password_hash", "");
+        entry.salt = j.value("salt", "");
+        return entry;
+    }
+
+    Replica::Replica(AuthManager& auth, StorageManager& storage, Options options)
+        : auth_(auth), storage_(storage), options_(std::move(options)),
+          last_contact_ms_(now_ms())
+    {
+        headers_ = {{"X-Replication-Secret", options_.secret}};
+
+        client_ = std::make_unique<httplib::Client>(options_.primary);
+        if (!client_->is_valid())
+        {
+            throw std::invalid_argument("Unusable primary URL: " + options_.primary);
+        }
+        client_->set_keep_alive(true);
+        client_->set_connection_timeout(5);
+        client_->set_read_timeout(options_.poll_wait.count() + 30);   // a poll may be held that long
+        client_->set_write_timeout(30);
+
+        thread_ = std::thread([this] { run(); });
+    }
+
+    Replica::~Replica()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_one();
+        client_->stop();    // cut a long-poll short
+        thread_.join();
+    }
+
+    double Replica::lag_seconds() const
+    {
+        std::int64_t since = connected() ? pending_since_ms_.load(std::memory_order_relaxed)
+                                         : last_contact_ms_.load(std::memory_order_relaxed);
+        if (since == 0) return 0.0;
+        return static_cast<double>(std::max<std::int64_t>(0, now_ms() - since)) / 1000.0;
+    }
+
+    bool Replica::stopping()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stopping_;
+    }
+
+    void Replica::fail(const std::string& what)
+    {
+        if (connected_.exchange(false, std::memory_order_relaxed))
+        {
+            logging::warn("Replica", "Lost contact with " + options_.primary + ": " + what);
+        }
+        else
+        {
+            static logging::RateLimit retry_limit(std::chrono::seconds(30));
+            logging::log(retry_limit, logging::Level::Warn, "Replica",
+                         "Cannot replicate from " + options_.primary + ": " + what);
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait_for(lock, options_.retry_interval, [this] { return stopping_; });
+    }
+
+    void Replica::run()
+    {
+        logging::info("Replica", "Replicating from " + options_.primary);
+
+        bool need_snapshot = true;
+        while (!stopping())
+        {
+            if (need_snapshot)
+            {
+                if (!resync()) continue;
+                need_snapshot = false;
+            }
+            if (poll() == Poll::Restart) need_snapshot = true;
+        }
+    }
+
+    bool Replica::resync()
+    {
+        auto started = now_ms();
+        auto res = client_->Get("/replication/snapshot", headers_);
+        if (!res)
+        {
+            fail(httplib::to_string(res.error()));
+            return false;
+        }
+        if (res->status != 200)
+        {
+            fail("snapshot answered " + std::to_string(res->status));
+            return false;
+        }
+
+        json snapshot = json::parse(res->body, nullptr, false);
+        if (snapshot.is_discarded() || !snapshot.is_object())
+        {
+            fail("malformed snapshot");
+            return false;
+        }
+
+        if (!connected_.exchange(true, std::memory_order_relaxed))
+        {
+            logging::info("Replica", "Connected to " + options_.primary);
+        }
+        last_contact_ms_.store(now_ms(), std::memory_order_relaxed);
+
+        std::int64_t none = 0;
+        pending_since_ms_.compare_exchange_strong(none, started, std::memory_order_relaxed);
+
+        std::uint64_t head = 0;
+        std::size_t users = 0;
+        std::size_t fetched = 0;
+        try
+        {
+            head = snapshot.at("head").get<std::uint64_t>();
+            head_.store(head, std::memory_order_relaxed);
+
+            for (const auto& u : snapshot.at("users"))
+            {
+                models::User user{u.at("username").get<std::string>(),
+                                  u.at("password_hash").get<std::string>(),
+                                  u.at("salt").get<std::string>()};
+                if (auth_.add_user(user)) ++users;
+            }
+
+            // Objects are fetched only where the hashes differ, so taking a
+            // snapshot again after a reconnect costs one listing
+            for (const auto& o : snapshot.at("objects"))
+            {
+                if (stopping()) return false;
+
+                ChangeLog::Entry entry;
+                entry.username = o.at("user").get<std::string>();
+                entry.filename = o.at("file").get<std::string>();
+                entry.sha256 = o.at("sha256").get<std::string>();
+                auto before = objects_.load(std::memory_order_relaxed);
+                if (!apply(entry)) return false;
+                if (objects_.load(std::memory_order_relaxed) != before) ++fetched;
+            }
+        }
+        catch (const std::exception& e)
+        {
+            fail(std::string("bad snapshot: ") + e.what());
+            return false;
+        }
+
+        epoch_ = snapshot.value("epoch", "");
+        applied_.store(head, std::memory_order_relaxed);
+        pending_since_ms_.store(0, std::memory_order_relaxed);
+        snapshots_.fetch_add(1, std::memory_order_relaxed);
+
+        logging::info("Replica", "Snapshot at change " + std::to_string(head) + ": " +
+                                 std::to_string(users) + " new user(s), " +
+                                 std::to_string(fetched) + " object(s) fetched");
+        return true;
+    }
+
+    Replica::Poll Replica::poll()
+    {
+        auto path = "/replication/log?epoch=" + utils::url_encode(epoch_) +
+                    "&after=" + std::to_string(applied()) +
+                    "&limit=" + std::to_string(options_.batch) +
+                    "&wait=" + std::to_string(options_.poll_wait.count());
+        auto res = client_->Get(path, headers_);
+        if (!res)
+        {
+            fail(httplib::to_string(res.error()));
+            return Poll::Failed;
+        }
+        if (res->status == 410)
+        {
+            logging::warn("Replica", "Primary log can't continue from change " +
+                                     std::to_string(applied()) + "; taking a new snapshot");
+            return Poll::Restart;
+        }
+        if (res->status != 200)
+        {
+            fail("log answered " + std::to_string(res->status));
+            return Poll::Failed;
+        }
+
+        std::vector<ChangeLog::Entry> entries;
+        std::uint64_t head = 0;
+        try
+        {
+            json body = json::parse(res->body);
+            head = body.at("head").get<std::uint64_t>();
+            for (const auto& e : body.at("entries"))
+            {
+                entries.push_back(parse_entry(e));
+            }
+        }
+        catch (const std::exception& e)
+        {
+            fail(std::string("malformed log: ") + e.what());
+            return Poll::Failed;
+        }
+
+        connected_.store(true, std::memory_order_relaxed);
+        last_contact_ms_.store(now_ms(), std::memory_order_relaxed);
+        head_.store(head, std::memory_order_relaxed);
+
+        // PERF: A fetch always returns the current bytes, so only the last
+        // entry for each object in a batch needs one
+        std::unordered_map<std::string, std::size_t> last_write;
+        for (std::size_t i = 0; i < entries.size(); ++i)
+        {
+            if (entries[i].kind == ChangeLog::Entry::Kind::Object)
+            {
+                last_write[entries[i].username + "/" + entries[i].filename] = i;
+            }
+        }
+
+        for (std::size_t i = 0; i < entries.size(); ++i)
+        {
+            const auto& entry = entries[i];
+            if (entry.seq <= applied()) continue;
+            pending_since_ms_.store(entry.time_ms, std::memory_order_relaxed);
+
+            bool superseded = entry.kind == ChangeLog::Entry::Kind::Object &&
+                              last_write[entry.username + "/" + entry.filename] != i;
+            if (!superseded && !apply(entry)) return Poll::Failed;
+            applied_.store(entry.seq, std::memory_order_relaxed);
+        }
+
+        if (applied() >= head) pending_since_ms_.store(0, std::memory_order_relaxed);
+        return Poll::Applied;
+    }
+
+    bool Replica::apply(const ChangeLog::Entry& entry)
+    {
+        if (entry.kind == ChangeLog::Entry::Kind::User)
+        {
+            try
+            {
+                auth_.add_user({entry.username, entry.password_hash, entry.salt});
+                return true;
+            }
+            catch (const std::exception& e)
+            {
+                fail(std::string("cannot add user: ") + e.what());
+                return false;
+            }
+        }
+
+        // Already have these bytes (a resync after a reconnect, or a replay)
+        try
+        {
+            auto local = storage_.object_info(entry.username, entry.filename);
+            if (local && local->sha256 == entry.sha256) return true;
+        }
+        catch (const std::exception&)
+        {
+            // Unreadable locally: fetch it again
+        }
+        return fetch_object(entry.username, entry.filename);
+    }
+
+    bool Replica::fetch_object(const std::string& username, const std::string& filename)
+    {
+        auto writer = storage_.open_writer(username, filename);
+        if (!writer)
+        {
+            fail("cannot store " + username + "/" + filename);
+            return false;
+        }
+
+        // PERF: Streamed into storage as it arrives; never buffered whole
+        int status = 0;
+        auto res = client_->Get(
+            "/replication/object?user=" + utils::url_encode(username) + "&file=" + utils::url_encode(filename),
+            headers_,
+            [&status](const httplib::Response& response)
+            {
+                status = response.status;
+                return response.status == 200;
+            },
+            [&writer](const char* data, size_t length) { return writer->write(data, length); });
+
+        if (status == 404)
+        {
+            logging::warn("Replica", "Primary no longer has " + username + "/" + filename);
+            return true;
+        }
+        if (!res || res->status != 200)
+        {
+            bool refused = status != 0 && status != 200;
+            fail("fetching " + username + "/" + filename + ": " +
+                 (refused ? "status " + std::to_string(status) : httplib::to_string(res.error())));
+            return false;
+        }
+        if (!writer->commit())
+        {
+            fail("cannot store " + username + "/" + filename);
+            return false;
+        }
+
+        objects_.fetch_add(1, std::memory_order_relaxed);
+        bytes_.fetch_add(writer->size(), std::memory_order_relaxed);
+        return true;
+    }
+
+} // namespace vault::server
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "auth/auth_manager.h"
+#include "replication/change_log.h"
+#include "storage/storage_manager.h"
+
+#include <httplib.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace vault::server
+{
+
+    /// Keeps this server's users and objects in step with a primary by
+    /// tailing its ChangeLog over HTTP, on a background thread.
+    ///
+    /// It starts from a snapshot of the primary (every user, and every
+    /// object whose hash differs from the local copy), then long-polls the
+    /// log and applies entries in order. Whenever the log can't continue
+    /// where it left off (the primary restarted, or dropped entries this
+    /// replica never saw) it takes a fresh snapshot.
+    class Replica
+    {
+    public:
+        struct Options
+        {
+            std::string primary;                        // e.g. "http://10.0.0.1:8080"
+            std::string secret;                         // the primary's --replication-secret
+            std::chrono::seconds poll_wait{5};          // how long the primary may hold a poll
+            std::size_t batch = 512;                    // entries per poll
+            std::chrono::seconds retry_interval{1};     // pause after a failed request
+        };
+
+        /// Starts replicating right away. Throws std::invalid_argument if
+        /// the primary URL can't be used.
+        Replica(AuthManager& auth, StorageManager& storage, Options options);
+
+        /// Abandons any request in flight and joins the thread
+        ~Replica();
+
+        Replica(const Replica&) = delete;
+        Replica& operator=(const Replica&) = delete;
+
+        const std::string& primary() const { return options_.primary; }
+
+        /// Newest primary entry applied here, and the newest the primary has
+        std::uint64_t applied() const { return applied_.load(std::memory_order_relaxed); }
+        std::uint64_t primary_head() const { return head_.load(std::memory_order_relaxed); }
+
+        /// True while the last request to the primary succeeded
+        bool connected() const { return connected_.load(std::memory_order_relaxed); }
+
+        /// How far behind the primary this copy may be: 0 when caught up,
+        /// else seconds since the oldest change not applied yet was made
+        /// (or since the primary was last reached). Compares clocks across
+        /// hosts, so they should be synchronised.
+        double lag_seconds() const;
+
+        std::uint64_t objects_fetched() const { return objects_.load(std::memory_order_relaxed); }
+        std::uint64_t bytes_fetched() const { return bytes_.load(std::memory_order_relaxed); }
+        std::uint64_t snapshots() const { return snapshots_.load(std::memory_order_relaxed); }
+
+    private:
+        enum class Poll
+        {
+            Applied,
+            Restart,    // the log can't continue from here; take a snapshot
+            Failed
+        };
+
+        void run();
+
+        /// Copy every user and changed object from the primary's snapshot
+        bool resync();
+
+        /// One long-poll of the log, applying whatever it returns
+        Poll poll();
+
+        bool apply(const ChangeLog::Entry& entry);
+
+        /// Stream the primary's current copy of an object into storage.
+        /// A 404 counts as done: the object is gone.
+        bool fetch_object(const std::string& username, const std::string& filename);
+
+        /// Record a failed request; waits retry_interval unless stopping
+        void fail(const std::string& what);
+
+        bool stopping();
+
+        AuthManager& auth_;
+        StorageManager& storage_;
+        Options options_;
+        httplib::Headers headers_;
+        std::unique_ptr<httplib::Client> client_;   // replication thread only, except stop()
+
+        std::string epoch_;                          // primary log the position refers to
+
+        std::atomic<std::uint64_t> applied_{0};
+        std::atomic<std::uint64_t> head_{0};
+        std::atomic<bool> connected_{false};
+        std::atomic<std::int64_t> pending_since_ms_{0};  // oldest unapplied change, 0 = none
+        std::atomic<std::int64_t> last_contact_ms_;
+        std::atomic<std::uint64_t> objects_{0};
+        std::atomic<std::uint64_t> bytes_{0};
+        std::atomic<std::uint64_t> snapshots_{0};
+
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        bool stopping_ = false;
+        std::thread thread_;
+    };
+
+} // namespace vault::server
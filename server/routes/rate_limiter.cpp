@@ -0,0 +1,133 @@
+#include "routes/rate_limiter.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace vault::server
+{
+
+    RateLimiter::RateLimiter()
+    {
+        // Generous per-IP ceiling for everything, tighter on credential endpoints
+        default_limits_ = {{100.0, 200.0}, {50.0, 100.0}};
+
+        route_limits_["/login"]    = {{5.0, 10.0}, {}};
+        route_limits_["/register"] = {{1.0, 5.0}, {}};
+        route_limits_["/upload"]   = {{50.0, 100.0}, {20.0, 40.0}};
+        route_limits_["/download"] = {{100.0, 200.0}, {50.0, 100.0}};
+        route_limits_["/download-batch"] = {{5.0, 10.0}, {2.0, 5.0}};
+        route_limits_["/list"]     = {{20.0, 40.0}, {10.0, 20.0}};
+        route_limits_["/health"]   = {{}, {}};
+
+        // Replicas prove themselves with the shared secret; throttling them only adds lag
+        route_limits_["/replication/log"]      = {{}, {}};
+        route_limits_["/replication/snapshot"] = {{}, {}};
+        route_limits_["/replication/object"]   = {{}, {}};
+    }
+
+    void RateLimiter::set_route_limits(const std::string& route, const RouteRateLimits& limits)
+    {
+        route_limits_[route] = limits;
+    }
+
+    void RateLimiter::set_default_limits(const RouteRateLimits& limits)
+    {
+        default_limits_ = limits;
+    }
+
+    const RouteRateLimits& RateLimiter::limits_for(const std::string& route) const
+    {
+        auto it = route_limits_.find(route);
+        return it != route_limits_.end() ? it->second : default_limits_;
+    }
+
+    RateLimiter::Shard& RateLimiter::shard_for(const std::string& key)
+    {
+        return shards_[std::hash<std::string>{}(key) % kShardCount];
+    }
+
+    void RateLimiter::evict_full_buckets(Shard& shard, Clock::time_point now)
+    {
+        for (auto it = shard.buckets.begin(); it != shard.buckets.end();)
+        {
+            if (it->second.full_at <= now)
+            {
+                it = shard.buckets.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    double RateLimiter::acquire(const std::string& key, const RateLimit& limit)
+    {
+        if (!limit.enabled()) return 0.0;
+
+        auto now = Clock::now();
+        auto& shard = shard_for(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto it = shard.buckets.find(key);
+        if (it == shard.buckets.end())
+        {
+            // Keep the table bounded: a full bucket can be dropped and recreated losslessly
+            if (shard.buckets.size() >= kShardSoftLimit)
+            {
+                evict_full_buckets(shard, now);
+            }
+            it = shard.buckets.emplace(key, Bucket{limit.burst, now, now}).first;
+        }
+
+        auto& bucket = it->second;
+
+        // Lazy refill: credit the tokens earned since the bucket was last touched
+        double elapsed = std::chrono::duration<double>(now - bucket.last).count();
+        bucket.tokens = std::min(limit.burst, bucket.tokens + elapsed * limit.rate);
+        bucket.last = now;
+
+        double wait = 0.0;
+        if (bucket.tokens >= 1.0)
+        {
+            bucket.tokens -= 1.0;
+        }
+        else
+        {
+            wait = (1.0 - bucket.tokens) / limit.rate;
+        }
+
+        auto to_full = std::chrono::duration<double>((limit.burst - bucket.tokens) / limit.rate);
+        bucket.full_at = now + std::chrono::duration_cast<Clock::duration>(to_full);
+        return wait;
+    }
+
+    void RateLimiter::refund(const std::string& key, const RateLimit& limit)
+    {
+        if (!limit.enabled()) return;
+
+        auto& shard = shard_for(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        // A bucket evicted meanwhile was full; there is nothing to give back
+        auto it = shard.buckets.find(key);
+        if (it == shard.buckets.end()) return;
+
+        auto& bucket = it->second;
+        bucket.tokens = std::min(limit.burst, bucket.tokens + 1.0);
+        auto to_full = std::chrono::duration<double>((limit.burst - bucket.tokens) / limit.rate);
+        bucket.full_at = bucket.last + std::chrono::duration_cast<Clock::duration>(to_full);
+    }
+
+    std::size_t RateLimiter::bucket_count() const
+    {
+        std::size_t total = 0;
+        for (const auto& shard : shards_)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total += shard.buckets.size();
+        }
+        return total;
+    }
+
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace vault::server
+{
+
+    /// Token bucket parameters: `rate` tokens per second, at most `burst` banked.
+    /// A limit with rate or burst <= 0 is disabled.
+    struct RateLimit
+    {
+        double rate = 0.0;
+        double burst = 0.0;
+
+        bool enabled() const { return rate > 0.0 && burst > 0.0; }
+    };
+
+    /// Limits applied to one route, keyed by client IP and by authenticated user
+    struct RouteRateLimits
+    {
+        RateLimit per_ip;
+        RateLimit per_user;
+    };
+
+    /// Sharded table of token buckets with lazy refill.
+    /// Buckets are created on first use and refilled only when touched,
+    /// so idle clients cost nothing. Route limits must be configured
+    /// before the server starts handling requests.
+    class RateLimiter
+    {
+    public:
+        /// Starts with conservative defaults for the built-in routes
+        RateLimiter();
+
+        /// Override the limits for one route (exact path match)
+        void set_route_limits(const std::string& route, const RouteRateLimits& limits);
+
+        /// Limits used for routes without an explicit entry
+        void set_default_limits(const RouteRateLimits& limits);
+
+        const RouteRateLimits& limits_for(const std::string& route) const;
+
+        /// Take one token from the bucket identified by `key`.
+        /// Returns 0 if the request is allowed, otherwise the number of
+        /// seconds until a token becomes available.
+        double acquire(const std::string& key, const RateLimit& limit);
+
+        /// Return a token taken by acquire() for a request that another
+        /// limit then rejected, so one refusal isn't charged twice
+        void refund(const std::string& key, const RateLimit& limit);
+
+        /// Total live buckets across all shards
+        std::size_t bucket_count() const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Bucket
+        {
+            double tokens = 0.0;
+            Clock::time_point last;
+            Clock::time_point full_at;   // after this point the bucket is indistinguishable from new
+        };
+
+        struct Shard
+        {
+            mutable std::mutex mutex;
+            std::unordered_map<std::string, Bucket> buckets;
+        };
+
+        static constexpr std::size_t kShardCount = 64;
+        static constexpr std::size_t kShardSoftLimit = 4096;
+
+        Shard& shard_for(const std::string& key);
+        static void evict_full_buckets(Shard& shard, Clock::time_point now);
+
+        std::array<Shard, kShardCount> shards_;
+        std::unordered_map<std::string, RouteRateLimits> route_limits_;
+        RouteRateLimits default_limits_;
+    };
+
+}
@@ -1,7 +1,16 @@
 #include "routes/routes.h"
+#include "logging/logger.h"
+#include "crypto/crypto.h"
+#include "utils/structured_writer.h"
+#include "utils/tar.h"
+#include "utils/utils.h"
 
 #include <nlohmann/json.hpp>
-#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <memory>
+#include <unordered_set>
 
 using json = nlohmann::json;
 
@@ -21,129 +30,1140 @@ namespace vault::server
         return "";
     }
 
-    static void json_error(httplib::Response& res, int status, const std::string& message) 
+    // ─── Response Encoding ──────────────────────────────────────────────────────
+
+    /// JSON unless the client asked for CBOR or MessagePack via Accept
+    static utils::Encoding response_encoding(const httplib::Request& req) 
+    {
+        return utils::negotiate_encoding(req.get_header_value("Accept"));
+    }
+
+    /// Decode a request body in whichever format its Content-Type names
+    static json parse_body(const httplib::Request& req) 
+    {
+        switch (utils::encoding_from_content_type(req.get_header_value("Content-Type"))) 
+        {
+            case utils::Encoding::Cbor:    return json::from_cbor(req.body);
+            case utils::Encoding::Msgpack: return json::from_msgpack(req.body);
+            case utils::Encoding::Json:    break;
+        }
+        return json::parse(req.body);
+    }
+
+    static void send_error(const httplib::Request& req, httplib::Response& res,
+                           int status, const std::string& message) 
+    {
+        auto encoding = response_encoding(req);
+        std::string body;
+        auto writer = utils::make_writer(encoding, body);
+        writer->begin_object(2)
+               .field("success", false)
+               .field("message", message)
+               .end_object();
+        res.status = status;
+        res.set_content(std::move(body), utils::content_type(encoding));
+    }
+
+    static void send_busy(const httplib::Request& req, httplib::Response& res,
+                          const AuthBusyError& e) 
+    {
+        res.set_header("Retry-After", std::to_string(e.retry_after_seconds()));
+        send_error(req, res, 503, e.what());
+    }
+
+    /// Serialize a DOM body in the negotiated encoding
+    static void send_json(const httplib::Request& req, httplib::Response& res,
+                          int status, const json& body) 
     {
-        json body;
-        body["success"] = false;
-        body["message"] = message;
         res.status = status;
-        res.set_content(body.dump(), "application/json");
+
+        auto encoding = response_encoding(req);
+        switch (encoding) 
+        {
+            case utils::Encoding::Cbor: 
+            {
+                auto bytes = json::to_cbor(body);
+                res.set_content(std::string(bytes.begin(), bytes.end()), utils::content_type(encoding));
+                return;
+            }
+            case utils::Encoding::Msgpack: 
+            {
+                auto bytes = json::to_msgpack(body);
+                res.set_content(std::string(bytes.begin(), bytes.end()), utils::content_type(encoding));
+                return;
+            }
+            case utils::Encoding::Json:
+                break;
+        }
+        res.set_content(body.dump(), utils::content_type(encoding));
     }
 
-    static void json_ok(httplib::Response& res, const json& data = json::object()) 
+    static void send_ok(const httplib::Request& req, httplib::Response& res,
+                        const json& data = json::object()) 
     {
         json body = data;
         body["success"] = true;
+        send_json(req, res, 200, body);
+    }
+
+    static void send_rate_limited(const httplib::Request& req, httplib::Response& res,
+                                  double retry_after) 
+    {
+        auto seconds = static_cast<long>(std::ceil(retry_after));
+        res.set_header("Retry-After", std::to_string(seconds < 1 ? 1 : seconds));
+        send_error(req, res, 429, "Too many requests");
+    }
+
+    /// Reject the request if it is over its per-IP or per-user budget.
+    /// Returns true if a 429 response was written.
+    static bool apply_rate_limits(const httplib::Request& req,
+                                  httplib::Response& res,
+                                  AuthManager& auth,
+                                  RateLimiter& limiter) 
+    {
+        const auto& limits = limiter.limits_for(req.path);
+        const std::string ip_key = req.path + "|ip|" + req.remote_addr;
+
+        if (limits.per_ip.enabled()) 
+        {
+            double wait = limiter.acquire(ip_key, limits.per_ip);
+            if (wait > 0.0) 
+            {
+                send_rate_limited(req, res, wait);
+                return true;
+            }
+        }
+
+        if (limits.per_user.enabled()) 
+        {
+            // Unauthenticated requests are left to the handler (and the per-IP budget)
+            auto username = auth.validate_token(extract_token(req));
+            if (username) 
+            {
+                double wait = limiter.acquire(req.path + "|user|" + *username, limits.per_user);
+                if (wait > 0.0) 
+                {
+                    // Not served, so it doesn't count against the address either
+                    limiter.refund(ip_key, limits.per_ip);
+                    send_rate_limited(req, res, wait);
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    /// Body size: Content-Length, else what was buffered or streamed (a
+    /// chunked upload read through a ContentReader has neither header nor body)
+    static std::uint64_t request_bytes(const httplib::Request& req, const RequestTiming& timing) 
+    {
+        if (req.has_header("Content-Length")) 
+        {
+            try 
+            {
+                return std::stoull(req.get_header_value("Content-Length"));
+            } 
+            catch (const std::exception&) 
+            {
+            }
+        }
+        return req.body.size() + timing.streamed_in;
+    }
+
+    // ─── Request Capture ────────────────────────────────────────────────────────
+
+    /// Larger bodies are never captured, even with payloads on
+    static constexpr std::size_t kMaxCapturedBody = 64 * 1024;
+
+    /// Account a request acts for: the session's owner, or the username in
+    /// a login/registration body. Empty if there is none.
+    static std::string request_user(const httplib::Request& req, const AuthManager& auth) 
+    {
+        if (req.path == "/login" || req.path == "/register") 
+        {
+            try 
+            {
+                return parse_body(req).value("username", "");
+            } 
+            catch (const std::exception&) 
+            {
+                return "";
+            }
+        }
+        auto username = auth.validate_token(extract_token(req));
+        return username ? *username : "";
+    }
+
+    /// A JSON request body with secrets removed and names pseudonymised
+    static json redact_body(json body, const RequestCapture& capture) 
+    {
+        if (!body.is_object()) return json::object();
+
+        body.erase("password");
+        body.erase("prefix");      // a name fragment; can't be pseudonymised usefully
+        if (body.contains("username") && body["username"].is_string()) 
+        {
+            body["username"] = capture.user_pseudonym(body["username"].get<std::string>());
+        }
+        if (body.contains("files") && body["files"].is_array()) 
+        {
+            for (auto& name : body["files"]) 
+            {
+                if (name.is_string()) name = capture.file_pseudonym(name.get<std::string>());
+            }
+        }
+        return body;
+    }
+
+    static void capture_request(RequestCapture& capture, const AuthManager& auth,
+                                const httplib::Request& req, const httplib::Response& res,
+                                std::chrono::steady_clock::time_point start,
+                                std::uint64_t bytes_in, std::uint64_t bytes_out) 
+    {
+        using namespace std::chrono;
+        auto now = steady_clock::now();
+        if (start == steady_clock::time_point{}) start = now;
+
+        json line = 
+        {
+            {"t_us", duration_cast<microseconds>(start - capture.epoch()).count()},
+            {"method", req.method},
+            {"route", req.path},
+        };
+
+        std::string user = request_user(req, auth);
+        if (!user.empty()) line["user"] = capture.user_pseudonym(user);
+
+        // Names are pseudonymised like those in bodies, whichever route
+        // carries them; a prefix is dropped as in redact_body()
+        json params = json::object();
+        for (const auto& [key, value] : req.params) 
+        {
+            if (key == "filename" || key == "file") params[key] = capture.file_pseudonym(value);
+            else if (key == "user" || key == "username") params[key] = capture.user_pseudonym(value);
+            else if (key == "prefix") continue;
+            else if (capture.payloads()) params[key] = value;
+        }
+        if (!params.empty()) line["params"] = std::move(params);
+
+        if (!req.files.empty()) 
+        {
+            json files = json::array();
+            for (const auto& [field, file] : req.files) 
+            {
+                files.push_back({{"field", field},
+                                 {"name", capture.file_pseudonym(file.filename)},
+                                 {"size", file.content.size()}});
+            }
+            line["files"] = std::move(files);
+        }
+
+        // Media types only; a multipart boundary is meaningless on replay
+        auto content_type = req.get_header_value("Content-Type");
+        if (!content_type.empty()) line["content_type"] = content_type.substr(0, content_type.find(';'));
+        if (req.has_header("Accept")) line["accept"] = req.get_header_value("Accept");
+
+        line["bytes_in"] = bytes_in;
+        line["bytes_out"] = bytes_out;
+        line["status"] = res.status;
+        line["duration_us"] = duration_cast<microseconds>(now - start).count();
+
+        if (capture.payloads() && req.files.empty() && !req.body.empty() &&
+            req.body.size() <= kMaxCapturedBody) 
+        {
+            try 
+            {
+                line["body"] = redact_body(parse_body(req), capture);
+            } 
+            catch (const std::exception&) 
+            {
+                // Not a structured body (or malformed): size alone is recorded
+            }
+        }
+
+        capture.write(line.dump());
+    }
+
+    /// Route paths known to the metrics registry (anything else is "other")
+    static const char* const kRoutePaths[] = 
+    {
+        "/register", "/login", "/upload", "/download", "/download-batch", "/list", "/health",
+        "/metrics", "/replication/log", "/replication/snapshot", "/replication/object",
+    };
+
+    static void setup_middleware(RouteRegistrar& routes,
+                                 AuthManager& auth,
+                                 StorageManager& storage,
+                                 const RouteOptions& options) 
+    {
+        Metrics* metrics = options.metrics;
+        RateLimiter* limiter = options.rate_limiter;
+        RequestCapture* capture = options.capture;
+
+        if (!metrics && !limiter && !capture) return;
+
+        if (limiter) 
+        {
+            routes.set_pre_routing_handler([&auth, limiter](const httplib::Request& req,
+                                                            httplib::Response& res) 
+            {
+                return apply_rate_limits(req, res, auth, *limiter)
+                    ? httplib::Server::HandlerResponse::Handled
+                    : httplib::Server::HandlerResponse::Unhandled;
+            });
+        }
+
+        if (!metrics && !capture) return;
+
+        if (metrics) 
+        {
+            for (const char* path : kRoutePaths) 
+            {
+                metrics->add_route(path);
+            }
+
+            metrics->add_gauge("vault_auth_users", "Registered users",
+                               [&auth] { return static_cast<double>(auth.user_count()); });
+            metrics->add_gauge("vault_auth_sessions", "Live session tokens",
+                               [&auth] { return static_cast<double>(auth.session_count()); });
+            metrics->add_gauge("vault_storage_bytes", "Encrypted bytes stored",
+                               [&storage] { return static_cast<double>(storage.stored_bytes()); });
+            metrics->add_gauge("vault_storage_files", "Encrypted files stored",
+                               [&storage] { return static_cast<double>(storage.stored_files()); });
+            metrics->add_gauge("vault_storage_corrupt_objects", "Stored files that failed verification since their last write",
+                               [&storage] { return static_cast<double>(storage.corrupt_objects()); });
+            if (Scrubber* scrubber = options.scrubber) 
+            {
+                metrics->add_counter("vault_scrub_passes_total", "Completed scrubber passes over the store",
+                                     [scrubber] { return static_cast<double>(scrubber->passes()); });
+                metrics->add_counter("vault_scrub_objects_total", "Stored files re-verified by the scrubber",
+                                     [scrubber] { return static_cast<double>(scrubber->objects_verified()); });
+                metrics->add_counter("vault_scrub_bytes_total", "Bytes re-read by the scrubber",
+                                     [scrubber] { return static_cast<double>(scrubber->bytes_verified()); });
+                metrics->add_counter("vault_scrub_corrupt_total", "Corrupt files found by the scrubber",
+                                     [scrubber] { return static_cast<double>(scrubber->corrupt_found()); });
+                metrics->add_gauge("vault_scrub_last_pass_seconds", "Duration of the last complete scrubber pass",
+                                   [scrubber] { return scrubber->last_pass_seconds(); });
+            }
+            if (ChangeLog* change_log = options.change_log) 
+            {
+                metrics->add_gauge("vault_replication_head", "Newest change logged for replicas",
+                                   [change_log] { return static_cast<double>(change_log->head()); });
+            }
+            if (Replica* replica = options.replica) 
+            {
+                metrics->add_gauge("vault_replication_lag_seconds", "How far this replica may be behind its primary",
+                                   [replica] { return replica->lag_seconds(); });
+                metrics->add_gauge("vault_replication_applied", "Newest primary change applied here",
+                                   [replica] { return static_cast<double>(replica->applied()); });
+                metrics->add_gauge("vault_replication_primary_head", "Newest change the primary has logged",
+                                   [replica] { return static_cast<double>(replica->primary_head()); });
+                metrics->add_gauge("vault_replication_connected", "1 while the primary answers",
+                                   [replica] { return replica->connected() ? 1.0 : 0.0; });
+                metrics->add_counter("vault_replication_objects_total", "Objects copied from the primary",
+                                     [replica] { return static_cast<double>(replica->objects_fetched()); });
+                metrics->add_counter("vault_replication_bytes_total", "Bytes copied from the primary",
+                                     [replica] { return static_cast<double>(replica->bytes_fetched()); });
+                metrics->add_counter("vault_replication_snapshots_total", "Full resynchronisations with the primary",
+                                     [replica] { return static_cast<double>(replica->snapshots()); });
+            }
+            if (capture) 
+            {
+                metrics->add_counter("vault_capture_dropped_total", "Trace lines dropped because the writer fell behind",
+                                     [capture] { return static_cast<double>(capture->dropped()); });
+            }
+        }
+
+        // The logger runs after the response is written, which is the latency we want
+        routes.set_logger([&auth, metrics, capture](const httplib::Request& req, const httplib::Response& res,
+                                                    const RequestTiming& timing) 
+        {
+            auto start = timing.start;
+
+            // Streamed bodies have no res.body; their length is on the provider
+            std::uint64_t bytes_in = request_bytes(req, timing);
+            std::uint64_t bytes_out = res.body.size() + res.content_length_;
+
+            if (metrics) 
+            {
+                auto latency = start == std::chrono::steady_clock::time_point{}
+                    ? std::chrono::nanoseconds(0)
+                    : std::chrono::steady_clock::now() - start;
+
+                metrics->record(metrics->route_index(req.path), res.status,
+                                bytes_in, bytes_out, latency);
+            }
+            if (capture) 
+            {
+                capture_request(*capture, auth, req, res, start, bytes_in, bytes_out);
+            }
+        });
+    }
+
+    // ─── Conditional Requests ───────────────────────────────────────────────────
+
+    /// True if an If-None-Match list names `etag` (or is "*").
+    /// If-None-Match uses weak comparison, so a W/ prefix is ignored.
+    static bool etag_matches(const std::string& header, const std::string& etag) 
+    {
+        std::size_t pos = 0;
+        while (pos < header.size()) 
+        {
+            auto end = header.find(',', pos);
+            if (end == std::string::npos) end = header.size();
+
+            auto first = header.find_first_not_of(" \t", pos);
+            auto last = header.find_last_not_of(" \t", end - 1);
+            if (first != std::string::npos && first < end && last >= first) 
+            {
+                std::string_view tag(header.data() + first, last - first + 1);
+                if (tag == "*") return true;
+                if (tag.substr(0, 2) == "W/") tag.remove_prefix(2);
+                if (tag == etag) return true;
+            }
+            pos = end + 1;
+        }
+        return false;
+    }
+
+    /// Attach validators to `res` and answer 304 if the request's
+    /// preconditions show the client's copy is current. If-None-Match takes
+    /// precedence over If-Modified-Since. Returns true if a 304 was written.
+    static bool check_not_modified(const httplib::Request& req, httplib::Response& res,
+                                   const std::string& etag, std::int64_t modified) 
+    {
+        res.set_header("ETag", etag);
+        res.set_header("Cache-Control", "no-cache");
+        if (modified > 0) 
+        {
+            res.set_header("Last-Modified", utils::format_http_date(modified));
+        }
+
+        bool fresh = false;
+        if (req.has_header("If-None-Match")) 
+        {
+            fresh = etag_matches(req.get_header_value("If-None-Match"), etag);
+        } 
+        else if (modified > 0 && req.has_header("If-Modified-Since")) 
+        {
+            auto since = utils::parse_http_date(req.get_header_value("If-Modified-Since"));
+            fresh = since && modified <= *since;
+        }
+
+        if (!fresh) return false;
+        res.status = 304;
+        return true;
+    }
+
+    /// Listings differ per encoding, so each gets its own strong tag
+    static const char* encoding_tag(utils::Encoding encoding) 
+    {
+        switch (encoding) 
+        {
+            case utils::Encoding::Cbor:    return "cbor";
+            case utils::Encoding::Msgpack: return "msgpack";
+            case utils::Encoding::Json:    break;
+        }
+        return "json";
+    }
+
+    // ─── File Listing ───────────────────────────────────────────────────────────
+
+    /// Listings above this many entries are streamed with chunked encoding
+    static constexpr std::size_t kStreamListThreshold = 4096;
+
+    /// Entries serialized per chunk when streaming
+    static constexpr std::size_t kListChunkEntries = 1024;
+
+    static void write_file_meta(utils::StructuredWriter& writer, const models::FileMeta& f) 
+    {
+        writer.begin_object(3)
+              .field("filename", f.filename)
+              .field("size", f.size)
+              .field("uploaded_at", f.uploaded_at)
+              .end_object();
+    }
+
+    /// Serialize { "count": N, "files": [...], "success": true } without a DOM,
+    /// in the encoding the client negotiated. Small listings go straight into
+    /// the response body; large ones are produced a slice at a time so only
+    /// one chunk is ever buffered.
+    static void write_file_list(const httplib::Request& req, httplib::Response& res,
+                                std::vector<models::FileMeta> files) 
+    {
+        auto encoding = response_encoding(req);
         res.status = 200;
-        res.set_content(body.dump(), "application/json");
+
+        if (files.size() <= kStreamListThreshold) 
+        {
+            std::string body;
+            body.reserve(64 + files.size() * 96);
+
+            auto writer = utils::make_writer(encoding, body);
+            writer->begin_object(3).field("count", files.size()).key("files").begin_array(files.size());
+            for (const auto& f : files) 
+            {
+                write_file_meta(*writer, f);
+            }
+            writer->end_array().field("success", true).end_object();
+
+            res.set_content(std::move(body), utils::content_type(encoding));
+            return;
+        }
+
+        struct ListStream 
+        {
+            ListStream(std::vector<models::FileMeta> f, utils::Encoding encoding)
+                : files(std::move(f)), writer(utils::make_writer(encoding, buffer)) {}
+
+            std::vector<models::FileMeta> files;
+            std::size_t next = 0;
+            std::string buffer;
+            std::unique_ptr<utils::StructuredWriter> writer;
+        };
+
+        auto stream = std::make_shared<ListStream>(std::move(files), encoding);
+        res.set_chunked_content_provider(utils::content_type(encoding),
+            [stream](size_t, httplib::DataSink& sink) 
+        {
+            auto& s = *stream;
+            s.buffer.clear();
+
+            if (s.next == 0) 
+            {
+                s.writer->begin_object(3).field("count", s.files.size())
+                         .key("files").begin_array(s.files.size());
+            }
+
+            std::size_t end = std::min(s.files.size(), s.next + kListChunkEntries);
+            for (; s.next < end; ++s.next) 
+            {
+                write_file_meta(*s.writer, s.files[s.next]);
+            }
+
+            bool finished = s.next == s.files.size();
+            if (finished) 
+            {
+                s.writer->end_array().field("success", true).end_object();
+            }
+
+            if (!sink.write(s.buffer.data(), s.buffer.size())) return false;
+            if (finished) sink.done();
+            return true;
+        });
+    }
+
+    // ─── Batch Download ─────────────────────────────────────────────────────────
+
+    /// Bytes read from storage per provider call when streaming a download
+    static constexpr std::size_t kArchiveReadChunk = 256 * 1024;
+
+    /// Read exactly `size` bytes of a file being streamed. A short read
+    /// means it was truncated or replaced underneath us; a throw, that the
+    /// backend failed.
+    static bool read_stored(StorageBackend::Reader& in, char* data, std::size_t size,
+                            const std::string& filename) 
+    {
+        try 
+        {
+            if (in.read(data, size) == size) return true;
+            logging::warn("Routes", "Download aborted: " + filename + " changed while streaming");
+        } 
+        catch (const std::exception& e) 
+        {
+            logging::warn("Routes", "Download aborted: " + filename + ": " + e.what());
+        }
+        return false;
+    }
+
+    /// Stream the named files as one tar archive. The archive length is
+    /// known up front from the file sizes, so the client gets a
+    /// Content-Length, and each file is read from storage a chunk at a time
+    /// as the socket drains.
+    static void write_archive(httplib::Response& res, StorageManager& storage,
+                              const std::string& username,
+                              std::vector<models::FileMeta> files) 
+    {
+        struct ArchiveStream 
+        {
+            StorageManager* storage;
+            std::string username;
+            std::vector<models::FileMeta> files;
+            std::size_t next = 0;                  // index of the file being sent
+            std::unique_ptr<StorageBackend::Reader> in;   // open while its data is sent
+            std::uint64_t remaining = 0;           // data bytes left in the current file
+            std::string buffer;
+        };
+
+        std::uint64_t total = 2 * utils::kTarBlockSize;
+        for (const auto& f : files) 
+        {
+            total += utils::tar_entry_size(f.filename, f.size);
+        }
+
+        auto stream = std::make_shared<ArchiveStream>();
+        stream->storage = &storage;
+        stream->username = username;
+        stream->files = std::move(files);
+
+        res.status = 200;
+        res.set_header("Content-Disposition", "attachment; filename=\"vault.tar\"");
+        res.set_content_provider(total, "application/x-tar",
+            [stream](size_t, size_t, httplib::DataSink& sink) 
+        {
+            auto& s = *stream;
+            s.buffer.clear();
+
+            if (!s.in) 
+            {
+                if (s.next == s.files.size()) 
+                {
+                    auto trailer = utils::tar_end_of_archive();
+                    return sink.write(trailer.data(), trailer.size());
+                }
+
+                // Start the next entry with the size promised in Content-Length
+                const auto& f = s.files[s.next];
+                try 
+                {
+                    s.in = s.storage->open_file(s.username, f.filename);
+                } 
+                catch (const std::exception& e) 
+                {
+                    logging::warn("Routes", std::string("Batch download aborted: ") + e.what());
+                    return false;
+                }
+                // Rewritten since it was selected: neither the tar header nor
+                // Content-Length could be honoured, whether it grew or shrank
+                if (s.in->size() != f.size) 
+                {
+                    logging::warn("Routes", "Batch download aborted: " + f.filename + " changed while streaming");
+                    return false;
+                }
+                s.remaining = f.size;
+                s.buffer = utils::tar_entry_header(f.filename, f.size);
+            }
+
+            auto want = static_cast<std::size_t>(std::min<std::uint64_t>(s.remaining, kArchiveReadChunk));
+            if (want > 0) 
+            {
+                auto offset = s.buffer.size();
+                s.buffer.resize(offset + want);
+                // A short read leaves the framing impossible to honour
+                if (!read_stored(*s.in, s.buffer.data() + offset, want, s.files[s.next].filename)) 
+                {
+                    return false;
+                }
+                s.remaining -= want;
+            }
+
+            if (s.remaining == 0) 
+            {
+                s.buffer.append(utils::tar_padding(s.files[s.next].size), '\0');
+                s.in.reset();
+                ++s.next;
+            }
+
+            return sink.write(s.buffer.data(), s.buffer.size());
+        });
+    }
+
+    /// Stream one stored file as the response body in kArchiveReadChunk
+    /// pieces. The length comes from the open reader, so it matches what is
+    /// read even if the file is replaced meanwhile.
+    static void write_file(httplib::Response& res, std::unique_ptr<StorageBackend::Reader> in,
+                           const std::string& filename) 
+    {
+        auto size = in->size();
+
+        struct FileStream 
+        {
+            std::unique_ptr<StorageBackend::Reader> in;
+            std::string filename;
+            std::string buffer;
+        };
+        auto stream = std::make_shared<FileStream>();
+        stream->in = std::move(in);
+        stream->filename = filename;
+
+        res.status = 200;
+        res.set_header("Content-Disposition", "attachment; filename=\"" + filename + "\"");
+        res.set_content_provider(size, "application/octet-stream",
+            [stream](size_t, size_t length, httplib::DataSink& sink) 
+        {
+            auto& s = *stream;
+            s.buffer.resize(std::min(length, kArchiveReadChunk));
+            if (!read_stored(*s.in, s.buffer.data(), s.buffer.size(), s.filename)) return false;
+            return sink.write(s.buffer.data(), s.buffer.size());
+        });
+    }
+
+    /// Resolve a batch request body — { "files": [...] } or { "prefix": "..." } —
+    /// to the stored files it names. Unknown names are reported in `missing`.
+    static std::vector<models::FileMeta> select_batch(StorageManager& storage,
+                                                      const std::string& username,
+                                                      const json& body,
+                                                      std::vector<std::string>& missing) 
+    {
+        std::vector<models::FileMeta> selected;
+
+        if (body.contains("files")) 
+        {
+            for (const auto& item : body.at("files")) 
+            {
+                auto name = item.get<std::string>();
+                if (name.empty() || name != utils::extract_filename(name) || name == "..") 
+                {
+                    missing.push_back(name);
+                    continue;
+                }
+                if (name.find(".enc") == std::string::npos) name += ".enc";
+
+                try 
+                {
+                    auto size = static_cast<std::size_t>(storage.file_size(username, name));
+                    selected.push_back({name, size, ""});
+                } 
+                catch (const std::exception&) 
+                {
+                    missing.push_back(name);
+                }
+            }
+            return selected;
+        }
+
+        std::string prefix = body.value("prefix", "");
+        for (auto& f : storage.list_files(username)) 
+        {
+            if (f.filename.compare(0, prefix.size(), prefix) == 0) 
+            {
+                selected.push_back(std::move(f));
+            }
+        }
+        return selected;
+    }
+
+    // ─── Replication ────────────────────────────────────────────────────────────
+
+    /// Entries handed to a replica per poll, at most
+    static constexpr std::size_t kMaxChangeBatch = 4096;
+
+    /// Longest a replica's poll may wait for a change; bounds how long a
+    /// shutdown waits on a parked poll
+    static constexpr long kMaxPollWaitSeconds = 10;
+
+    /// On a replica, refuse a write and name the server that takes it.
+    /// Returns true if a 403 was written.
+    static bool refuse_on_replica(const httplib::Request& req, httplib::Response& res,
+                                  const Replica* replica) 
+    {
+        if (!replica) return false;
+        send_error(req, res, 403, "Read-only replica; send writes to " + replica->primary());
+        return true;
+    }
+
+    /// Replicas present the shared secret. Returns true if a 401 was written.
+    static bool reject_replica(const httplib::Request& req, httplib::Response& res,
+                               const std::string& secret) 
+    {
+        // SECURITY: The secret unlocks every user's data; compare without a timing leak
+        if (!crypto::constant_time_equal(req.get_header_value("X-Replication-Secret"), secret)) 
+        {
+            send_error(req, res, 401, "Replication secret required");
+            return true;
+        }
+        return false;
+    }
+
+    static json change_json(const ChangeLog::Entry& entry) 
+    {
+        json j = {{"seq", entry.seq}, {"time", entry.time_ms}, {"user", entry.username}};
+        if (entry.kind == ChangeLog::Entry::Kind::User) 
+        {
+            // SECURITY: Salted hashes only, as in users.dat
+            j["type"] = "user";
+            j["password_hash"] = entry.password_hash;
+            j["salt"] = entry.salt;
+        } 
+        else 
+        {
+            j["type"] = "object";
+            j["file"] = entry.filename;
+            j["sha256"] = entry.sha256;
+            j["size"] = entry.size;
+        }
+        return j;
+    }
+
+    /// The log can't continue from where the replica is; it must resync
+    static void send_log_gone(const httplib::Request& req, httplib::Response& res, const ChangeLog& log) 
+    {
+        send_json(req, res, 410, {{"success", false},
+                                  {"message", "Change log does not reach back that far; take a snapshot"},
+                                  {"epoch", log.epoch()},
+                                  {"head", log.head()}});
+    }
+
+    /// GET /replication/log, /replication/snapshot and /replication/object
+    static void setup_replication_routes(RouteRegistrar& routes,
+                                         AuthManager& auth,
+                                         StorageManager& storage,
+                                         ChangeLog& log,
+                                         const std::string& secret) 
+    {
+        // ?epoch=<log epoch>&after=<seq>&limit=<n>&wait=<seconds>
+        routes.get("/replication/log", [&log, secret](const httplib::Request& req,
+                                                      httplib::Response& res) 
+        {
+            if (reject_replica(req, res, secret)) return;
+
+            std::uint64_t after = 0;
+            std::size_t limit = 512;
+            long wait = 0;
+            try 
+            {
+                after = std::stoull(req.get_param_value("after"));
+                if (req.has_param("limit")) limit = static_cast<std::size_t>(std::stoull(req.get_param_value("limit")));
+                if (req.has_param("wait")) wait = std::stol(req.get_param_value("wait"));
+            } 
+            catch (const std::exception&) 
+            {
+                send_error(req, res, 400, "Numeric after, limit and wait parameters expected");
+                return;
+            }
+
+            if (req.get_param_value("epoch") != log.epoch()) 
+            {
+                send_log_gone(req, res, log);
+                return;
+            }
+
+            // PERF: Holds this worker until a change arrives or the wait runs out
+            auto entries = log.read(after, std::clamp<std::size_t>(limit, 1, kMaxChangeBatch),
+                                    std::chrono::seconds(std::clamp<long>(wait, 0, kMaxPollWaitSeconds)));
+            if (!entries) 
+            {
+                send_log_gone(req, res, log);
+                return;
+            }
+
+            json changes = json::array();
+            for (const auto& entry : *entries) 
+            {
+                changes.push_back(change_json(entry));
+            }
+            send_ok(req, res, {{"epoch", log.epoch()}, {"head", log.head()}, {"entries", std::move(changes)}});
+        });
+
+        // Every user and object, as of change `head`; a replica tails the log from there
+        routes.get("/replication/snapshot", [&auth, &storage, &log, secret](const httplib::Request& req,
+                                                                            httplib::Response& res) 
+        {
+            if (reject_replica(req, res, secret)) return;
+
+            // Read first: anything logged later is replayed on top of the snapshot
+            auto head = log.head();
+
+            json users = json::array();
+            for (const auto& user : auth.users()) 
+            {
+                users.push_back({{"username", user.username},
+                                 {"password_hash", user.password_hash},
+                                 {"salt", user.salt}});
+            }
+
+            json objects = json::array();
+            try 
+            {
+                for (const auto& [username, filename] : storage.stored_objects()) 
+                {
+                    auto info = storage.object_info(username, filename);
+                    if (!info) continue;
+                    objects.push_back({{"user", username}, {"file", filename},
+                                       {"sha256", info->sha256}, {"size", info->size}});
+                }
+            } 
+            catch (const std::exception& e) 
+            {
+                send_error(req, res, 500, std::string("Cannot list storage: ") + e.what());
+                return;
+            }
+
+            send_ok(req, res, {{"epoch", log.epoch()}, {"head", head},
+                               {"users", std::move(users)}, {"objects", std::move(objects)}});
+        });
+
+        // ?user=<username>&file=<stored filename>: the object's current bytes
+        routes.get("/replication/object", [&storage, secret](const httplib::Request& req,
+                                                             httplib::Response& res) 
+        {
+            if (reject_replica(req, res, secret)) return;
+
+            std::string username = req.get_param_value("user");
+            std::string filename = req.get_param_value("file");
+            if (username.empty() || username != utils::extract_filename(username) || username == ".." ||
+                filename.empty() || filename != utils::extract_filename(filename) || filename == "..") 
+            {
+                send_error(req, res, 400, "Plain user and file parameters are required");
+                return;
+            }
+
+            try 
+            {
+                write_file(res, storage.open_file(username, filename), filename);
+            } 
+            catch (const std::exception& e) 
+            {
+                send_error(req, res, 404, std::string("File not found: ") + e.what());
+            }
+        });
     }
 
     void setup_routes(httplib::Server& server,
                       AuthManager& auth,
-                      StorageManager& storage) 
+                      StorageManager& storage,
+                      const RouteOptions& options) 
     {
-        server.Post("/register", [&auth](const httplib::Request& req,
-                                          httplib::Response& res) 
+        HttplibRegistrar routes(server);
+        setup_routes(routes, auth, storage, options);
+    }
+
+    void setup_routes(RouteRegistrar& routes,
+                      AuthManager& auth,
+                      StorageManager& storage,
+                      const RouteOptions& options) 
+    {
+        setup_middleware(routes, auth, storage, options);
+
+        // Listing generations restart at zero with the process; the boot id
+        // keeps tags from a previous run from matching. It is per process,
+        // not per server, so every listener hands out the same tags.
+        static const std::string boot_id = crypto::generate_token().substr(0, 12);
+
+        routes.post("/register", [&auth, replica = options.replica](const httplib::Request& req,
+                                                                     httplib::Response& res) 
         {
+            if (refuse_on_replica(req, res, replica)) return;
+
             try 
             {
-                auto body = json::parse(req.body);
+                auto body = parse_body(req);
                 std::string username = body.value("username", "");
                 std::string password = body.value("password", "");
 
                 if (username.empty() || password.empty()) 
                 {
-                    json_error(res, 400, "Username and password are required");
+                    send_error(req, res, 400, "Username and password are required");
                     return;
                 }
 
                 if (username.size() < 3 || password.size() < 4) 
                 {
-                    json_error(res, 400, "Username (min 3) and password (min 4) too short");
+                    send_error(req, res, 400, "Username (min 3) and password (min 4) too short");
                     return;
                 }
 
                 if (auth.register_user(username, password)) 
                 {
-                    json_ok(res, {{"message", "User registered successfully"}});
+                    send_ok(req, res, {{"message", "User registered successfully"}});
                 } 
                 else 
                 {
-                    json_error(res, 409, "Username already exists");
+                    send_error(req, res, 409, "Username already exists");
                 }
             } 
+            catch (const AuthBusyError& e) 
+            {
+                send_busy(req, res, e);
+            }
             catch (const std::exception& e) 
             {
-                json_error(res, 400, std::string("Invalid request: ") + e.what());
+                send_error(req, res, 400, std::string("Invalid request: ") + e.what());
             }
         });
 
-        server.Post("/login", [&auth](const httplib::Request& req,
+        routes.post("/login", [&auth](const httplib::Request& req,
                                        httplib::Response& res) {
             try 
             {
-                auto body = json::parse(req.body);
+                auto body = parse_body(req);
                 std::string username = body.value("username", "");
                 std::string password = body.value("password", "");
 
                 auto token = auth.login(username, password);
                 if (token) 
                 {
-                    json_ok(res, {{"token", *token}, {"message", "Login successful"}});
+                    send_ok(req, res, {{"token", *token}, {"message", "Login successful"}});
                 } 
                 else 
                 {
-                    json_error(res, 401, "Invalid username or password");
+                    send_error(req, res, 401, "Invalid username or password");
                 }
             } 
+            catch (const AuthBusyError& e) 
+            {
+                send_busy(req, res, e);
+            }
             catch (const std::exception& e) 
             {
-                json_error(res, 400, std::string("Invalid request: ") + e.what());
+                send_error(req, res, 400, std::string("Invalid request: ") + e.what());
             }
         });
 
-        server.Post("/upload", [&auth, &storage](const httplib::Request& req,
-                                                  httplib::Response& res) 
+        routes.post("/upload", [&auth, &storage, replica = options.replica](const httplib::Request& req,
+                                                                             httplib::Response& res) 
         {
+            if (refuse_on_replica(req, res, replica)) return;
+
             // Authenticate
             std::string token = extract_token(req);
             auto username = auth.validate_token(token);
             if (!username) 
             {
-                json_error(res, 401, "Unauthorized — please login first");
+                send_error(req, res, 401, "Unauthorized — please login first");
                 return;
             }
 
-            // Extract file from multipart form data
-            auto it = req.files.find("file");
-            if (it == req.files.end()) 
+            // Every multipart part named "file" is one upload
+            auto [first, last] = req.files.equal_range("file");
+            if (first == last) 
             {
-                json_error(res, 400, "No file provided");
+                send_error(req, res, 400, "No file provided");
                 return;
             }
 
-            const auto& file = it->second;
-            std::string filename = file.filename;
-            if (filename.empty()) 
+            // Validate up front; only plain, distinct names reach the disk.
+            // Distinct means distinct once stored: "a" and "a.enc" are one
+            // object, and the pool must not write it twice at once.
+            std::vector<StorageManager::PendingFile> pending;
+            json results = json::array();
+            std::vector<std::size_t> result_index;
+            std::unordered_set<std::string> seen;
+            for (auto it = first; it != last; ++it) 
             {
-                json_error(res, 400, "Filename is empty");
-                return;
+                const auto& file = it->second;
+                std::string stored_name = file.filename.find(".enc") == std::string::npos
+                                              ? file.filename + ".enc" : file.filename;
+                const char* problem = nullptr;
+                if (file.filename.empty()) 
+                {
+                    problem = "Filename is empty";
+                } 
+                else if (file.filename != utils::extract_filename(file.filename) || file.filename == "..") 
+                {
+                    problem = "Filename must not contain a path";
+                } 
+                else if (!seen.insert(stored_name).second) 
+                {
+                    problem = "Duplicate filename in request";
+                }
+
+                results.push_back({{"filename", stored_name},
+                                   {"success", problem == nullptr},
+                                   {"message", problem ? problem : "File uploaded successfully"}});
+                if (!problem) 
+                {
+                    pending.push_back({file.filename, file.content});
+                    result_index.push_back(results.size() - 1);
+                }
             }
 
             // Store the encrypted file data (client encrypts before sending)
-            std::vector<uint8_t> data(file.content.begin(), file.content.end());
-            if (storage.store_file(*username, filename, data)) 
+            auto stored = storage.store_files(*username, pending);
+
+            std::size_t ok = 0;
+            for (std::size_t i = 0; i < stored.size(); ++i) 
             {
-                json_ok(res, {{"message", "File uploaded successfully"},
-                              {"filename", filename + ".enc"}});
-            } 
-            else 
+                if (stored[i]) 
+                {
+                    ++ok;
+                    continue;
+                }
+                auto& r = results[result_index[i]];
+                r["success"] = false;
+                r["message"] = "Failed to store file";
+            }
+
+            std::size_t total = results.size();
+            if (total == 1) 
             {
-                json_error(res, 500, "Failed to store file");
+                // Single-part uploads keep their original response shape
+                const auto& r = results[0];
+                if (ok == 1) 
+                {
+                    send_ok(req, res, {{"message", r["message"]}, {"filename", r["filename"]}});
+                } 
+                else 
+                {
+                    send_error(req, res, pending.empty() ? 400 : 500, r["message"].get<std::string>());
+                }
+                return;
             }
+
+            json body = 
+            {
+                {"success", ok == total},
+                {"message", std::to_string(ok) + " of " + std::to_string(total) + " files uploaded"},
+                {"stored", ok},
+                {"failed", total - ok},
+                {"results", std::move(results)},
+            };
+
+            // 207: the batch was processed but some parts failed
+            send_json(req, res, ok == total ? 200 : ok == 0 ? 500 : 207, body);
         });
 
-        server.Get("/download", [&auth, &storage](const httplib::Request& req,
+        // Raw-body upload for data that arrives as a stream (e.g. a pipe):
+        // PUT /upload?filename=<name> with the encrypted bytes as the body,
+        // usually chunked. It goes straight to disk as it is received.
+        routes.put("/upload", [&auth, &storage, replica = options.replica](const httplib::Request& req,
+                                                                            httplib::Response& res,
+                                                                            const httplib::ContentReader& content_reader) 
+        {
+            if (refuse_on_replica(req, res, replica)) return;
+
+            // Authenticate
+            std::string token = extract_token(req);
+            auto username = auth.validate_token(token);
+            if (!username) 
+            {
+                send_error(req, res, 401, "Unauthorized — please login first");
+                return;
+            }
+
+            std::string filename = req.get_param_value("filename");
+            if (filename.empty() || filename != utils::extract_filename(filename) || filename == "..") 
+            {
+                send_error(req, res, 400, "A plain filename parameter is required");
+                return;
+            }
+
+            auto writer = storage.open_writer(*username, filename);
+            if (!writer) 
+            {
+                send_error(req, res, 500, "Failed to store file");
+                return;
+            }
+
+            bool received = content_reader([&writer](const char* data, size_t length) 
+            {
+                return writer->write(data, length);
+            });
+            if (!received || !writer->commit()) 
+            {
+                // The writer's destructor discards the partial upload
+                send_error(req, res, 500, "Failed to store file");
+                return;
+            }
+
+            std::string stored = filename.find(".enc") == std::string::npos ? filename + ".enc" : filename;
+            send_ok(req, res, {{"message", "File uploaded successfully"},
+                               {"filename", stored},
+                               {"size", writer->size()}});
+        });
+
+        routes.get("/download", [&auth, &storage](const httplib::Request& req,
                                                    httplib::Response& res) 
         {
             // Authenticate
@@ -151,65 +1171,145 @@ namespace vault::server
             auto username = auth.validate_token(token);
             if (!username) 
             {
-                json_error(res, 401, "Unauthorized — please login first");
+                send_error(req, res, 401, "Unauthorized — please login first");
                 return;
             }
 
             // Get filename from query parameter
             std::string filename = req.get_param_value("filename");
-            if (filename.empty()) 
+            if (filename.empty() || filename != utils::extract_filename(filename) || filename == "..") 
+            {
+                send_error(req, res, 400, "A plain filename parameter is required");
+                return;
+            }
+
+            // PERF: The content hash was recorded at write time, so a
+            // revalidation is answered from memory without opening the file
+            auto info = storage.object_info(*username, filename);
+            if (!info) 
+            {
+                send_error(req, res, 404, "File not found: " + filename);
+                return;
+            }
+            if (check_not_modified(req, res, "\"" + info->sha256 + "\"", info->modified)) 
             {
-                json_error(res, 400, "Filename parameter is required");
                 return;
             }
 
+            // The hash recorded at write time (RFC 9530), so the client can
+            // tell a damaged copy from a wrong password
+            res.set_header("Repr-Digest", "sha-256=:" + crypto::hex_to_base64(info->sha256) + ":");
+            if (storage.is_corrupt(*username, filename)) 
+            {
+                logging::warn("Storage", "Serving " + *username + "/" + filename + ", which failed verification");
+            }
+
+            // PERF: Streamed from storage, so memory stays flat whatever the file size
             try 
             {
-                auto data = storage.retrieve_file(*username, filename);
-                res.status = 200;
-                res.set_content(std::string(data.begin(), data.end()),
-                               "application/octet-stream");
-                res.set_header("Content-Disposition",
-                              "attachment; filename=\"" + filename + "\"");
+                write_file(res, storage.open_file(*username, filename), filename);
             } 
             catch (const std::exception& e) 
             {
-                json_error(res, 404, std::string("File not found: ") + e.what());
+                send_error(req, res, 404, std::string("File not found: ") + e.what());
             }
         });
 
-        server.Get("/list", [&auth, &storage](const httplib::Request& req,
-                                               httplib::Response& res) 
+        routes.post("/download-batch", [&auth, &storage](const httplib::Request& req,
+                                                          httplib::Response& res) 
         {
             // Authenticate
             std::string token = extract_token(req);
             auto username = auth.validate_token(token);
             if (!username) 
             {
-                json_error(res, 401, "Unauthorized — please login first");
+                send_error(req, res, 401, "Unauthorized — please login first");
                 return;
             }
 
-            auto files = storage.list_files(*username);
-            json file_list = json::array();
-            for (const auto& f : files) 
+            std::vector<models::FileMeta> files;
+            std::vector<std::string> missing;
+            try 
             {
-                file_list.push_back
-                ({
-                    {"filename", f.filename},
-                    {"size", f.size},
-                    {"uploaded_at", f.uploaded_at}
-                });
+                files = select_batch(storage, *username, parse_body(req), missing);
+            } 
+            catch (const std::exception& e) 
+            {
+                send_error(req, res, 400, std::string("Invalid request: ") + e.what());
+                return;
             }
 
-            json_ok(res, {{"files", file_list}, {"count", files.size()}});
+            // All-or-nothing: a partial archive would look like a successful restore
+            if (!missing.empty()) 
+            {
+                send_error(req, res, 404, "File not found: " + missing.front() +
+                           (missing.size() > 1 ? " (and " + std::to_string(missing.size() - 1) + " more)" : ""));
+                return;
+            }
+
+            write_archive(res, storage, *username, std::move(files));
         });
 
-        server.Get("/health", [](const httplib::Request&, httplib::Response& res) 
+        routes.get("/list", [&auth, &storage](const httplib::Request& req,
+                                      httplib::Response& res) 
         {
-            json_ok(res, {{"status", "running"}});
+            // Authenticate
+            std::string token = extract_token(req);
+            auto username = auth.validate_token(token);
+            if (!username) 
+            {
+                send_error(req, res, 401, "Unauthorized — please login first");
+                return;
+            }
+
+            // The generation is read before scanning, so a write racing the
+            // scan yields an older tag and the next request refetches
+            auto listing = storage.listing_info(*username);
+            std::string etag = "\"" + boot_id + "-" + std::to_string(listing.generation) + "-" +
+                               encoding_tag(response_encoding(req)) + "\"";
+            res.set_header("Vary", "Accept");
+            if (check_not_modified(req, res, etag, listing.modified)) 
+            {
+                return;
+            }
+
+            write_file_list(req, res, storage.list_files(*username));
         });
 
-        std::cout << "[Routes] All API endpoints registered\n";
+        routes.get("/health", [change_log = options.change_log, replica = options.replica](const httplib::Request& req,
+                                                                                             httplib::Response& res) 
+        {
+            json body = {{"status", "running"}};
+            if (replica) 
+            {
+                body["replication"] = {{"role", "replica"},
+                                       {"primary", replica->primary()},
+                                       {"connected", replica->connected()},
+                                       {"applied", replica->applied()},
+                                       {"primary_head", replica->primary_head()},
+                                       {"lag_seconds", replica->lag_seconds()}};
+            } 
+            else if (change_log) 
+            {
+                body["replication"] = {{"role", "primary"}, {"head", change_log->head()}};
+            }
+            send_ok(req, res, body);
+        });
+
+        if (options.change_log) 
+        {
+            setup_replication_routes(routes, auth, storage, *options.change_log, options.replication_secret);
+        }
+
+        if (options.metrics) 
+        {
+            routes.get("/metrics", [metrics = options.metrics](const httplib::Request&,
+                                                               httplib::Response& res) 
+            {
+                res.set_content(metrics->render(), "text/plain; version=0.0.4");
+            });
+        }
+
+        logging::info("Routes", "All API endpoints registered");
     }
 }
\ No newline at end of file
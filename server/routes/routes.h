@@ -1,13 +1,40 @@
 #pragma once
 
 #include "auth/auth_manager.h"
+#include "capture/request_capture.h"
+#include "core/route_registrar.h"
+#include "replication/change_log.h"
+#include "replication/replica.h"
+#include "storage/scrubber.h"
 #include "storage/storage_manager.h"
+#include "routes/rate_limiter.h"
+#include "metrics/metrics.h"
 #include <httplib.h>
 
 namespace vault::server 
 {
+/// Optional services wired into the route layer. Null members are disabled.
+struct RouteOptions
+{
+    RateLimiter* rate_limiter = nullptr;
+    Metrics* metrics = nullptr;     // also serves GET /metrics
+    RequestCapture* capture = nullptr;
+    Scrubber* scrubber = nullptr;   // only reported through metrics
+    ChangeLog* change_log = nullptr;   // primary: serves /replication/* to replicas
+    Replica* replica = nullptr;        // replica: refuses writes, reports its lag
+    std::string replication_secret;    // replicas must present it to /replication/*
+};
+
+/// Register every endpoint with whichever server core `routes` fronts
+void setup_routes(RouteRegistrar& routes,
+                  AuthManager& auth,
+                  StorageManager& storage,
+                  const RouteOptions& options = {});
+
+/// Same, on a thread-per-connection httplib::Server
 void setup_routes(httplib::Server& server,
                   AuthManager& auth,
-                  StorageManager& storage);
+                  StorageManager& storage,
+                  const RouteOptions& options = {});
 
 }
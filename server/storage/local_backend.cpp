@@ -0,0 +1,231 @@
+#include "storage/local_backend.h"
+#include "crypto/crypto.h"
+#include "logging/logger.h"
+
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+
+namespace vault::server
+{
+    /// Hidden directory holding a writer's temporary file until commit
+    static constexpr const char* kPartialDir = ".partial";
+
+    static std::int64_t to_unix_time(std::filesystem::file_time_type ftime)
+    {
+        auto sctp = std::chrono::time_point_cast<std::chrono::system_clock::duration>
+        (
+            ftime - std::filesystem::file_time_type::clock::now()
+            + std::chrono::system_clock::now()
+        );
+        return std::chrono::system_clock::to_time_t(sctp);
+    }
+
+    // ─── Reader / Writer ────────────────────────────────────────────────────────
+
+    namespace
+    {
+        class LocalReader : public StorageBackend::Reader
+        {
+        public:
+            explicit LocalReader(const std::filesystem::path& path)
+                : in_(path, std::ios::binary)
+            {
+                // The length comes from the open handle, so it matches what
+                // is read even if the file is replaced meanwhile
+                if (in_.is_open())
+                {
+                    in_.seekg(0, std::ios::end);
+                    size_ = static_cast<std::uint64_t>(in_.tellg());
+                    in_.seekg(0, std::ios::beg);
+                }
+            }
+
+            bool is_open() const { return in_.is_open(); }
+
+            std::uint64_t size() const override { return size_; }
+
+            std::size_t read(char* data, std::size_t size) override
+            {
+                in_.read(data, static_cast<std::streamsize>(size));
+                if (in_.bad()) throw std::runtime_error("Read failed");
+                return static_cast<std::size_t>(in_.gcount());
+            }
+
+        private:
+            std::ifstream in_;
+            std::uint64_t size_ = 0;
+        };
+
+        class LocalWriter : public StorageBackend::Writer
+        {
+        public:
+            LocalWriter(std::filesystem::path target, std::filesystem::path temp)
+                : target_(std::move(target)),
+                  temp_(std::move(temp)),
+                  out_(temp_, std::ios::binary | std::ios::trunc)
+            {
+            }
+
+            ~LocalWriter() override
+            {
+                if (!committed_)
+                {
+                    out_.close();
+                    std::error_code ec;
+                    std::filesystem::remove(temp_, ec);
+                }
+            }
+
+            bool is_open() const { return out_.is_open(); }
+
+            bool write(const char* data, std::size_t size) override
+            {
+                if (!out_) return false;
+                out_.write(data, static_cast<std::streamsize>(size));
+                return static_cast<bool>(out_);
+            }
+
+            bool commit() override
+            {
+                if (committed_ || !out_) return false;
+                out_.close();
+                if (!out_)
+                {
+                    logging::error("Storage", "Write failed: " + temp_.string());
+                    return false;
+                }
+
+                std::error_code ec;
+                std::filesystem::rename(temp_, target_, ec);
+                if (ec)
+                {
+                    logging::error("Storage", "Cannot publish " + target_.string() + ": " + ec.message());
+                    return false;
+                }
+                committed_ = true;
+                return true;
+            }
+
+        private:
+            std::filesystem::path target_;
+            std::filesystem::path temp_;
+            std::ofstream out_;
+            bool committed_ = false;
+        };
+    }
+
+    // ─── LocalBackend ───────────────────────────────────────────────────────────
+
+    LocalBackend::LocalBackend(const std::filesystem::path& root)
+        : root_(root)
+    {
+        std::filesystem::create_directories(root_);
+
+        // Writes cut short by a crash or restart. Keys are shallow
+        // ("<user>/<file>", "<user>/.meta/<file>"), so only the first three
+        // levels can hold one.
+        std::error_code ec;
+        for (auto it = std::filesystem::recursive_directory_iterator(root_, ec);
+             it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+        {
+            if (ec) break;
+            if (!it->is_directory()) continue;
+            if (it->path().filename() == kPartialDir)
+            {
+                it.disable_recursion_pending();
+                std::filesystem::remove_all(it->path(), ec);
+            }
+            else if (it.depth() >= 2)
+            {
+                it.disable_recursion_pending();
+            }
+        }
+    }
+
+    std::unique_ptr<StorageBackend::Reader> LocalBackend::open_read(const std::string& key)
+    {
+        auto reader = std::make_unique<LocalReader>(path_of(key));
+        if (!reader->is_open()) return nullptr;
+        return reader;
+    }
+
+    std::unique_ptr<StorageBackend::Writer> LocalBackend::open_write(const std::string& key)
+    {
+        // On the target's filesystem, so commit is a rename
+        auto target = path_of(key);
+        auto temp = target.parent_path() / kPartialDir /
+                    (target.filename().string() + "." + crypto::generate_token().substr(0, 16));
+
+        std::error_code ec;
+        std::filesystem::create_directories(temp.parent_path(), ec);
+
+        auto writer = std::make_unique<LocalWriter>(target, temp);
+        if (!writer->is_open())
+        {
+            logging::error("Storage", "Cannot open file for writing: " + temp.string());
+            return nullptr;
+        }
+        return writer;
+    }
+
+    std::optional<StorageBackend::Stat> LocalBackend::stat(const std::string& key)
+    {
+        auto path = path_of(key);
+        std::error_code ec;
+        auto size = std::filesystem::file_size(path, ec);
+        if (ec) return std::nullopt;
+        auto modified = std::filesystem::last_write_time(path, ec);
+        return Stat{size, ec ? 0 : to_unix_time(modified)};
+    }
+
+    std::vector<StorageBackend::Entry> LocalBackend::list(const std::string& prefix, bool recursive)
+    {
+        std::vector<Entry> entries;
+
+        // Walk only the directory the prefix points into
+        auto slash = prefix.rfind('/');
+        auto start = slash == std::string::npos ? root_ : root_ / prefix.substr(0, slash);
+
+        std::error_code ec;
+        if (!std::filesystem::is_directory(start, ec)) return entries;
+
+        auto add = [&](const std::filesystem::directory_entry& entry)
+        {
+            if (!entry.is_regular_file()) return;
+            auto key = entry.path().lexically_relative(root_).generic_string();
+            if (key.compare(0, prefix.size(), prefix) != 0) return;
+            entries.push_back({std::move(key), Stat{entry.file_size(), to_unix_time(entry.last_write_time())}});
+        };
+
+        if (!recursive)
+        {
+            for (const auto& entry : std::filesystem::directory_iterator(start, ec))
+            {
+                add(entry);
+            }
+            return entries;
+        }
+
+        for (auto it = std::filesystem::recursive_directory_iterator(start, ec);
+             it != std::filesystem::recursive_directory_iterator(); it.increment(ec))
+        {
+            if (ec) break;
+            if (it->is_directory() && it->path().filename() == kPartialDir)
+            {
+                it.disable_recursion_pending();
+                continue;
+            }
+            add(*it);
+        }
+        return entries;
+    }
+
+    bool LocalBackend::remove(const std::string& key)
+    {
+        std::error_code ec;
+        std::filesystem::remove(path_of(key), ec);
+        return !ec;
+    }
+
+}
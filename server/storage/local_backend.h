@@ -0,0 +1,34 @@
+#pragma once
+
+#include "storage/storage_backend.h"
+
+#include <filesystem>
+
+namespace vault::server
+{
+    /// Objects as files under a root directory; a key is a relative path.
+    ///
+    /// Every write, buffered or streamed, goes to a temporary file in a
+    /// hidden `.partial` directory beside the target and is renamed over the
+    /// target on commit, so a reader never sees a half-written file.
+    /// Leftovers from a crash are removed at startup.
+    class LocalBackend : public StorageBackend
+    {
+    public:
+        explicit LocalBackend(const std::filesystem::path& root);
+
+        std::string describe() const override { return root_.string(); }
+
+        std::unique_ptr<Reader> open_read(const std::string& key) override;
+        std::unique_ptr<Writer> open_write(const std::string& key) override;
+        std::optional<Stat> stat(const std::string& key) override;
+        std::vector<Entry> list(const std::string& prefix, bool recursive) override;
+        bool remove(const std::string& key) override;
+
+    private:
+        std::filesystem::path path_of(const std::string& key) const { return root_ / key; }
+
+        std::filesystem::path root_;
+    };
+
+}
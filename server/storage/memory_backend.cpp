@@ -0,0 +1,124 @@
+#include "storage/memory_backend.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+
+namespace vault::server
+{
+    namespace
+    {
+        class MemoryReader : public StorageBackend::Reader
+        {
+        public:
+            explicit MemoryReader(std::shared_ptr<const MemoryBackend::Object> object)
+                : object_(std::move(object))
+            {
+            }
+
+            std::uint64_t size() const override { return object_->data.size(); }
+
+            std::size_t read(char* data, std::size_t size) override
+            {
+                auto n = std::min(size, object_->data.size() - offset_);
+                std::memcpy(data, object_->data.data() + offset_, n);
+                offset_ += n;
+                return n;
+            }
+
+        private:
+            std::shared_ptr<const MemoryBackend::Object> object_;
+            std::size_t offset_ = 0;
+        };
+
+        class MemoryWriter : public StorageBackend::Writer
+        {
+        public:
+            using Publish = std::function<void(std::string)>;
+
+            explicit MemoryWriter(Publish publish) : publish_(std::move(publish)) {}
+
+            bool write(const char* data, std::size_t size) override
+            {
+                if (committed_) return false;
+                data_.append(data, size);
+                return true;
+            }
+
+            bool commit() override
+            {
+                if (committed_) return false;
+                committed_ = true;
+                publish_(std::move(data_));
+                return true;
+            }
+
+        private:
+            Publish publish_;
+            std::string data_;
+            bool committed_ = false;
+        };
+    }
+
+    void MemoryBackend::publish(const std::string& key, std::string data)
+    {
+        auto object = std::make_shared<Object>();
+        object->data = std::move(data);
+        object->modified = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        objects_[key] = std::move(object);
+    }
+
+    std::unique_ptr<StorageBackend::Reader> MemoryBackend::open_read(const std::string& key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = objects_.find(key);
+        if (it == objects_.end()) return nullptr;
+        return std::make_unique<MemoryReader>(it->second);
+    }
+
+    std::unique_ptr<StorageBackend::Writer> MemoryBackend::open_write(const std::string& key)
+    {
+        return std::make_unique<MemoryWriter>([this, key](std::string data)
+        {
+            publish(key, std::move(data));
+        });
+    }
+
+    bool MemoryBackend::put(const std::string& key, const char* data, std::size_t size)
+    {
+        publish(key, std::string(data, size));
+        return true;
+    }
+
+    std::optional<StorageBackend::Stat> MemoryBackend::stat(const std::string& key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = objects_.find(key);
+        if (it == objects_.end()) return std::nullopt;
+        return Stat{it->second->data.size(), it->second->modified};
+    }
+
+    std::vector<StorageBackend::Entry> MemoryBackend::list(const std::string& prefix, bool recursive)
+    {
+        std::vector<Entry> entries;
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = objects_.lower_bound(prefix);
+             it != objects_.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it)
+        {
+            if (!recursive && it->first.find('/', prefix.size()) != std::string::npos) continue;
+            entries.push_back({it->first, Stat{it->second->data.size(), it->second->modified}});
+        }
+        return entries;
+    }
+
+    bool MemoryBackend::remove(const std::string& key)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        objects_.erase(key);
+        return true;
+    }
+
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "storage/storage_backend.h"
+
+#include <map>
+#include <mutex>
+
+namespace vault::server
+{
+    /// Objects held in process memory and lost on exit. For benchmarks and
+    /// tests: it isolates the server from disk and network, so the cost of
+    /// another backend is the difference in throughput against this one.
+    ///
+    /// Objects are immutable once committed and readers hold a reference to
+    /// the one they opened, so a replace never disturbs a download.
+    class MemoryBackend : public StorageBackend
+    {
+    public:
+        std::string describe() const override { return "memory"; }
+
+        std::unique_ptr<Reader> open_read(const std::string& key) override;
+        std::unique_ptr<Writer> open_write(const std::string& key) override;
+        bool put(const std::string& key, const char* data, std::size_t size) override;
+        std::optional<Stat> stat(const std::string& key) override;
+        std::vector<Entry> list(const std::string& prefix, bool recursive) override;
+        bool remove(const std::string& key) override;
+
+        struct Object
+        {
+            std::string data;
+            std::int64_t modified = 0;
+        };
+
+    private:
+        void publish(const std::string& key, std::string data);
+
+        mutable std::mutex mutex_;
+        std::map<std::string, std::shared_ptr<const Object>> objects_;   // ordered for prefix scans
+    };
+
+}
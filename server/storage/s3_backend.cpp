@@ -0,0 +1,613 @@
+#include "storage/s3_backend.h"
+#include "crypto/crypto.h"
+#include "logging/logger.h"
+#include "utils/utils.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <stdexcept>
+#include <thread>
+
+namespace vault::server
+{
+    /// S3 rejects multipart parts below this size, except the last
+    static constexpr std::size_t kMinPartSize = 5 * 1024 * 1024;
+
+    /// Tries per request before a transport failure or 5xx is final
+    static constexpr int kAttempts = 3;
+
+    // ─── Signing ────────────────────────────────────────────────────────────────
+
+    static std::string to_hex(const std::string& bytes)
+    {
+        static const char digits[] = "0123456789abcdef";
+        std::string out;
+        out.reserve(bytes.size() * 2);
+        for (unsigned char c : bytes)
+        {
+            out += digits[c >> 4];
+            out += digits[c & 15];
+        }
+        return out;
+    }
+
+    /// Current time as SigV4 wants it: "20130524T000000Z"
+    static std::string amz_date_now()
+    {
+        auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        struct tm tm_buf;
+    #ifdef _WIN32
+        gmtime_s(&tm_buf, &now);
+    #else
+        gmtime_r(&now, &tm_buf);
+    #endif
+        char buf[20];
+        std::strftime(buf, sizeof(buf), "%Y%m%dT%H%M%SZ", &tm_buf);
+        return buf;
+    }
+
+    /// Authorization header for one request (AWS Signature Version 4).
+    /// `headers` are the signed headers with lowercase names; `query` is
+    /// already in canonical form.
+    static std::string sigv4_authorization(const std::string& method, const std::string& uri,
+                                           const std::string& query,
+                                           const std::map<std::string, std::string>& headers,
+                                           const std::string& payload_hash,
+                                           const std::string& amz_date,
+                                           const std::string& region, const std::string& service,
+                                           const std::string& access_key, const std::string& secret_key)
+    {
+        std::string canonical_headers;
+        std::string signed_headers;
+        for (const auto& [name, value] : headers)
+        {
+            canonical_headers += name + ":" + value + "\n";
+            if (!signed_headers.empty()) signed_headers += ';';
+            signed_headers += name;
+        }
+
+        std::string canonical_request = method + "\n" + uri + "\n" + query + "\n" +
+                                        canonical_headers + "\n" + signed_headers + "\n" + payload_hash;
+
+        std::string date = amz_date.substr(0, 8);
+        std::string scope = date + "/" + region + "/" + service + "/aws4_request";
+        std::string string_to_sign = "AWS4-HMAC-SHA256\n" + amz_date + "\n" + scope + "\n" +
+                                     crypto::sha256_hex(canonical_request.data(), canonical_request.size());
+
+        auto key = crypto::hmac_sha256("AWS4" + secret_key, date);
+        key = crypto::hmac_sha256(key, region);
+        key = crypto::hmac_sha256(key, service);
+        key = crypto::hmac_sha256(key, "aws4_request");
+
+        return "AWS4-HMAC-SHA256 Credential=" + access_key + "/" + scope +
+               ", SignedHeaders=" + signed_headers +
+               ", Signature=" + to_hex(crypto::hmac_sha256(key, string_to_sign));
+    }
+
+    /// URI-encode each segment of a key, keeping the slashes
+    static std::string encode_path(const std::string& key)
+    {
+        std::string out;
+        std::size_t start = 0;
+        for (;;)
+        {
+            auto slash = key.find('/', start);
+            out += utils::url_encode(key.substr(start, slash - start));
+            if (slash == std::string::npos) break;
+            out += '/';
+            start = slash + 1;
+        }
+        return out;
+    }
+
+    // ─── XML ────────────────────────────────────────────────────────────────────
+
+    // S3 answers in small, flat XML documents; finding tags by name is enough
+
+    static std::string xml_unescape(const std::string& text)
+    {
+        static const std::pair<const char*, char> entities[] = {
+            {"&amp;", '&'}, {"&lt;", '<'}, {"&gt;", '>'}, {"&quot;", '"'}, {"&apos;", '\''}};
+
+        std::string out;
+        out.reserve(text.size());
+        for (std::size_t i = 0; i < text.size(); ++i)
+        {
+            bool replaced = false;
+            if (text[i] == '&')
+            {
+                for (const auto& [entity, c] : entities)
+                {
+                    if (text.compare(i, std::strlen(entity), entity) == 0)
+                    {
+                        out += c;
+                        i += std::strlen(entity) - 1;
+                        replaced = true;
+                        break;
+                    }
+                }
+            }
+            if (!replaced) out += text[i];
+        }
+        return out;
+    }
+
+    /// Raw content of every <tag>...</tag> in `xml`, in order
+    static std::vector<std::string> xml_all(const std::string& xml, const std::string& tag)
+    {
+        std::vector<std::string> values;
+        const std::string open = "<" + tag + ">";
+        const std::string close = "</" + tag + ">";
+        for (auto start = xml.find(open); start != std::string::npos; start = xml.find(open, start))
+        {
+            start += open.size();
+            auto end = xml.find(close, start);
+            if (end == std::string::npos) break;
+            values.push_back(xml.substr(start, end - start));
+            start = end + close.size();
+        }
+        return values;
+    }
+
+    /// Content of the first <tag>, entities decoded; empty if absent
+    static std::string xml_first(const std::string& xml, const std::string& tag)
+    {
+        const std::string open = "<" + tag + ">";
+        auto start = xml.find(open);
+        if (start == std::string::npos) return "";
+        start += open.size();
+        auto end = xml.find("</" + tag + ">", start);
+        if (end == std::string::npos) return "";
+        return xml_unescape(xml.substr(start, end - start));
+    }
+
+    /// "403 SignatureDoesNotMatch: ..." from an error response
+    static std::string s3_error(const httplib::Response& res)
+    {
+        std::string text = std::to_string(res.status);
+        auto code = xml_first(res.body, "Code");
+        auto message = xml_first(res.body, "Message");
+        if (!code.empty()) text += " " + code;
+        if (!message.empty()) text += ": " + message;
+        return text;
+    }
+
+    // ─── Reader / Writer ────────────────────────────────────────────────────────
+
+    /// Serves reads from one window of the object at a time, fetching the
+    /// next range when it runs dry
+    class S3Backend::ObjectReader : public StorageBackend::Reader
+    {
+    public:
+        ObjectReader(S3Backend& backend, std::string key, std::uint64_t size,
+                     std::string etag, std::string first_window)
+            : backend_(backend),
+              key_(std::move(key)),
+              size_(size),
+              etag_(std::move(etag)),
+              window_(std::move(first_window)),
+              fetched_(window_.size())
+        {
+        }
+
+        std::uint64_t size() const override { return size_; }
+
+        std::size_t read(char* data, std::size_t size) override
+        {
+            std::size_t done = 0;
+            while (done < size)
+            {
+                if (pos_ == window_.size() && (fetched_ >= size_ || !fetch())) break;
+
+                auto n = std::min(size - done, window_.size() - pos_);
+                std::memcpy(data + done, window_.data() + pos_, n);
+                pos_ += n;
+                done += n;
+            }
+            return done;
+        }
+
+    private:
+        /// Next range; false if the object was replaced or deleted since open
+        bool fetch()
+        {
+            auto last = std::min<std::uint64_t>(fetched_ + backend_.options_.range_size, size_) - 1;
+            httplib::Headers headers = {
+                {"Range", "bytes=" + std::to_string(fetched_) + "-" + std::to_string(last)}};
+            if (!etag_.empty()) headers.emplace("If-Match", etag_);
+
+            auto res = backend_.send("GET", key_, "", std::move(headers));
+            if (res->status == 412 || res->status == 404) return false;
+            if (res->status != 206 || res->body.size() != last - fetched_ + 1)
+            {
+                throw std::runtime_error("S3 GET " + key_ + ": " + s3_error(*res));
+            }
+
+            window_ = std::move(res->body);
+            pos_ = 0;
+            fetched_ += window_.size();
+            return true;
+        }
+
+        S3Backend& backend_;
+        std::string key_;
+        std::uint64_t size_;
+        std::string etag_;
+        std::string window_;
+        std::size_t pos_ = 0;           // next byte of window_ to hand out
+        std::uint64_t fetched_;         // object offset just past window_
+    };
+
+    /// Accumulates one part at a time. The multipart upload is started only
+    /// once a full part exists, so small objects cost a single PUT.
+    class S3Backend::ObjectWriter : public StorageBackend::Writer
+    {
+    public:
+        ObjectWriter(S3Backend& backend, std::string key)
+            : backend_(backend), key_(std::move(key))
+        {
+        }
+
+        ~ObjectWriter() override
+        {
+            if (committed_ || upload_id_.empty()) return;
+            try
+            {
+                backend_.send("DELETE", key_, upload_query(), {});
+            }
+            catch (const std::exception& e)
+            {
+                // Parts stay billed until a lifecycle rule reaps the upload
+                logging::warn("Storage", "Cannot abort S3 upload of " + key_ + ": " + e.what());
+            }
+        }
+
+        bool write(const char* data, std::size_t size) override
+        {
+            if (failed_ || committed_) return false;
+            buffer_.append(data, size);
+            if (buffer_.size() >= backend_.options_.part_size) return send_part();
+            return true;
+        }
+
+        bool commit() override
+        {
+            if (failed_ || committed_) return false;
+            try
+            {
+                if (upload_id_.empty())
+                {
+                    auto res = backend_.send("PUT", key_, "", {}, buffer_.data(), buffer_.size());
+                    if (res->status != 200) return fail("PUT", *res);
+                }
+                else
+                {
+                    if (!buffer_.empty() && !send_part()) return false;
+
+                    std::string xml = "<CompleteMultipartUpload>";
+                    for (std::size_t i = 0; i < etags_.size(); ++i)
+                    {
+                        xml += "<Part><PartNumber>" + std::to_string(i + 1) + "</PartNumber><ETag>" +
+                               etags_[i] + "</ETag></Part>";
+                    }
+                    xml += "</CompleteMultipartUpload>";
+
+                    // A failure after the response has started comes back
+                    // as a 200 carrying an error document
+                    auto res = backend_.send("POST", key_, upload_query(), {}, xml.data(), xml.size());
+                    if (res->status != 200 || res->body.find("<Error>") != std::string::npos)
+                    {
+                        return fail("complete upload", *res);
+                    }
+                }
+            }
+            catch (const std::exception& e)
+            {
+                logging::error("Storage", "S3 upload of " + key_ + " failed: " + e.what());
+                failed_ = true;
+                return false;
+            }
+            committed_ = true;
+            return true;
+        }
+
+    private:
+        std::string upload_query() const { return "uploadId=" + utils::url_encode(upload_id_); }
+
+        // PERF: Parts go up synchronously, so a streamed upload holds at
+        // most one part in memory and slows to the store's pace
+        bool send_part()
+        {
+            try
+            {
+                if (upload_id_.empty())
+                {
+                    auto res = backend_.send("POST", key_, "uploads=", {});
+                    auto upload_id = xml_first(res->body, "UploadId");
+                    if (res->status != 200 || upload_id.empty()) return fail("start upload", *res);
+                    upload_id_ = std::move(upload_id);
+                }
+
+                auto query = "partNumber=" + std::to_string(etags_.size() + 1) + "&" + upload_query();
+                auto res = backend_.send("PUT", key_, query, {}, buffer_.data(), buffer_.size());
+                auto etag = res->get_header_value("ETag");
+                if (res->status != 200 || etag.empty()) return fail("upload part", *res);
+
+                etags_.push_back(std::move(etag));
+                buffer_.clear();
+                return true;
+            }
+            catch (const std::exception& e)
+            {
+                logging::error("Storage", "S3 upload of " + key_ + " failed: " + e.what());
+                failed_ = true;
+                return false;
+            }
+        }
+
+        bool fail(const char* what, const httplib::Response& res)
+        {
+            logging::error("Storage", std::string("S3 ") + what + " " + key_ + ": " + s3_error(res));
+            failed_ = true;
+            return false;
+        }
+
+        S3Backend& backend_;
+        std::string key_;
+        std::string buffer_;
+        std::string upload_id_;             // set once the first part is sent
+        std::vector<std::string> etags_;    // one per part sent, in order
+        bool committed_ = false;
+        bool failed_ = false;
+    };
+
+    // ─── S3Backend ──────────────────────────────────────────────────────────────
+
+    S3Backend::S3Backend(Options options)
+        : options_(std::move(options))
+    {
+        if (options_.bucket.empty())
+        {
+            throw std::invalid_argument("S3 bucket is required");
+        }
+        if (options_.access_key.empty() || options_.secret_key.empty())
+        {
+            throw std::invalid_argument("S3 credentials are required (AWS_ACCESS_KEY_ID / AWS_SECRET_ACCESS_KEY)");
+        }
+        if (options_.part_size < kMinPartSize)
+        {
+            throw std::invalid_argument("S3 part size must be at least 5 MiB");
+        }
+        if (options_.range_size == 0)
+        {
+            throw std::invalid_argument("S3 range size must be positive");
+        }
+
+        auto scheme_end = options_.endpoint.find("://");
+        if (scheme_end == std::string::npos)
+        {
+            throw std::invalid_argument("S3 endpoint must be a URL such as http://127.0.0.1:9000");
+        }
+        host_ = options_.endpoint.substr(scheme_end + 3);
+        if (host_.empty() || host_.find('/') != std::string::npos)
+        {
+            throw std::invalid_argument("S3 endpoint must be scheme://host[:port]: " + options_.endpoint);
+        }
+
+        // Fail at startup on a wrong endpoint, bucket or key rather than on
+        // the first upload
+        release(acquire());
+        auto res = send("HEAD", "", "", {});
+        if (res->status != 200)
+        {
+            throw std::runtime_error("Cannot access " + describe() + ": HTTP " + std::to_string(res->status));
+        }
+    }
+
+    std::string S3Backend::describe() const
+    {
+        return "s3://" + options_.bucket + "/" + options_.prefix + " at " + options_.endpoint;
+    }
+
+    std::unique_ptr<httplib::Client> S3Backend::acquire()
+    {
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex_);
+            if (!idle_.empty())
+            {
+                auto client = std::move(idle_.back());
+                idle_.pop_back();
+                return client;
+            }
+        }
+
+        auto client = std::make_unique<httplib::Client>(options_.endpoint);
+        client->set_keep_alive(true);
+        client->set_url_encode(false);      // paths are sent exactly as signed
+        client->set_tcp_nodelay(true);
+        client->set_connection_timeout(5);
+        client->set_read_timeout(30);
+        client->set_write_timeout(30);
+        return client;
+    }
+
+    void S3Backend::release(std::unique_ptr<httplib::Client> client)
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        if (idle_.size() < options_.max_idle_connections)
+        {
+            idle_.push_back(std::move(client));
+        }
+    }
+
+    httplib::Result S3Backend::send(const std::string& method, const std::string& key,
+                                    const std::string& query, httplib::Headers headers,
+                                    const char* body, std::size_t size)
+    {
+        std::string uri = "/" + options_.bucket;
+        if (!key.empty()) uri += "/" + encode_path(options_.prefix + key);
+        const std::string path = query.empty() ? uri : uri + "?" + query;
+
+        if (!body) body = "";
+        const std::string payload_hash = crypto::sha256_hex(body, size);
+
+        for (int attempt = 1; ; ++attempt)
+        {
+            std::map<std::string, std::string> signed_headers = {
+                {"host", host_},
+                {"x-amz-content-sha256", payload_hash},
+                {"x-amz-date", amz_date_now()},
+            };
+            for (const auto& [name, value] : headers)
+            {
+                std::string lower = name;
+                std::transform(lower.begin(), lower.end(), lower.begin(),
+                               [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+                signed_headers[lower] = value;
+            }
+
+            httplib::Headers request_headers(signed_headers.begin(), signed_headers.end());
+            request_headers.emplace("Authorization",
+                sigv4_authorization(method, uri, query, signed_headers, payload_hash,
+                                    signed_headers["x-amz-date"], options_.region, "s3",
+                                    options_.access_key, options_.secret_key));
+
+            auto client = acquire();
+            auto res = [&]() -> httplib::Result
+            {
+                if (method == "GET") return client->Get(path, request_headers);
+                if (method == "HEAD") return client->Head(path, request_headers);
+                if (method == "PUT") return client->Put(path, request_headers, body, size, "application/octet-stream");
+                if (method == "POST") return client->Post(path, request_headers, body, size, "application/xml");
+                return client->Delete(path, request_headers);
+            }();
+
+            // A connection that failed mid-request is not worth keeping
+            bool transient = !res || res->status >= 500;
+            if (res) release(std::move(client));
+            if (!transient || attempt == kAttempts)
+            {
+                if (!res)
+                {
+                    throw std::runtime_error("S3 " + method + " " + path + ": " + httplib::to_string(res.error()));
+                }
+                return res;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100 * attempt));
+        }
+    }
+
+    std::unique_ptr<StorageBackend::Reader> S3Backend::open_read(const std::string& key)
+    {
+        auto res = send("GET", key, "", {{"Range", "bytes=0-" + std::to_string(options_.range_size - 1)}});
+        if (res->status == 404) return nullptr;
+
+        if (res->status == 416)
+        {
+            // An empty object has no byte 0 to range over
+            if (!stat(key)) return nullptr;
+            return std::make_unique<ObjectReader>(*this, key, 0, "", "");
+        }
+
+        std::uint64_t size = res->body.size();
+        if (res->status == 206)
+        {
+            // "bytes 0-8388607/123456789"
+            auto range = res->get_header_value("Content-Range");
+            auto slash = range.rfind('/');
+            if (slash == std::string::npos)
+            {
+                throw std::runtime_error("S3 GET " + key + ": no object size in Content-Range");
+            }
+            size = std::strtoull(range.c_str() + slash + 1, nullptr, 10);
+        }
+        else if (res->status != 200)
+        {
+            throw std::runtime_error("S3 GET " + key + ": " + s3_error(*res));
+        }
+
+        return std::make_unique<ObjectReader>(*this, key, size, res->get_header_value("ETag"),
+                                              std::move(res->body));
+    }
+
+    std::unique_ptr<StorageBackend::Writer> S3Backend::open_write(const std::string& key)
+    {
+        return std::make_unique<ObjectWriter>(*this, key);
+    }
+
+    bool S3Backend::put(const std::string& key, const char* data, std::size_t size)
+    {
+        if (size > options_.part_size)
+        {
+            return StorageBackend::put(key, data, size);   // multipart
+        }
+
+        auto res = send("PUT", key, "", {}, data, size);
+        if (res->status != 200)
+        {
+            throw std::runtime_error("S3 PUT " + key + ": " + s3_error(*res));
+        }
+        return true;
+    }
+
+    std::optional<StorageBackend::Stat> S3Backend::stat(const std::string& key)
+    {
+        auto res = send("HEAD", key, "", {});
+        if (res->status == 404) return std::nullopt;
+        if (res->status != 200)
+        {
+            throw std::runtime_error("S3 HEAD " + key + ": HTTP " + std::to_string(res->status));
+        }
+
+        Stat stat;
+        stat.size = std::strtoull(res->get_header_value("Content-Length").c_str(), nullptr, 10);
+        stat.modified = utils::parse_http_date(res->get_header_value("Last-Modified")).value_or(0);
+        return stat;
+    }
+
+    std::vector<StorageBackend::Entry> S3Backend::list(const std::string& prefix, bool recursive)
+    {
+        std::vector<Entry> entries;
+        std::string token;
+        do
+        {
+            // Parameters in canonical (sorted) order
+            std::string query;
+            if (!token.empty()) query += "continuation-token=" + utils::url_encode(token) + "&";
+            if (!recursive) query += "delimiter=%2F&";
+            query += "list-type=2&prefix=" + utils::url_encode(options_.prefix + prefix);
+
+            auto res = send("GET", "", query, {});
+            if (res->status != 200)
+            {
+                throw std::runtime_error("S3 list " + prefix + ": " + s3_error(*res));
+            }
+
+            for (const auto& item : xml_all(res->body, "Contents"))
+            {
+                auto key = xml_first(item, "Key");
+                if (key.compare(0, options_.prefix.size(), options_.prefix) != 0) continue;
+
+                Stat stat;
+                stat.size = std::strtoull(xml_first(item, "Size").c_str(), nullptr, 10);
+                stat.modified = utils::parse_iso8601(xml_first(item, "LastModified")).value_or(0);
+                entries.push_back({key.substr(options_.prefix.size()), stat});
+            }
+
+            token = xml_first(res->body, "IsTruncated") == "true" ? xml_first(res->body, "NextContinuationToken") : "";
+        } while (!token.empty());
+
+        return entries;
+    }
+
+    bool S3Backend::remove(const std::string& key)
+    {
+        auto res = send("DELETE", key, "", {});
+        return res->status == 204 || res->status == 200 || res->status == 404;
+    }
+
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "storage/storage_backend.h"
+
+#include <httplib.h>
+
+#include <mutex>
+
+namespace vault::server
+{
+    /// Objects in a bucket of an S3-compatible store (AWS S3, MinIO, Ceph
+    /// RGW, ...), addressed path-style and signed with AWS Signature V4.
+    ///
+    /// Small objects go up in one PUT. Larger ones, and every streamed
+    /// write, become a multipart upload that sends a part whenever
+    /// part_size bytes have accumulated, so a writer buffers at most one
+    /// part. Reads are ranged GETs of range_size bytes each, pinned to the
+    /// ETag seen on open so a replaced object ends the read instead of
+    /// splicing two versions.
+    ///
+    /// https endpoints need cpp-httplib built with OpenSSL support.
+    class S3Backend : public StorageBackend
+    {
+    public:
+        struct Options
+        {
+            std::string endpoint;                        // e.g. "http://127.0.0.1:9000"
+            std::string bucket;
+            std::string region = "us-east-1";
+            std::string prefix;                          // prepended to every key, e.g. "vault/"
+            std::string access_key;
+            std::string secret_key;
+            std::size_t part_size = 8 * 1024 * 1024;     // multipart part size, at least 5 MiB
+            std::size_t range_size = 8 * 1024 * 1024;    // bytes per ranged GET
+            std::size_t max_idle_connections = 16;       // keep-alive connections kept for reuse
+        };
+
+        /// Throws std::invalid_argument if the options can't work
+        explicit S3Backend(Options options);
+
+        std::string describe() const override;
+
+        std::unique_ptr<Reader> open_read(const std::string& key) override;
+        std::unique_ptr<Writer> open_write(const std::string& key) override;
+        bool put(const std::string& key, const char* data, std::size_t size) override;
+        std::optional<Stat> stat(const std::string& key) override;
+        std::vector<Entry> list(const std::string& prefix, bool recursive) override;
+        bool remove(const std::string& key) override;
+
+    private:
+        class ObjectReader;
+        class ObjectWriter;
+
+        /// Sign and send one request, retrying transport failures and 5xx
+        /// answers. `key` empty addresses the bucket; `query` is canonical
+        /// (sorted, encoded). Throws if no response arrives.
+        httplib::Result send(const std::string& method, const std::string& key,
+                             const std::string& query, httplib::Headers headers,
+                             const char* body = nullptr, std::size_t size = 0);
+
+        std::unique_ptr<httplib::Client> acquire();
+        void release(std::unique_ptr<httplib::Client> client);
+
+        Options options_;
+        std::string host_;                               // Host header, as signed
+
+        std::mutex pool_mutex_;
+        std::vector<std::unique_ptr<httplib::Client>> idle_;
+    };
+
+}
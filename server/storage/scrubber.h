@@ -0,0 +1,70 @@
+#pragma once
+
+#include "storage/storage_manager.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace vault::server
+{
+
+    /// Background pass over every stored object, re-hashing it against the
+    /// SHA-256 recorded when it was written, so bit rot is found before a
+    /// user needs the file. Reads are paced to a fixed byte rate so a pass
+    /// stays out of the way of client traffic however large the store is.
+    class Scrubber
+    {
+    public:
+        struct Options
+        {
+            std::uint64_t bytes_per_second = 8 * 1024 * 1024;
+            std::chrono::seconds interval{24 * 60 * 60};    // end of one pass to start of the next
+        };
+
+        /// Starts the first pass right away
+        Scrubber(StorageManager& storage, Options options);
+
+        /// Abandons the current pass and joins the thread
+        ~Scrubber();
+
+        Scrubber(const Scrubber&) = delete;
+        Scrubber& operator=(const Scrubber&) = delete;
+
+        std::uint64_t passes() const { return passes_.load(std::memory_order_relaxed); }
+        std::uint64_t objects_verified() const { return objects_.load(std::memory_order_relaxed); }
+        std::uint64_t bytes_verified() const { return bytes_.load(std::memory_order_relaxed); }
+        std::uint64_t corrupt_found() const { return corrupt_.load(std::memory_order_relaxed); }
+
+        /// Duration of the last completed pass, 0 before the first
+        double last_pass_seconds() const { return last_pass_ms_.load(std::memory_order_relaxed) / 1000.0; }
+
+    private:
+        void run();
+        void scrub_pass();
+
+        /// Sleep until `bytes` more fit the rate; false once stopping
+        bool pace(std::size_t bytes);
+
+        StorageManager& storage_;
+        Options options_;
+
+        std::chrono::steady_clock::time_point pass_start_;
+        std::uint64_t pass_bytes_ = 0;
+
+        std::atomic<std::uint64_t> passes_{0};
+        std::atomic<std::uint64_t> objects_{0};
+        std::atomic<std::uint64_t> bytes_{0};
+        std::atomic<std::uint64_t> corrupt_{0};
+        std::atomic<std::uint64_t> last_pass_ms_{0};
+
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        bool stopping_ = false;
+        std::thread thread_;
+    };
+
+} // namespace vault::server
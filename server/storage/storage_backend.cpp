@@ -0,0 +1,11 @@
+#include "storage/storage_backend.h"
+
+namespace vault::server
+{
+    bool StorageBackend::put(const std::string& key, const char* data, std::size_t size)
+    {
+        auto writer = open_write(key);
+        return writer && writer->write(data, size) && writer->commit();
+    }
+
+}
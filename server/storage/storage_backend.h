@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace vault::server
+{
+    /// Where StorageManager keeps its bytes. Objects are addressed by
+    /// '/'-separated keys such as "alice/notes.txt.enc"; what a key means
+    /// (users, sidecars) is up to the caller. Implementations are safe to
+    /// use from many threads at once.
+    ///
+    /// Missing objects are reported through return values (nullptr,
+    /// nullopt); I/O and transport failures throw std::runtime_error.
+    class StorageBackend
+    {
+    public:
+        struct Stat
+        {
+            std::uint64_t size = 0;
+            std::int64_t modified = 0;   // Unix time of the last write
+        };
+
+        struct Entry
+        {
+            std::string key;
+            Stat stat;
+        };
+
+        /// Sequential read of one object as it was when opened
+        class Reader
+        {
+        public:
+            virtual ~Reader() = default;
+
+            /// Object size at open time; reads never go past it
+            virtual std::uint64_t size() const = 0;
+
+            /// Fill up to `size` bytes. Returns fewer only at the end of the
+            /// object, or if it was replaced underneath a backend that can't
+            /// keep the old copy readable.
+            virtual std::size_t read(char* data, std::size_t size) = 0;
+        };
+
+        /// Incremental write of one object. Nothing is visible under the
+        /// key until commit(), which replaces any previous object whole;
+        /// a writer dropped uncommitted leaves no trace.
+        class Writer
+        {
+        public:
+            virtual ~Writer() = default;
+
+            /// Append bytes. Returns false once a write has failed.
+            virtual bool write(const char* data, std::size_t size) = 0;
+
+            /// Publish the object. Returns false if anything failed.
+            virtual bool commit() = 0;
+        };
+
+        virtual ~StorageBackend() = default;
+
+        /// Where the data lives, for logs (e.g. a directory or a bucket URL)
+        virtual std::string describe() const = 0;
+
+        /// Open an object for reading, or nullptr if it does not exist
+        virtual std::unique_ptr<Reader> open_read(const std::string& key) = 0;
+
+        /// Start writing an object, or nullptr if it can't be created
+        virtual std::unique_ptr<Writer> open_write(const std::string& key) = 0;
+
+        /// Store a whole object from memory. The default goes through
+        /// open_write(); backends override it when one call is cheaper.
+        virtual bool put(const std::string& key, const char* data, std::size_t size);
+
+        /// Size and time of an object, or nullopt if it does not exist
+        virtual std::optional<Stat> stat(const std::string& key) = 0;
+
+        /// Objects whose key starts with `prefix`, in no particular order.
+        /// Unless `recursive`, only those with no further '/' after it, the
+        /// way a directory listing leaves out subdirectories.
+        virtual std::vector<Entry> list(const std::string& prefix, bool recursive) = 0;
+
+        /// Delete an object. Returns false only if it could not be removed;
+        /// removing a missing object succeeds.
+        virtual bool remove(const std::string& key) = 0;
+    };
+
+}
@@ -1,24 +1,126 @@
 #pragma once
 
 #include "models/file_meta.h"
+#include "crypto/crypto.h"
+#include "storage/storage_backend.h"
+#include "utils/thread_pool.h"
 
+#include <array>
+#include <atomic>
 #include <string>
 #include <vector>
 #include <cstdint>
 #include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 
 namespace vault::server 
 {
     class StorageManager 
     {
     public:
-        explicit StorageManager(const std::filesystem::path& storage_dir = "storage");
+        /// One file of a multi-file store
+        struct PendingFile 
+        {
+            std::string filename;
+            std::string_view data;   // borrowed; must outlive store_files()
+        };
+
+        /// Validators for a stored object, recorded when it is written
+        struct ObjectInfo 
+        {
+            std::string sha256;          // hex digest of the stored (encrypted) bytes
+            std::uint64_t size = 0;
+            std::int64_t modified = 0;   // Unix time of the last write
+        };
+
+        /// Result of re-reading a stored object against its recorded hash
+        enum class Verdict 
+        {
+            Intact,
+            Corrupt,
+            Skipped      // no recorded hash, gone, rewritten meanwhile, or abandoned
+        };
+
+        /// Called after each chunk verify_object() reads, with its size.
+        /// Return false to abandon the object.
+        using ReadPacer = std::function<bool(std::size_t)>;
+
+        /// Called after each completed write with the stored filename
+        using WriteObserver = std::function<void(const std::string& username,
+                                                 const std::string& filename,
+                                                 const ObjectInfo& info)>;
+
+        /// Validators for a user's listing
+        struct ListingInfo 
+        {
+            std::uint64_t generation = 0;   // bumped on every write; resets on restart
+            std::int64_t modified = 0;      // newest write, 0 until known
+        };
+
+        /// Incremental write of one stored file, for uploads too large to
+        /// buffer. The backend publishes the bytes only on commit(); a
+        /// writer dropped uncommitted leaves no trace.
+        class ObjectWriter 
+        {
+        public:
+            ~ObjectWriter();
+
+            ObjectWriter(const ObjectWriter&) = delete;
+            ObjectWriter& operator=(const ObjectWriter&) = delete;
+
+            /// Append bytes. Returns false once a write has failed.
+            bool write(const char* data, std::size_t size);
+
+            /// Publish the file under its name. Returns false if anything failed.
+            bool commit();
+
+            std::uint64_t size() const { return size_; }
+
+        private:
+            friend class StorageManager;
+            ObjectWriter(StorageManager& storage, std::string username, std::string filename,
+                         std::unique_ptr<StorageBackend::Writer> out);
+
+            StorageManager& storage_;
+            std::string username_;
+            std::string filename_;
+            std::unique_ptr<StorageBackend::Writer> out_;
+            crypto::Sha256 hasher_;       // PERF: hashed as it streams, never read back
+            std::uint64_t size_ = 0;
+            bool failed_ = false;
+            bool committed_ = false;
+        };
+
+        /// Files under `storage_dir` on local disk; `store_threads` writers
+        /// serve store_files()
+        explicit StorageManager(const std::filesystem::path& storage_dir = "storage",
+                                std::size_t store_threads = 4);
+
+        /// Objects kept by `backend` (local disk, memory, S3, ...)
+        explicit StorageManager(std::unique_ptr<StorageBackend> backend,
+                                std::size_t store_threads = 4);
     
         /// Store encrypted file data for a user
         bool store_file(const std::string& username,
                         const std::string& filename,
                         const std::vector<uint8_t>& data);
+
+        /// Store several files for a user concurrently on the writer pool.
+        /// Returns one flag per input, in order. Names must be distinct.
+        std::vector<bool> store_files(const std::string& username,
+                                      const std::vector<PendingFile>& files);
         
+        /// Start a streamed write. Returns nullptr if it can't be created.
+        std::unique_ptr<ObjectWriter> open_writer(const std::string& username,
+                                                  const std::string& filename);
+
         /// Retrieve encrypted file data for a user
         std::vector<uint8_t> retrieve_file(const std::string& username,
                                             const std::string& filename);
@@ -26,16 +128,97 @@ namespace vault::server
         /// List all files stored for a user
         std::vector<models::FileMeta> list_files(const std::string& username);
         
+        /// Size of a stored file in bytes. Throws if it does not exist.
+        std::uint64_t file_size(const std::string& username,
+                                const std::string& filename) const;
+
+        /// Open a stored file for incremental reads, so large files can be
+        /// streamed without loading them into memory. Throws if it does not exist.
+        std::unique_ptr<StorageBackend::Reader> open_file(const std::string& username,
+                                                          const std::string& filename) const;
+        
+        /// Content hash, size and time of a stored file, or nullopt if it
+        /// does not exist. Served from memory after the first lookup.
+        /// Like every lookup here, throws std::invalid_argument if a name
+        /// is not a single path segment.
+        std::optional<ObjectInfo> object_info(const std::string& username,
+                                              const std::string& filename);
+
+        /// Every stored object, as (username, stored filename)
+        std::vector<std::pair<std::string, std::string>> stored_objects() const;
+
+        /// Re-read a stored object and compare it with the SHA-256 and size
+        /// recorded when it was written. A mismatch marks it corrupt until
+        /// it is rewritten.
+        Verdict verify_object(const std::string& username,
+                              const std::string& filename,
+                              const ReadPacer& pacer = nullptr);
+
+        /// True if the object failed verification and has not been rewritten
+        bool is_corrupt(const std::string& username, const std::string& filename) const;
+
+        /// Number of objects currently known to be corrupt
+        std::uint64_t corrupt_objects() const;
+
+        /// Current listing validators for a user; never touches the disk
+        ListingInfo listing_info(const std::string& username) const;
+
         /// Check if a file exists for a user
         bool file_exists(const std::string& username,
                          const std::string& filename) const;
+
+        /// Total bytes of encrypted data held across all users
+        std::uint64_t stored_bytes() const { return stored_bytes_.load(std::memory_order_relaxed); }
+
+        /// Total number of stored files across all users
+        std::uint64_t stored_files() const { return stored_files_.load(std::memory_order_relaxed); }
+
+        /// Observe completed writes (e.g. to log them for replicas). Set
+        /// before serving requests; it runs on the writing thread.
+        void set_write_observer(WriteObserver observer) { write_observer_ = std::move(observer); }
         
     private:
-        std::filesystem::path get_user_dir(const std::string& username) const;
-        std::filesystem::path get_file_path(const std::string& username,
-                                             const std::string& filename) const;
+        bool store_bytes(const std::string& username, const std::string& filename,
+                         const char* data, std::size_t size);
+
+        /// A sidecar's ObjectInfo, or nullopt if missing or malformed
+        std::optional<ObjectInfo> read_sidecar(const std::string& username,
+                                               const std::string& filename) const;
+
+        void record_write(const std::string& username, const std::string& filename,
+                          ObjectInfo info);
+
+        void mark_corrupt(const std::string& username, const std::string& filename,
+                          const std::string& reason);
+
+        /// Serialises everything that replaces an object or its sidecar, so
+        /// the bytes, sidecar and index always describe the same write
+        std::mutex& write_mutex(const std::string& key);
+
+        /// Write the sidecar, index the new object and update usage totals
+        /// once its bytes are in place. `previous_size` is set on a replace.
+        void publish(const std::string& username, const std::string& filename,
+                     ObjectInfo info, std::optional<std::uint64_t> previous_size);
         
-        std::filesystem::path storage_dir_;
+        std::unique_ptr<StorageBackend> backend_;
+
+        // Striped by object key: writes to one object are ordered, writes
+        // to different objects rarely contend
+        static constexpr std::size_t kWriteStripes = 64;
+        std::array<std::mutex, kWriteStripes> write_mutexes_;
+
+        // Usage totals, seeded by a scan at startup and kept current on writes
+        std::atomic<std::uint64_t> stored_bytes_{0};
+        std::atomic<std::uint64_t> stored_files_{0};
+
+        // Validator index: objects keyed "<user>/<file>", listings by user
+        mutable std::mutex meta_mutex_;
+        std::unordered_map<std::string, ObjectInfo> objects_;
+        std::unordered_map<std::string, ListingInfo> listings_;
+        std::unordered_set<std::string> corrupt_;     // "<user>/<file>", cleared by a rewrite
+
+        utils::ThreadPool store_pool_;
+        WriteObserver write_observer_;
     };
 
 }
\ No newline at end of file
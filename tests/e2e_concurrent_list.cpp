@@ -0,0 +1,112 @@
+// Concurrent full listings of a large directory while it is being written.
+//
+// Each reader has its own connection and never sends If-None-Match, so
+// every request builds and serialises the whole listing. A writer keeps
+// adding files meanwhile, so cached listings are invalidated throughout.
+//
+// Tuning: VAULT_TEST_LIST_FILES (default 2000), VAULT_TEST_MIN_LISTS_PER_S
+// (default 50), VAULT_TEST_RSS_MB (default 96, allowed peak growth).
+
+#include "harness.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace vault;
+
+int main()
+{
+    const auto count = static_cast<std::size_t>(test::env_number("VAULT_TEST_LIST_FILES", 2000));
+    const auto min_rate = test::env_number("VAULT_TEST_MIN_LISTS_PER_S", 50);
+    const auto rss_budget_mb = test::env_number("VAULT_TEST_RSS_MB", 96);
+    const std::size_t readers = 16;
+    const std::size_t lists_per_reader = 25;
+
+    test::TestServer server;
+    VAULT_CHECK(server.auth().register_user("lister", "lister-password"));
+    auto token = server.auth().login("lister", "lister-password");
+    VAULT_CHECK(token.has_value());
+    if (!token) return test::result();
+
+    // Seed through StorageManager directly; upload speed is not under test here
+    std::vector<uint8_t> blob(512, 0xAB);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        server.storage().store_file("lister", "seed-" + std::to_string(i) + ".enc", blob);
+    }
+
+    const auto rss_before = test::peak_rss_bytes();
+
+    // ── Readers and one writer ──────────────────────────────────────────
+    std::atomic<bool> reading{true};
+    std::atomic<std::size_t> failed{0};
+    std::atomic<std::size_t> short_lists{0};
+    std::vector<double> slowest(readers, 0.0);
+
+    std::thread writer([&]
+    {
+        for (std::size_t i = 0; reading; ++i)
+        {
+            server.storage().store_file("lister", "live-" + std::to_string(i) + ".enc", blob);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    });
+
+    test::Stopwatch clock;
+    {
+        std::vector<std::thread> workers;
+        for (std::size_t r = 0; r < readers; ++r)
+        {
+            workers.emplace_back([&, r]
+            {
+                httplib::Client client(server.host(), server.port());
+                client.set_keep_alive(true);
+                httplib::Headers headers = {{"Authorization", "Bearer " + *token}};
+
+                for (std::size_t n = 0; n < lists_per_reader; ++n)
+                {
+                    test::Stopwatch one;
+                    auto res = client.Get("/list", headers);
+                    slowest[r] = std::max(slowest[r], one.seconds());
+
+                    if (!res || res->status != 200)
+                    {
+                        ++failed;
+                        continue;
+                    }
+                    auto body = nlohmann::json::parse(res->body, nullptr, false);
+                    if (body.is_discarded() || !body.contains("files") || body["files"].size() < count)
+                    {
+                        ++short_lists;
+                    }
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+    }
+    double elapsed = clock.seconds();
+    reading = false;
+    writer.join();
+
+    // ── Guardrails ──────────────────────────────────────────────────────
+    double rate = readers * lists_per_reader / elapsed;
+    double worst_ms = *std::max_element(slowest.begin(), slowest.end()) * 1000;
+    double rss_growth_mb = static_cast<double>(test::peak_rss_bytes() - rss_before) / (1024 * 1024);
+
+    test::report("files per listing", static_cast<double>(count), "");
+    test::report("listings", rate, "/s");
+    test::report("slowest listing", worst_ms, "ms");
+    test::report("peak RSS growth", rss_growth_mb, "MiB");
+
+    VAULT_CHECK_MSG(failed == 0, std::to_string(failed.load()) + " listings failed");
+    VAULT_CHECK_MSG(short_lists == 0, std::to_string(short_lists.load()) + " listings were missing files");
+    VAULT_CHECK_MSG(rate >= min_rate, "fewer than " + std::to_string(min_rate) + " listings/s");
+    VAULT_CHECK_MSG(rss_growth_mb <= rss_budget_mb,
+                    "peak RSS grew by more than " + std::to_string(rss_budget_mb) + " MiB");
+
+    return test::result();
+}
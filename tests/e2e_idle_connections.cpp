@@ -0,0 +1,188 @@
+// Many idle keep-alive connections on the event-driven core (--core event).
+//
+// Every idle connection makes one request and then sits open, as a sync
+// agent does between syncs. Meanwhile a few active clients upload,
+// download and list. The process must keep a fixed number of threads,
+// keep every idle connection usable, and spend only a few KB on each.
+//
+// Linux only. Tuning: VAULT_TEST_IDLE_CONNECTIONS (default 10000, capped
+// by the open file limit), VAULT_TEST_MAX_THREADS (default 64),
+// VAULT_TEST_KB_PER_CONNECTION (default 32, peak RSS growth per idle
+// connection).
+
+#include "harness.h"
+
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+using namespace vault;
+
+static std::size_t thread_count()
+{
+    std::size_t n = 0;
+    for (const auto& entry : std::filesystem::directory_iterator("/proc/self/task"))
+    {
+        (void)entry;
+        ++n;
+    }
+    return n;
+}
+
+static int open_connection(int port)
+{
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+    {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/// One GET /health on an open connection; true on a 200 with the
+/// connection left open
+static bool health_check(int fd)
+{
+    static const char request[] = "GET /health HTTP/1.1\r\nHost: test\r\n\r\n";
+    if (::send(fd, request, sizeof(request) - 1, MSG_NOSIGNAL) != static_cast<ssize_t>(sizeof(request) - 1))
+    {
+        return false;
+    }
+
+    std::string response;
+    char buf[4096];
+    while (response.find("\r\n\r\n") == std::string::npos || response.find('}') == std::string::npos)
+    {
+        ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) return false;
+        response.append(buf, static_cast<std::size_t>(n));
+    }
+    return response.rfind("HTTP/1.1 200", 0) == 0 && response.find("Connection: close") == std::string::npos;
+}
+
+int main()
+{
+    auto wanted = static_cast<std::size_t>(test::env_number("VAULT_TEST_IDLE_CONNECTIONS", 10000));
+    const auto max_threads = test::env_number("VAULT_TEST_MAX_THREADS", 64);
+    const auto kb_budget = test::env_number("VAULT_TEST_KB_PER_CONNECTION", 32);
+    const std::size_t active_clients = 8;
+    const std::size_t rounds = 20;
+
+    test::TestServer server(test::TestServer::Core::Event);
+    VAULT_CHECK(server.auth().register_user("agent", "agent-password"));
+    auto token = server.auth().login("agent", "agent-password");
+    VAULT_CHECK(token.has_value());
+    if (!token) return test::result();
+
+    // Both ends of every connection live in this process; the server has
+    // already raised the soft limit as far as it goes
+    rlimit limit{};
+    getrlimit(RLIMIT_NOFILE, &limit);
+    std::size_t fd_room = limit.rlim_cur > 512 ? (limit.rlim_cur - 512) / 2 : 0;
+    std::size_t count = std::min(wanted, fd_room);
+    if (count < wanted)
+    {
+        std::cout << "  open file limit allows " << count << " of " << wanted << " connections" << std::endl;
+    }
+
+    const auto rss_before = test::peak_rss_bytes();
+
+    // ── Idle connections, each used once ───────────────────────────────
+    std::vector<int> idle;
+    idle.reserve(count);
+    std::size_t refused = 0;
+    test::Stopwatch connect_clock;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        int fd = open_connection(server.port());
+        if (fd < 0 || !health_check(fd))
+        {
+            ++refused;
+            if (fd >= 0) ::close(fd);
+            continue;
+        }
+        idle.push_back(fd);
+    }
+    double connect_seconds = connect_clock.seconds();
+    const std::size_t threads_idle = thread_count();
+
+    // ── Active clients alongside them ──────────────────────────────────
+    std::atomic<std::size_t> failed{0};
+    test::Stopwatch active_clock;
+    {
+        std::vector<std::thread> clients;
+        for (std::size_t c = 0; c < active_clients; ++c)
+        {
+            clients.emplace_back([&, c]
+            {
+                httplib::Client client(server.host(), server.port());
+                client.set_keep_alive(true);
+                httplib::Headers headers = {{"Authorization", "Bearer " + *token}};
+                std::string body(64 * 1024, static_cast<char>('a' + c));
+
+                for (std::size_t r = 0; r < rounds; ++r)
+                {
+                    std::string name = "c" + std::to_string(c) + "-" + std::to_string(r) + ".enc";
+                    auto put = client.Put("/upload?filename=" + name, headers, body, "application/octet-stream");
+                    auto get = client.Get("/download?filename=" + name, headers);
+                    auto list = client.Get("/list", headers);
+                    if (!put || put->status != 200 || !get || get->status != 200 || get->body != body ||
+                        !list || list->status != 200)
+                    {
+                        ++failed;
+                    }
+                }
+            });
+        }
+        for (auto& t : clients) t.join();
+    }
+    double active_seconds = active_clock.seconds();
+    const std::size_t threads_busy = thread_count();
+
+    // ── Idle connections are still good ───────────────────────────────
+    std::size_t reused = 0;
+    std::size_t sampled = 0;
+    std::size_t step = std::max<std::size_t>(1, idle.size() / 200);
+    for (std::size_t i = 0; i < idle.size(); i += step)
+    {
+        ++sampled;
+        if (health_check(idle[i])) ++reused;
+    }
+
+    double rss_growth_kb = static_cast<double>(test::peak_rss_bytes() - rss_before) / 1024;
+    double kb_per_connection = idle.empty() ? 0 : rss_growth_kb / static_cast<double>(idle.size());
+
+    for (int fd : idle) ::close(fd);
+
+    // ── Guardrails ──────────────────────────────────────────────────────
+    test::report("idle connections", static_cast<double>(idle.size()), "");
+    test::report("connect + first request", static_cast<double>(idle.size()) / connect_seconds, "/s");
+    test::report("active round trips", active_clients * rounds * 3 / active_seconds, "/s");
+    test::report("threads while idle", static_cast<double>(threads_idle), "");
+    test::report("threads while busy", static_cast<double>(threads_busy), "");
+    test::report("peak RSS growth per connection", kb_per_connection, "KiB");
+
+    VAULT_CHECK_MSG(refused == 0, std::to_string(refused) + " connections were refused or failed");
+    VAULT_CHECK_MSG(failed == 0, std::to_string(failed.load()) + " active rounds failed");
+    VAULT_CHECK_MSG(reused == sampled,
+                    std::to_string(sampled - reused) + " of " + std::to_string(sampled) +
+                    " idle connections were no longer usable");
+    VAULT_CHECK_MSG(threads_busy <= max_threads, "more than " + std::to_string(max_threads) + " threads");
+    VAULT_CHECK_MSG(kb_per_connection <= kb_budget,
+                    "peak RSS grew by more than " + std::to_string(kb_budget) + " KiB per connection");
+
+    return test::result();
+}
@@ -0,0 +1,107 @@
+// Damaged objects are caught on the server and refused by the client.
+//
+// Stores a file, flips one byte of it on disk behind the server's back,
+// and checks that re-verification convicts it, that the corrupt-object
+// count and its gauge on /metrics report it, and that both download paths
+// refuse the copy because it no longer matches the Repr-Digest recorded at
+// write time. Rewriting the file clears the mark.
+
+#include "harness.h"
+
+#include "network/api_client.h"
+
+#include <fstream>
+#include <sstream>
+
+using namespace vault;
+
+static const char* const kUser = "integrity";
+static const char* const kFile = "report.txt.enc";
+
+/// 64 KiB of text, so the damaged byte lands well inside the ciphertext
+static std::string file_body()
+{
+    std::string body;
+    while (body.size() < 64 * 1024) body += "a line of the integrity scenario\n";
+    return body;
+}
+
+/// The vault_storage_corrupt_objects sample from /metrics, or -1
+static double corrupt_gauge(const test::TestServer& server)
+{
+    httplib::Client cli(server.host(), server.port());
+    auto res = cli.Get("/metrics");
+    if (!res || res->status != 200) return -1;
+
+    std::istringstream lines(res->body);
+    std::string line;
+    const std::string name = "vault_storage_corrupt_objects ";
+    while (std::getline(lines, line))
+    {
+        if (line.compare(0, name.size(), name) == 0) return std::stod(line.substr(name.size()));
+    }
+    return -1;
+}
+
+int main()
+{
+    const std::string key = "integrity-key";
+    const std::string body = file_body();
+
+    test::TestServer server;
+    client::ApiClient api(server.host(), server.port(), 2);
+    VAULT_CHECK(api.register_user(kUser, "integrity-password").success);
+    VAULT_CHECK(api.login(kUser, "integrity-password").success);
+
+    std::istringstream in(body);
+    VAULT_CHECK(api.upload_stream(in, kFile, key).success);
+
+    auto& storage = server.storage();
+    VAULT_CHECK(storage.verify_object(kUser, kFile) == server::StorageManager::Verdict::Intact);
+    VAULT_CHECK(storage.corrupt_objects() == 0);
+    VAULT_CHECK(corrupt_gauge(server) == 0);
+
+    // ── Damage ──────────────────────────────────────────────────────────
+    auto path = server.storage_dir() / kUser / kFile;
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        VAULT_CHECK_MSG(file.is_open(), "cannot open " + path.string());
+        file.seekg(4096);
+        char byte = 0;
+        file.get(byte);
+        file.seekp(4096);
+        file.put(static_cast<char>(byte ^ 0x01));
+    }
+
+    // ── Caught on the server ────────────────────────────────────────────
+    VAULT_CHECK(storage.verify_object(kUser, kFile) == server::StorageManager::Verdict::Corrupt);
+    VAULT_CHECK(storage.is_corrupt(kUser, kFile));
+    VAULT_CHECK(storage.corrupt_objects() == 1);
+    VAULT_CHECK(corrupt_gauge(server) == 1);
+
+    // ── Refused by the client ───────────────────────────────────────────
+    auto dest = server.storage_dir().parent_path() / "restored.txt";
+    auto buffered = api.download_file(kFile, dest.string(), key);
+    VAULT_CHECK_MSG(!buffered.success, "download_file accepted a damaged copy");
+    VAULT_CHECK_MSG(buffered.message.find("Integrity check failed") != std::string::npos,
+                    "download_file: " + buffered.message);
+
+    std::ostringstream streamed_out;
+    auto streamed = api.download_stream(kFile, streamed_out, key);
+    VAULT_CHECK_MSG(!streamed.success, "download_stream accepted a damaged copy");
+    VAULT_CHECK_MSG(streamed.message.find("Integrity check failed") != std::string::npos,
+                    "download_stream: " + streamed.message);
+
+    // ── A rewrite clears it ─────────────────────────────────────────────
+    std::istringstream again(body);
+    VAULT_CHECK(api.upload_stream(again, kFile, key).success);
+    VAULT_CHECK(!storage.is_corrupt(kUser, kFile));
+    VAULT_CHECK(storage.corrupt_objects() == 0);
+    VAULT_CHECK(corrupt_gauge(server) == 0);
+
+    std::ostringstream restored;
+    VAULT_CHECK(api.download_stream(kFile, restored, key).success);
+    VAULT_CHECK(restored.str() == body);
+
+    return test::result();
+}
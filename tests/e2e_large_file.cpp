@@ -0,0 +1,72 @@
+// One large file up and back down through the streaming paths.
+//
+// The payload is generated and hashed on the fly, so the test itself holds
+// a few blocks at most. Any layer that buffers the whole file (client
+// encryption, request body, storage write, download response) shows up as
+// peak RSS growing with the file size and fails the memory check.
+//
+// Tuning: VAULT_TEST_LARGE_MB (default 256), VAULT_TEST_MIN_MBPS (default
+// 20, per direction), VAULT_TEST_RSS_MB (default 96, allowed peak growth).
+
+#include "harness.h"
+
+#include "network/api_client.h"
+
+#include <istream>
+#include <ostream>
+
+using namespace vault;
+
+int main()
+{
+    const auto size_mb = test::env_number("VAULT_TEST_LARGE_MB", 256);
+    const auto min_mbps = test::env_number("VAULT_TEST_MIN_MBPS", 20);
+    const auto rss_budget_mb = test::env_number("VAULT_TEST_RSS_MB", 96);
+    const auto size = static_cast<std::uint64_t>(size_mb * 1024 * 1024);
+    const std::string key = "large-file-key";
+
+    test::TestServer server;
+    client::ApiClient api(server.host(), server.port(), 2);
+    VAULT_CHECK(api.register_user("large", "large-password").success);
+    VAULT_CHECK(api.login("large", "large-password").success);
+
+    // Server threads, pools and connections are already up: this is the baseline
+    const auto rss_before = test::peak_rss_bytes();
+
+    // ── Upload ──────────────────────────────────────────────────────────
+    test::PatternSource source(size, 0x5eed);
+    std::istream in(&source);
+    test::Stopwatch upload_clock;
+    auto uploaded = api.upload_stream(in, "large.bin.enc", key);
+    double upload_s = upload_clock.seconds();
+    VAULT_CHECK_MSG(uploaded.success, "upload failed: " + uploaded.message);
+    std::string sent_hash = source.hash();
+
+    // ── Download ────────────────────────────────────────────────────────
+    test::HashingSink sink;
+    std::ostream out(&sink);
+    test::Stopwatch download_clock;
+    auto downloaded = api.download_stream("large.bin.enc", out, key);
+    double download_s = download_clock.seconds();
+    VAULT_CHECK_MSG(downloaded.success, "download failed: " + downloaded.message);
+
+    VAULT_CHECK(sink.size() == size);
+    VAULT_CHECK_MSG(sink.hash() == sent_hash, "downloaded plaintext differs from what was uploaded");
+
+    // ── Guardrails ──────────────────────────────────────────────────────
+    double upload_mbps = size_mb / upload_s;
+    double download_mbps = size_mb / download_s;
+    double rss_growth_mb = static_cast<double>(test::peak_rss_bytes() - rss_before) / (1024 * 1024);
+
+    test::report("file size", size_mb, "MiB");
+    test::report("upload", upload_mbps, "MiB/s");
+    test::report("download", download_mbps, "MiB/s");
+    test::report("peak RSS growth", rss_growth_mb, "MiB");
+
+    VAULT_CHECK_MSG(upload_mbps >= min_mbps, "upload slower than " + std::to_string(min_mbps) + " MiB/s");
+    VAULT_CHECK_MSG(download_mbps >= min_mbps, "download slower than " + std::to_string(min_mbps) + " MiB/s");
+    VAULT_CHECK_MSG(rss_growth_mb <= rss_budget_mb,
+                    "peak RSS grew by more than " + std::to_string(rss_budget_mb) + " MiB; is a path buffering the whole file?");
+
+    return test::result();
+}
@@ -0,0 +1,381 @@
+// A primary and two replicas as separate vault_server processes.
+//
+// One replica follows the change log from the start; the other starts
+// after the uploads and has to catch up from a snapshot. Both must end up
+// with the user and every object, serve them through /login, /list and
+// /download, refuse writes, and report zero lag once caught up. Finally the
+// same download load is run against the primary alone and spread over all
+// three nodes, to show reads scale out.
+//
+// Each node gets 4 handler threads, so a single node saturates before the
+// client does. On one machine the nodes still share its cores; on separate
+// hosts the gain is larger.
+//
+// Usage: e2e_replication <path to vault_server>
+//
+// POSIX only. Tuning: VAULT_TEST_REPL_FILES (default 300),
+// VAULT_TEST_REPL_MB (default 32), VAULT_TEST_REPL_TIMEOUT_S (default 60,
+// for replicas to catch up), VAULT_TEST_REPL_READ_S (default 3, per read
+// run), VAULT_TEST_MIN_READ_SCALING (default 0.9, spread vs. primary-only).
+
+#include "harness.h"
+
+#include "network/api_client.h"
+
+#include <nlohmann/json.hpp>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+extern char** environ;
+
+using namespace vault;
+using json = nlohmann::json;
+
+// ─── Server Processes ───────────────────────────────────────────────────────
+
+/// A loopback port nobody is listening on right now
+static int free_port()
+{
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (fd < 0 || ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0)
+    {
+        throw std::runtime_error("Cannot find a free port");
+    }
+    ::close(fd);
+    return ntohs(addr.sin_port);
+}
+
+/// One vault_server child on a free loopback port, with its own data and
+/// storage directories under `root` and its output in <name>.log there.
+/// Stopped with SIGTERM when destroyed.
+class Node
+{
+public:
+    Node(const std::string& binary, const std::filesystem::path& root, const std::string& name,
+         const std::vector<std::string>& flags)
+        : name_(name), port_(free_port())
+    {
+        std::vector<std::string> args = {
+            binary,
+            "--host", "127.0.0.1",
+            "--port", std::to_string(port_),
+            "--data-dir", (root / name / "data").string(),
+            "--storage-dir", (root / name / "storage").string(),
+            "--threads", "4",
+            "--keep-alive-max", "1000",
+            "--scrub-rate", "0",
+            "--no-rate-limit",
+            "--log-level", "warn",
+        };
+        args.insert(args.end(), flags.begin(), flags.end());
+
+        std::vector<char*> argv;
+        for (auto& arg : args) argv.push_back(arg.data());
+        argv.push_back(nullptr);
+
+        auto log = (root / (name + ".log")).string();
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO, STDERR_FILENO);
+        int rc = posix_spawn(&pid_, binary.c_str(), &actions, nullptr, argv.data(), environ);
+        posix_spawn_file_actions_destroy(&actions);
+        if (rc != 0)
+        {
+            throw std::runtime_error("Cannot start " + binary + ": " + std::strerror(rc));
+        }
+    }
+
+    ~Node()
+    {
+        ::kill(pid_, SIGTERM);
+        int status = 0;
+        ::waitpid(pid_, &status, 0);
+    }
+
+    Node(const Node&) = delete;
+    Node& operator=(const Node&) = delete;
+
+    const std::string& name() const { return name_; }
+    int port() const { return port_; }
+    std::string url() const { return "http://127.0.0.1:" + std::to_string(port_); }
+
+    /// GET /health as a JSON object, or null if the node didn't answer
+    json health() const
+    {
+        httplib::Client cli("127.0.0.1", port_);
+        cli.set_connection_timeout(1);
+        auto res = cli.Get("/health");
+        if (!res || res->status != 200) return nullptr;
+        auto body = json::parse(res->body, nullptr, false);
+        return body.is_object() ? body : json(nullptr);
+    }
+
+    /// The "replication" part of /health, empty if there is none
+    json replication() const
+    {
+        auto body = health();
+        return body.is_object() ? body.value("replication", json::object()) : json::object();
+    }
+
+    /// Wait for the node to answer /health
+    bool wait_ready(double seconds) const
+    {
+        test::Stopwatch clock;
+        while (clock.seconds() < seconds)
+        {
+            if (!health().is_null()) return true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        return false;
+    }
+
+private:
+    std::string name_;
+    int port_;
+    pid_t pid_ = -1;
+};
+
+/// Wait until every replica has applied the primary's newest change and
+/// reports no lag. Returns false on timeout.
+static bool wait_caught_up(const Node& primary, const std::vector<const Node*>& replicas, double seconds)
+{
+    test::Stopwatch clock;
+    while (clock.seconds() < seconds)
+    {
+        auto head = primary.replication().value("head", std::uint64_t{0});
+        bool caught_up = head > 0;
+        for (const auto* replica : replicas)
+        {
+            auto state = replica->replication();
+            caught_up = caught_up && state.value("applied", std::uint64_t{0}) >= head &&
+                        state.value("lag_seconds", 1.0) == 0.0;
+        }
+        if (caught_up) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    return false;
+}
+
+// ─── Workload ───────────────────────────────────────────────────────────────
+
+static std::string file_name(std::size_t i)
+{
+    return "replicated-" + std::to_string(i) + ".txt.enc";
+}
+
+/// 16 KiB that identifies its own file
+static std::string file_body(std::size_t i)
+{
+    std::string line = "file " + std::to_string(i) + " of the replication scenario\n";
+    std::string body;
+    while (body.size() < 16 * 1024) body += line;
+    body.resize(16 * 1024);
+    return body;
+}
+
+/// Downloads per second for `seconds` with `threads` threads, spread
+/// round-robin over `clients`
+static double read_rate(const std::vector<client::ApiClient*>& clients, std::size_t threads,
+                        std::size_t count, double seconds, const std::string& key,
+                        std::atomic<std::size_t>& failed)
+{
+    std::atomic<bool> done{false};
+    std::atomic<std::size_t> reads{0};
+    std::vector<std::thread> workers;
+    test::Stopwatch clock;
+    for (std::size_t t = 0; t < threads; ++t)
+    {
+        workers.emplace_back([&, t]
+        {
+            auto& api = *clients[t % clients.size()];
+            for (std::size_t i = t; !done; i += threads)
+            {
+                std::ostringstream out;
+                if (!api.download_stream(file_name(i % count), out, key).success) ++failed;
+                ++reads;
+            }
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+    done = true;
+    for (auto& w : workers) w.join();
+    return reads / clock.seconds();
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: e2e_replication <path to vault_server>" << std::endl;
+        return 2;
+    }
+    const std::string binary = argv[1];
+
+    const auto count = static_cast<std::size_t>(test::env_number("VAULT_TEST_REPL_FILES", 300));
+    const auto size_mb = test::env_number("VAULT_TEST_REPL_MB", 32);
+    const auto timeout = test::env_number("VAULT_TEST_REPL_TIMEOUT_S", 60);
+    const auto read_seconds = test::env_number("VAULT_TEST_REPL_READ_S", 3);
+    const auto min_scaling = test::env_number("VAULT_TEST_MIN_READ_SCALING", 0.9);
+    const auto size = static_cast<std::uint64_t>(size_mb * 1024 * 1024);
+    const std::size_t threads = 12;
+    const std::string key = "replication-key";
+
+    auto root = std::filesystem::temp_directory_path() / ("vault-repl-" + crypto::generate_token().substr(0, 12));
+    std::filesystem::create_directories(root);
+    // The secret never goes on a command line: the primary reads it from
+    // its environment, the replicas from a file
+    const std::string secret = crypto::generate_token();
+    const auto secret_file = (root / "replication.secret").string();
+    std::ofstream(secret_file) << secret << '\n';
+
+    {
+        ::setenv("VAULT_REPLICATION_SECRET", secret.c_str(), 1);
+        Node primary(binary, root, "primary", {});
+        ::unsetenv("VAULT_REPLICATION_SECRET");
+        Node early(binary, root, "replica-1", {"--replicate-from", primary.url(), "--replication-secret-file", secret_file});
+        VAULT_CHECK_MSG(primary.wait_ready(10) && early.wait_ready(10), "servers did not start");
+
+        client::ApiClient api("127.0.0.1", primary.port(), threads);
+        VAULT_CHECK(api.register_user("replicated", "replicated-password").success);
+        VAULT_CHECK(api.login("replicated", "replicated-password").success);
+
+        // ── Writes on the primary ───────────────────────────────────────
+        std::atomic<std::size_t> next{0};
+        std::atomic<std::size_t> failed{0};
+        {
+            std::vector<std::thread> workers;
+            for (std::size_t t = 0; t < 8; ++t)
+            {
+                workers.emplace_back([&]
+                {
+                    for (std::size_t i = next++; i < count; i = next++)
+                    {
+                        std::istringstream in(file_body(i));
+                        if (!api.upload_stream(in, file_name(i), key).success) ++failed;
+                    }
+                });
+            }
+            for (auto& w : workers) w.join();
+        }
+        VAULT_CHECK_MSG(failed == 0, std::to_string(failed.load()) + " uploads failed");
+
+        test::PatternSource source(size, 0x7e91);
+        std::istream large(&source);
+        VAULT_CHECK(api.upload_stream(large, "large.bin.enc", key).success);
+        std::string large_hash = source.hash();
+
+        // ── Replicas converge ───────────────────────────────────────────
+        // This one has missed everything and starts from a snapshot
+        Node late(binary, root, "replica-2", {"--replicate-from", primary.url(), "--replication-secret-file", secret_file});
+        VAULT_CHECK_MSG(late.wait_ready(10), "late replica did not start");
+
+        test::Stopwatch converge_clock;
+        VAULT_CHECK_MSG(wait_caught_up(primary, {&early, &late}, timeout),
+                        "replicas did not catch up within " + std::to_string(timeout) + " s");
+        double converge_s = converge_clock.seconds();
+
+        std::vector<std::unique_ptr<client::ApiClient>> replica_clients;
+        for (const Node* node : {&early, &late})
+        {
+            auto r = std::make_unique<client::ApiClient>("127.0.0.1", node->port(), threads);
+            VAULT_CHECK_MSG(r->login("replicated", "replicated-password").success,
+                            node->name() + " does not know the replicated user");
+
+            auto listing = r->list_files();
+            VAULT_CHECK(listing.ok);
+            VAULT_CHECK_MSG(listing.files.size() == count + 1,
+                            node->name() + " lists " + std::to_string(listing.files.size()) + " of " +
+                            std::to_string(count + 1) + " files");
+
+            for (std::size_t i = 0; i < count; i += count / 20 + 1)
+            {
+                std::ostringstream out;
+                auto result = r->download_stream(file_name(i), out, key);
+                VAULT_CHECK_MSG(result.success && out.str() == file_body(i),
+                                node->name() + " serves a wrong " + file_name(i) + ": " + result.message);
+            }
+
+            test::HashingSink sink;
+            std::ostream out(&sink);
+            VAULT_CHECK(r->download_stream("large.bin.enc", out, key).success);
+            VAULT_CHECK_MSG(sink.hash() == large_hash, node->name() + " serves a wrong large.bin.enc");
+
+            // Writes belong on the primary
+            std::istringstream in("rejected");
+            auto refused = r->upload_stream(in, "rejected.txt.enc", key);
+            VAULT_CHECK_MSG(!refused.success && refused.status == 403, node->name() + " accepted an upload");
+            VAULT_CHECK_MSG(r->register_user("intruder", "intruder-password").status == 403,
+                            node->name() + " accepted a registration");
+
+            replica_clients.push_back(std::move(r));
+        }
+        VAULT_CHECK(early.replication().value("role", "") == "replica");
+
+        // ── Live changes reach a caught-up replica ──────────────────────
+        std::istringstream live_in(file_body(count));
+        VAULT_CHECK(api.upload_stream(live_in, "live.txt.enc", key).success);
+        test::Stopwatch live_clock;
+        bool arrived = false;
+        while (!arrived && live_clock.seconds() < timeout)
+        {
+            std::ostringstream out;
+            arrived = replica_clients[0]->download_stream("live.txt.enc", out, key).success;
+            if (!arrived) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        double live_ms = live_clock.seconds() * 1000;
+        VAULT_CHECK_MSG(arrived, "a new upload never reached " + early.name());
+
+        // ── Reads scale out ─────────────────────────────────────────────
+        failed = 0;
+        double primary_rate = read_rate({&api}, threads, count, read_seconds, key, failed);
+        double spread_rate = read_rate({&api, replica_clients[0].get(), replica_clients[1].get()},
+                                       threads, count, read_seconds, key, failed);
+        VAULT_CHECK_MSG(failed == 0, std::to_string(failed.load()) + " reads failed");
+
+        test::report("objects replicated", static_cast<double>(count + 1), "");
+        test::report("catch-up after writes", converge_s, "s");
+        test::report("new upload visible on replica", live_ms, "ms");
+        test::report("reads, primary only", primary_rate, "downloads/s");
+        test::report("reads, primary + 2 replicas", spread_rate, "downloads/s");
+        test::report("read scaling", spread_rate / primary_rate, "x");
+
+        VAULT_CHECK_MSG(spread_rate >= primary_rate * min_scaling,
+                        "spreading reads over replicas scaled by less than " + std::to_string(min_scaling));
+    }
+
+    int rc = test::result();
+    std::error_code ec;
+    if (rc == 0)
+    {
+        std::filesystem::remove_all(root, ec);
+    }
+    else
+    {
+        std::cout << "Server logs kept in " << root.string() << std::endl;
+    }
+    return rc;
+}
@@ -0,0 +1,112 @@
+// Many small files: per-request overhead rather than bandwidth.
+//
+// Uploads 10k files from several threads over a shared connection pool,
+// checks that one listing returns all of them, and reads a sample back.
+//
+// Tuning: VAULT_TEST_SMALL_FILES (default 10000), VAULT_TEST_MIN_FILES_PER_S
+// (default 200), VAULT_TEST_RSS_MB (default 96, allowed peak growth).
+
+#include "harness.h"
+
+#include "network/api_client.h"
+
+#include <atomic>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace vault;
+
+static std::string file_name(std::size_t i)
+{
+    return "small-" + std::to_string(i) + ".txt.enc";
+}
+
+/// 100 B – 4 KiB of text that identifies its own file
+static std::string file_body(std::size_t i)
+{
+    std::string line = "file " + std::to_string(i) + " of the small-file scenario\n";
+    std::string body;
+    std::size_t size = 100 + (i * 7919) % 4000;
+    while (body.size() < size) body += line;
+    body.resize(size);
+    return body;
+}
+
+int main()
+{
+    const auto count = static_cast<std::size_t>(test::env_number("VAULT_TEST_SMALL_FILES", 10000));
+    const auto min_rate = test::env_number("VAULT_TEST_MIN_FILES_PER_S", 200);
+    const auto rss_budget_mb = test::env_number("VAULT_TEST_RSS_MB", 96);
+    const std::size_t threads = 8;
+    const std::string key = "small-files-key";
+
+    test::TestServer server;
+    client::ApiClient api(server.host(), server.port(), threads);
+    VAULT_CHECK(api.register_user("small", "small-password").success);
+    VAULT_CHECK(api.login("small", "small-password").success);
+
+    const auto rss_before = test::peak_rss_bytes();
+
+    // ── Upload ──────────────────────────────────────────────────────────
+    std::atomic<std::size_t> next{0};
+    std::atomic<std::size_t> failed{0};
+    test::Stopwatch upload_clock;
+    {
+        std::vector<std::thread> workers;
+        for (std::size_t t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&]
+            {
+                for (std::size_t i = next++; i < count; i = next++)
+                {
+                    std::istringstream in(file_body(i));
+                    if (!api.upload_stream(in, file_name(i), key).success) ++failed;
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+    }
+    double upload_s = upload_clock.seconds();
+    VAULT_CHECK_MSG(failed == 0, std::to_string(failed.load()) + " uploads failed");
+
+    // ── List ────────────────────────────────────────────────────────────
+    test::Stopwatch list_clock;
+    auto listing = api.list_files();
+    double list_s = list_clock.seconds();
+    VAULT_CHECK(listing.ok);
+    VAULT_CHECK_MSG(listing.files.size() == count,
+                    "listed " + std::to_string(listing.files.size()) + " of " + std::to_string(count) + " files");
+
+    std::set<std::string> names;
+    for (const auto& f : listing.files) names.insert(f.filename);
+    for (std::size_t i = 0; i < count; i += count / 100 + 1)
+    {
+        VAULT_CHECK_MSG(names.count(file_name(i)) == 1, file_name(i) + " missing from the listing");
+    }
+
+    // ── Read a sample back ──────────────────────────────────────────────
+    for (std::size_t i = 0; i < count; i += count / 100 + 1)
+    {
+        std::ostringstream out;
+        auto result = api.download_stream(file_name(i), out, key);
+        VAULT_CHECK_MSG(result.success, "download of " + file_name(i) + " failed: " + result.message);
+        VAULT_CHECK_MSG(out.str() == file_body(i), file_name(i) + " came back different");
+    }
+
+    // ── Guardrails ──────────────────────────────────────────────────────
+    double rate = count / upload_s;
+    double rss_growth_mb = static_cast<double>(test::peak_rss_bytes() - rss_before) / (1024 * 1024);
+
+    test::report("files", static_cast<double>(count), "");
+    test::report("upload rate", rate, "files/s");
+    test::report("full listing", list_s * 1000, "ms");
+    test::report("peak RSS growth", rss_growth_mb, "MiB");
+
+    VAULT_CHECK_MSG(rate >= min_rate, "uploads slower than " + std::to_string(min_rate) + " files/s");
+    VAULT_CHECK_MSG(rss_growth_mb <= rss_budget_mb,
+                    "peak RSS grew by more than " + std::to_string(rss_budget_mb) + " MiB");
+
+    return test::result();
+}
@@ -0,0 +1,224 @@
+// The same workload against each storage backend, so their throughput can
+// be compared on equal terms: the memory backend is the ceiling, and the
+// gap to it is what disk or network costs.
+//
+// Usage: e2e_storage_backends <local|memory|s3>
+//
+// The s3 run needs an S3-compatible store, e.g. a local MinIO:
+//   VAULT_TEST_S3_ENDPOINT (e.g. http://127.0.0.1:9000), VAULT_TEST_S3_BUCKET
+//   (must exist), AWS_ACCESS_KEY_ID, AWS_SECRET_ACCESS_KEY. Without them it
+//   is reported as skipped. Objects go under a random prefix that is
+//   deleted afterwards.
+//
+// Tuning: VAULT_TEST_BACKEND_FILES (default 500), VAULT_TEST_BACKEND_MB
+// (default 64), VAULT_TEST_MIN_MBPS (default 20, 5 for s3; per direction).
+
+#include "harness.h"
+
+#include "network/api_client.h"
+#include "storage/memory_backend.h"
+#include "storage/s3_backend.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace vault;
+
+/// ctest's SKIP_RETURN_CODE for this test
+static constexpr int kSkipped = 77;
+
+static std::string env_string(const char* name)
+{
+    const char* value = std::getenv(name);
+    return value ? value : "";
+}
+
+/// S3 settings from the environment, or nullopt if any are missing
+static std::optional<server::S3Backend::Options> s3_options()
+{
+    server::S3Backend::Options options;
+    options.endpoint = env_string("VAULT_TEST_S3_ENDPOINT");
+    options.bucket = env_string("VAULT_TEST_S3_BUCKET");
+    options.access_key = env_string("AWS_ACCESS_KEY_ID");
+    options.secret_key = env_string("AWS_SECRET_ACCESS_KEY");
+    if (options.endpoint.empty() || options.bucket.empty() ||
+        options.access_key.empty() || options.secret_key.empty())
+    {
+        return std::nullopt;
+    }
+    options.prefix = "vault-test-" + crypto::generate_token().substr(0, 12) + "/";
+    return options;
+}
+
+static std::string file_name(std::size_t i)
+{
+    return "object-" + std::to_string(i) + ".txt.enc";
+}
+
+static std::string file_body(std::size_t i, int version = 0)
+{
+    std::string line = "object " + std::to_string(i) + " version " + std::to_string(version) + "\n";
+    std::string body;
+    std::size_t size = 200 + (i * 7919) % 8000;
+    while (body.size() < size) body += line;
+    body.resize(size);
+    return body;
+}
+
+static void run_workload(test::TestServer& server, double min_mbps)
+{
+    const auto count = static_cast<std::size_t>(test::env_number("VAULT_TEST_BACKEND_FILES", 500));
+    const auto size_mb = test::env_number("VAULT_TEST_BACKEND_MB", 64);
+    const auto size = static_cast<std::uint64_t>(size_mb * 1024 * 1024);
+    const std::size_t threads = 8;
+    const std::string key = "backend-key";
+
+    client::ApiClient api(server.host(), server.port(), threads);
+    VAULT_CHECK(api.register_user("backend", "backend-password").success);
+    VAULT_CHECK(api.login("backend", "backend-password").success);
+
+    // ── Many small objects ──────────────────────────────────────────────
+    std::atomic<std::size_t> next{0};
+    std::atomic<std::size_t> failed{0};
+    test::Stopwatch small_clock;
+    {
+        std::vector<std::thread> workers;
+        for (std::size_t t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&]
+            {
+                for (std::size_t i = next++; i < count; i = next++)
+                {
+                    std::istringstream in(file_body(i));
+                    if (!api.upload_stream(in, file_name(i), key).success) ++failed;
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+    }
+    double small_s = small_clock.seconds();
+    VAULT_CHECK_MSG(failed == 0, std::to_string(failed.load()) + " small uploads failed");
+
+    test::Stopwatch list_clock;
+    auto listing = api.list_files();
+    double list_s = list_clock.seconds();
+    VAULT_CHECK(listing.ok);
+    std::set<std::string> names;
+    for (const auto& f : listing.files) names.insert(f.filename);
+    VAULT_CHECK_MSG(names.size() == count,
+                    "listed " + std::to_string(names.size()) + " of " + std::to_string(count) + " objects");
+
+    next = 0;
+    failed = 0;
+    test::Stopwatch read_clock;
+    {
+        std::vector<std::thread> workers;
+        for (std::size_t t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&]
+            {
+                for (std::size_t i = next++; i < count; i = next++)
+                {
+                    std::ostringstream out;
+                    if (!api.download_stream(file_name(i), out, key).success || out.str() != file_body(i)) ++failed;
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+    }
+    double read_s = read_clock.seconds();
+    VAULT_CHECK_MSG(failed == 0, std::to_string(failed.load()) + " small downloads failed or differed");
+
+    // A replace is visible whole
+    {
+        std::istringstream in(file_body(0, 1));
+        VAULT_CHECK(api.upload_stream(in, file_name(0), key).success);
+        std::ostringstream out;
+        VAULT_CHECK(api.download_stream(file_name(0), out, key).success);
+        VAULT_CHECK_MSG(out.str() == file_body(0, 1), "replaced object came back stale");
+    }
+
+    // ── One large object ────────────────────────────────────────────────
+    test::PatternSource source(size, 0xba5e);
+    std::istream in(&source);
+    test::Stopwatch upload_clock;
+    auto uploaded = api.upload_stream(in, "large.bin.enc", key);
+    double upload_s = upload_clock.seconds();
+    VAULT_CHECK_MSG(uploaded.success, "large upload failed: " + uploaded.message);
+
+    test::HashingSink sink;
+    std::ostream out(&sink);
+    test::Stopwatch download_clock;
+    auto downloaded = api.download_stream("large.bin.enc", out, key);
+    double download_s = download_clock.seconds();
+    VAULT_CHECK_MSG(downloaded.success, "large download failed: " + downloaded.message);
+    VAULT_CHECK(sink.size() == size);
+    VAULT_CHECK_MSG(sink.hash() == source.hash(), "large object came back different");
+
+    // The backend hands back exactly what the recorded hash describes
+    VAULT_CHECK(server.storage().verify_object("backend", "large.bin.enc") ==
+                server::StorageManager::Verdict::Intact);
+
+    // ── Results ─────────────────────────────────────────────────────────
+    double upload_mbps = size_mb / upload_s;
+    double download_mbps = size_mb / download_s;
+
+    test::report("small uploads", count / small_s, "objects/s");
+    test::report("small downloads", count / read_s, "objects/s");
+    test::report("listing", list_s * 1000, "ms");
+    test::report("large upload", upload_mbps, "MiB/s");
+    test::report("large download", download_mbps, "MiB/s");
+
+    VAULT_CHECK_MSG(upload_mbps >= min_mbps, "upload slower than " + std::to_string(min_mbps) + " MiB/s");
+    VAULT_CHECK_MSG(download_mbps >= min_mbps, "download slower than " + std::to_string(min_mbps) + " MiB/s");
+}
+
+int main(int argc, char* argv[])
+{
+    std::string kind = argc > 1 ? argv[1] : "local";
+    std::unique_ptr<server::StorageBackend> backend;
+    std::optional<server::S3Backend::Options> s3;
+
+    if (kind == "memory")
+    {
+        backend = std::make_unique<server::MemoryBackend>();
+    }
+    else if (kind == "s3")
+    {
+        s3 = s3_options();
+        if (!s3)
+        {
+            std::cout << "skipped: set VAULT_TEST_S3_ENDPOINT, VAULT_TEST_S3_BUCKET, "
+                         "AWS_ACCESS_KEY_ID and AWS_SECRET_ACCESS_KEY" << std::endl;
+            return kSkipped;
+        }
+        backend = std::make_unique<server::S3Backend>(*s3);
+    }
+    else if (kind != "local")
+    {
+        std::cerr << "Unknown backend: " << kind << std::endl;
+        return 2;
+    }
+
+    std::cout << "backend: " << kind << std::endl;
+    {
+        test::TestServer server(test::TestServer::Core::Threads, std::move(backend));
+        run_workload(server, test::env_number("VAULT_TEST_MIN_MBPS", kind == "s3" ? 5 : 20));
+    }
+
+    // Leave the bucket as it was
+    if (s3)
+    {
+        server::S3Backend cleanup(*s3);
+        for (const auto& entry : cleanup.list("", true)) cleanup.remove(entry.key);
+    }
+
+    return test::result();
+}
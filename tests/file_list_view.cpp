@@ -0,0 +1,70 @@
+// The Files screen's filter, without a terminal.
+//
+// Names in mixed case must give the same rows for a prefix query ("^al")
+// as the matching substring query, in the same order, and the selection
+// must survive a refresh.
+
+#include "harness.h"
+
+#include "tui/file_list_view.h"
+
+#include <cctype>
+#include <string>
+#include <vector>
+
+using namespace vault;
+
+static std::vector<std::string> names(const client::FileListView& view)
+{
+    std::vector<std::string> out;
+    for (std::size_t i = 0; i < view.size(); ++i) out.push_back(view.row(i).name);
+    return out;
+}
+
+int main()
+{
+    std::vector<models::FileMeta> files;
+    for (const char* name : {"Zeta.txt.enc", "alpha.txt.enc", "Beta.enc", "ALPINE.enc", "beta2.enc"})
+    {
+        files.push_back({name, 100, "2024-01-01 00:00:00"});
+    }
+
+    client::FileListView view;
+    view.set_files(files);
+    VAULT_CHECK(view.total() == 5);
+    VAULT_CHECK((names(view) == std::vector<std::string>{"alpha.txt.enc", "ALPINE.enc", "Beta.enc",
+                                                          "beta2.enc", "Zeta.txt.enc"}));
+
+    for (const char* prefix : {"al", "AL", "b", "beta", "z", "alpha", "x"})
+    {
+        view.set_filter(prefix);
+        auto substring = names(view);
+        std::vector<std::string> expected;
+        for (const auto& name : substring)
+        {
+            std::string lower;
+            for (char c : name) lower += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            std::string p = prefix;
+            for (auto& c : p) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            if (lower.compare(0, p.size(), p) == 0) expected.push_back(name);
+        }
+
+        view.set_filter(std::string("^") + prefix);
+        VAULT_CHECK_MSG(names(view) == expected, std::string("prefix ^") + prefix + " disagrees with substring match");
+    }
+
+    view.set_filter("^al");
+    VAULT_CHECK(view.size() == 2);
+    view.set_filter("^b");
+    VAULT_CHECK(view.size() == 2);
+
+    // The selection follows its file across a refresh
+    view.set_filter("");
+    view.move(3);
+    VAULT_CHECK(view.row(view.selected()).name == "beta2.enc");
+    files.push_back({"Alpha.txt.enc", 1, "2024-01-02 00:00:00"});
+    view.set_files(files);
+    VAULT_CHECK(view.row(view.selected()).name == "beta2.enc");
+
+    return test::result();
+}
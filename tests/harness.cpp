@@ -0,0 +1,190 @@
+#include "harness.h"
+
+#include "config/server_config.h"
+#include "logging/logger.h"
+#include "routes/routes.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace vault::test
+{
+
+    // ─── Assertions ─────────────────────────────────────────────────────────────
+
+    static std::atomic<int> g_failures{0};
+
+    void fail(const char* file, int line, const std::string& message)
+    {
+        ++g_failures;
+        std::cerr << file << ":" << line << ": FAILED: " << message << std::endl;
+    }
+
+    int result()
+    {
+        int failures = g_failures.load();
+        std::cout << (failures == 0 ? "PASSED" : std::to_string(failures) + " check(s) FAILED") << std::endl;
+        return failures == 0 ? 0 : 1;
+    }
+
+    // ─── Environment ────────────────────────────────────────────────────────────
+
+    double env_number(const char* name, double fallback)
+    {
+        const char* value = std::getenv(name);
+        if (!value || !*value) return fallback;
+        try
+        {
+            return std::stod(value);
+        }
+        catch (const std::exception&)
+        {
+            throw std::runtime_error(std::string("Bad number in $") + name + ": " + value);
+        }
+    }
+
+    std::uint64_t peak_rss_bytes()
+    {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters{};
+        GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+        return counters.PeakWorkingSetSize;
+#else
+        struct rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+        return static_cast<std::uint64_t>(usage.ru_maxrss);          // bytes
+#else
+        return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;   // KiB
+#endif
+#endif
+    }
+
+    void report(const std::string& name, double value, const char* unit)
+    {
+        std::cout << "  " << name << ": " << value << " " << unit << std::endl;
+    }
+
+    // ─── Test Server ────────────────────────────────────────────────────────────
+
+    TestServer::TestServer(Core core, std::unique_ptr<server::StorageBackend> backend)
+    {
+        // Warnings only: a line per request would dominate the timings
+        logging::Options log_options;
+        log_options.min_level = logging::Level::Warn;
+        logging::start(log_options);
+
+        root_ = std::filesystem::temp_directory_path() / ("vault-test-" + crypto::generate_token().substr(0, 12));
+        std::filesystem::create_directories(root_);
+
+        server::ServerConfig config;
+        config.worker_threads = 16;
+        config.keep_alive_max_count = 1000;
+        config.read_timeout = 30;
+        config.write_timeout = 30;
+
+        auth_ = std::make_unique<server::AuthManager>(root_ / "data", config.hash_threads, config.hash_queue);
+        storage_ = backend
+            ? std::make_unique<server::StorageManager>(std::move(backend), config.store_threads)
+            : std::make_unique<server::StorageManager>(storage_dir(), config.store_threads);
+
+        server::RouteOptions route_options;
+        route_options.metrics = &metrics_;
+
+        if (core == Core::Event)
+        {
+            config.listeners = 2;
+            config.keep_alive_max_count = 0;
+            config.keep_alive_timeout = 300;
+            event_server_ = std::make_unique<server::EventServer>(server::event_server_options(config));
+            server::setup_routes(*event_server_, *auth_, *storage_, route_options);
+
+            if (!event_server_->bind(host_, 0))
+            {
+                throw std::runtime_error("Cannot bind a loopback port");
+            }
+            port_ = event_server_->port();
+            // Bound already, so connections queue in the backlog until run() starts
+            thread_ = std::thread([this] { event_server_->run(); });
+            return;
+        }
+
+        server::apply_server_config(server_, config);
+        server::setup_routes(server_, *auth_, *storage_, route_options);
+
+        port_ = server_.bind_to_any_port(host_);
+        if (port_ <= 0)
+        {
+            throw std::runtime_error("Cannot bind a loopback port");
+        }
+        thread_ = std::thread([this] { server_.listen_after_bind(); });
+        server_.wait_until_ready();
+    }
+
+    TestServer::~TestServer()
+    {
+        if (event_server_) event_server_->stop();
+        else server_.stop();
+        if (thread_.joinable()) thread_.join();
+        event_server_.reset();
+        storage_.reset();
+        auth_.reset();
+        logging::stop();
+
+        std::error_code ec;
+        std::filesystem::remove_all(root_, ec);
+    }
+
+    // ─── Stream Helpers ─────────────────────────────────────────────────────────
+
+    PatternSource::PatternSource(std::uint64_t size, std::uint64_t seed)
+        : remaining_(size), state_(seed | 1)
+    {
+    }
+
+    PatternSource::int_type PatternSource::underflow()
+    {
+        if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+        if (remaining_ == 0) return traits_type::eof();
+
+        // xorshift64: incompressible, cheap, and reproducible from the seed
+        std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(remaining_, sizeof(block_)));
+        for (std::size_t i = 0; i < n; i += 8)
+        {
+            state_ ^= state_ << 13;
+            state_ ^= state_ >> 7;
+            state_ ^= state_ << 17;
+            std::memcpy(block_ + i, &state_, std::min<std::size_t>(8, n - i));
+        }
+        remaining_ -= n;
+        hasher_.update(block_, n);
+        setg(block_, block_, block_ + n);
+        return traits_type::to_int_type(*gptr());
+    }
+
+    HashingSink::int_type HashingSink::overflow(int_type c)
+    {
+        if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+        char byte = traits_type::to_char_type(c);
+        xsputn(&byte, 1);
+        return c;
+    }
+
+    std::streamsize HashingSink::xsputn(const char* data, std::streamsize n)
+    {
+        hasher_.update(data, static_cast<std::size_t>(n));
+        size_ += static_cast<std::uint64_t>(n);
+        return n;
+    }
+
+} // namespace vault::test
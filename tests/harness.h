@@ -0,0 +1,153 @@
+#pragma once
+
+#include "auth/auth_manager.h"
+#include "core/event_server.h"
+#include "crypto/crypto.h"
+#include "metrics/metrics.h"
+#include "storage/storage_manager.h"
+
+#include <httplib.h>
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <thread>
+
+namespace vault::test
+{
+
+    // ─── Assertions ─────────────────────────────────────────────────────────────
+
+    /// Record a failure and keep going, so one run reports every regression
+    void fail(const char* file, int line, const std::string& message);
+
+    /// 0 if nothing failed, else 1; return it from main()
+    int result();
+
+#define VAULT_CHECK(cond)                                                        \
+    do                                                                           \
+    {                                                                            \
+        if (!(cond)) ::vault::test::fail(__FILE__, __LINE__, "CHECK(" #cond ")"); \
+    } while (0)
+
+#define VAULT_CHECK_MSG(cond, msg)                                               \
+    do                                                                           \
+    {                                                                            \
+        if (!(cond)) ::vault::test::fail(__FILE__, __LINE__, (msg));             \
+    } while (0)
+
+    // ─── Environment ────────────────────────────────────────────────────────────
+
+    /// Numeric tuning knob from the environment, e.g. VAULT_TEST_LARGE_MB,
+    /// so slow CI machines can relax a threshold without editing the test
+    double env_number(const char* name, double fallback);
+
+    /// Peak resident set size of this process so far, in bytes
+    std::uint64_t peak_rss_bytes();
+
+    /// Print one "name: value unit" result line; ctest shows it with -V
+    void report(const std::string& name, double value, const char* unit);
+
+    /// Seconds since construction
+    class Stopwatch
+    {
+    public:
+        Stopwatch() : start_(std::chrono::steady_clock::now()) {}
+
+        double seconds() const
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+        }
+
+    private:
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    // ─── Test Server ────────────────────────────────────────────────────────────
+
+    /// The real route table, AuthManager and StorageManager listening on a
+    /// free loopback port, with data and storage in a fresh temp directory
+    /// that is removed afterwards. One per process.
+    class TestServer
+    {
+    public:
+        /// Which server core serves the routes (vault_server --core)
+        enum class Core
+        {
+            Threads,
+            Event
+        };
+
+        /// Objects go to `backend`, or to local disk under the temp
+        /// directory if none is given
+        explicit TestServer(Core core = Core::Threads,
+                            std::unique_ptr<server::StorageBackend> backend = nullptr);
+        ~TestServer();
+
+        TestServer(const TestServer&) = delete;
+        TestServer& operator=(const TestServer&) = delete;
+
+        const std::string& host() const { return host_; }
+        int port() const { return port_; }
+
+        server::AuthManager& auth() { return *auth_; }
+        server::StorageManager& storage() { return *storage_; }
+
+        /// Where objects live when no backend was given ("<user>/<file>")
+        std::filesystem::path storage_dir() const { return root_ / "storage"; }
+
+    private:
+        std::filesystem::path root_;
+        std::string host_ = "127.0.0.1";
+        int port_ = 0;
+        std::unique_ptr<server::AuthManager> auth_;
+        std::unique_ptr<server::StorageManager> storage_;
+        server::Metrics metrics_;       // served on GET /metrics, as vault_server does
+        httplib::Server server_;
+        std::unique_ptr<server::EventServer> event_server_;
+        std::thread thread_;
+    };
+
+    // ─── Stream Helpers ─────────────────────────────────────────────────────────
+
+    /// Reads `size` deterministic pseudo-random bytes without ever holding
+    /// more than one block, and hashes them as they are handed out
+    class PatternSource : public std::streambuf
+    {
+    public:
+        PatternSource(std::uint64_t size, std::uint64_t seed);
+
+        /// SHA-256 of the bytes read so far
+        std::string hash() { return hasher_.final_hex(); }
+
+    protected:
+        int_type underflow() override;
+
+    private:
+        std::uint64_t remaining_;
+        std::uint64_t state_;
+        char block_[64 * 1024];
+        crypto::Sha256 hasher_;
+    };
+
+    /// Discards what is written to it, keeping only a running hash and count
+    class HashingSink : public std::streambuf
+    {
+    public:
+        std::string hash() { return hasher_.final_hex(); }
+        std::uint64_t size() const { return size_; }
+
+    protected:
+        int_type overflow(int_type c) override;
+        std::streamsize xsputn(const char* data, std::streamsize n) override;
+
+    private:
+        std::uint64_t size_ = 0;
+        crypto::Sha256 hasher_;
+    };
+
+} // namespace vault::test
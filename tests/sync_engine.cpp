@@ -0,0 +1,134 @@
+// Directory sync against a live server.
+//
+// local_path() must refuse every remote name that would land outside the
+// tree. On the first run, a file already on the server is adopted only
+// when its plaintext is identical: an edit that keeps the ciphertext size
+// (same 16-byte padding bucket) is a conflict, settled by --prefer. A
+// second run afterwards has nothing left to do.
+
+#include "harness.h"
+
+#include "network/api_client.h"
+#include "sync/sync_engine.h"
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+
+using namespace vault;
+namespace fs = std::filesystem;
+
+static const char* const kPrefix = "tree-";
+static const char* const kKey = "sync-key";
+
+static void write_file(const fs::path& path, const std::string& body)
+{
+    fs::create_directories(path.parent_path());
+    std::ofstream out(path, std::ios::binary);
+    out << body;
+}
+
+static std::string read_file(const fs::path& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream body;
+    body << in.rdbuf();
+    return body.str();
+}
+
+static bool put(client::ApiClient& api, const std::string& rel, const std::string& body)
+{
+    std::istringstream in(body);
+    return api.upload_stream(in, client::SyncEngine::remote_name(kPrefix, rel), kKey).success;
+}
+
+static std::string get(client::ApiClient& api, const std::string& rel)
+{
+    std::ostringstream out;
+    if (!api.download_stream(client::SyncEngine::remote_name(kPrefix, rel), out, kKey).success) return "";
+    return out.str();
+}
+
+static client::SyncReport sync(const std::shared_ptr<client::ApiClient>& api, const fs::path& root, bool dry_run)
+{
+    client::SyncOptions options;
+    options.password = kKey;
+    options.prefix = kPrefix;
+    options.dry_run = dry_run;
+    client::SyncEngine engine(api, root, options);
+    return engine.run();
+}
+
+int main()
+{
+    using client::SyncEngine;
+
+    // ── Remote names ────────────────────────────────────────────────────
+    VAULT_CHECK(SyncEngine::remote_name(kPrefix, "docs/a.txt") == "tree-docs%2Fa.txt.enc");
+    VAULT_CHECK(SyncEngine::local_path(kPrefix, "tree-docs%2Fa.txt.enc") == std::optional<std::string>("docs/a.txt"));
+    for (const char* name : {"tree-..%2Fx.enc", "tree-a%2F..%2Fb.enc", "tree-%2Fetc%2Fpasswd.enc",
+                             "tree-a%2F%2Fb.enc", "tree-.%2Fa.enc", "tree-a%5Cb.enc", "tree-c%3Ax.enc",
+                             "tree-.vaultsync%2Fstate.enc", "tree-%2e%2e%2Fx.enc", "tree-a.txt",
+                             "other-a.txt.enc", "tree-.enc"})
+    {
+        VAULT_CHECK_MSG(!SyncEngine::local_path(kPrefix, name), std::string("accepted ") + name);
+    }
+
+    // ── First run ───────────────────────────────────────────────────────
+    test::TestServer server;
+    auto api = std::make_shared<client::ApiClient>(server.host(), server.port(), 2);
+    VAULT_CHECK(api->register_user("syncer", "sync-password").success);
+    VAULT_CHECK(api->login("syncer", "sync-password").success);
+
+    auto root = fs::temp_directory_path() / ("vault-sync-" + crypto::generate_token().substr(0, 12));
+
+    // Identical on both sides
+    write_file(root / "same.txt", std::string(100, 's'));
+    VAULT_CHECK(put(*api, "same.txt", std::string(100, 's')));
+    // 100 and 105 bytes both pad to 112, so only the content tells them apart
+    write_file(root / "docs" / "edited.txt", std::string(105, 'l'));
+    VAULT_CHECK(put(*api, "docs/edited.txt", std::string(100, 'r')));
+    // Different sizes
+    write_file(root / "grown.txt", std::string(40, 'l'));
+    VAULT_CHECK(put(*api, "grown.txt", std::string(10, 'r')));
+    // One side only
+    write_file(root / "new" / "local.txt", "local only");
+    VAULT_CHECK(put(*api, "remote.txt", "remote only"));
+
+    auto plan = sync(api, root, true);
+    VAULT_CHECK(plan.scanned == 4);
+    VAULT_CHECK(plan.adopted == 1);
+    VAULT_CHECK(plan.conflicts == 2);
+    VAULT_CHECK(plan.uploaded == 3);
+    VAULT_CHECK(plan.downloaded == 1);
+    VAULT_CHECK(plan.failed == 0);
+    VAULT_CHECK(!fs::exists(root / "remote.txt"));
+    VAULT_CHECK(get(*api, "docs/edited.txt") == std::string(100, 'r'));
+
+    auto first = sync(api, root, false);
+    VAULT_CHECK(first.adopted == 1);
+    VAULT_CHECK(first.conflicts == 2);
+    VAULT_CHECK(first.uploaded == 3);
+    VAULT_CHECK(first.downloaded == 1);
+    VAULT_CHECK(first.failed == 0);
+    VAULT_CHECK(get(*api, "docs/edited.txt") == std::string(105, 'l'));
+    VAULT_CHECK(get(*api, "grown.txt") == std::string(40, 'l'));
+    VAULT_CHECK(get(*api, "new/local.txt") == "local only");
+    VAULT_CHECK(read_file(root / "remote.txt") == "remote only");
+
+    // ── Second run ──────────────────────────────────────────────────────
+    auto second = sync(api, root, false);
+    VAULT_CHECK(second.scanned == 5);
+    VAULT_CHECK(second.unchanged == 5);
+    VAULT_CHECK(second.adopted == 0);
+    VAULT_CHECK(second.conflicts == 0);
+    VAULT_CHECK(second.uploaded == 0);
+    VAULT_CHECK(second.downloaded == 0);
+
+    std::error_code ec;
+    fs::remove_all(root, ec);
+    return test::result();
+}
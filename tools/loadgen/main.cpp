@@ -0,0 +1,558 @@
+// vault_loadgen — drives vault_server with simulated users and reports
+// throughput and latency percentiles as JSON.
+//
+// Closed loop: each user issues its next operation as soon as the last one
+// (plus optional think time) completes. Open loop: operations arrive at a
+// fixed rate regardless of how fast the server answers, and latency is
+// measured from the scheduled arrival, so queueing delay is not hidden.
+
+#include "network/api_client.h"
+#include "crypto/crypto.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <random>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+
+    // ─── Configuration ──────────────────────────────────────────────────────────
+
+    enum Op { Register, Login, Upload, Download, List, kOpCount };
+
+    const char* const kOpNames[kOpCount] = {"register", "login", "upload", "download", "list"};
+
+    /// Upload sizes: fixed:N, uniform:MIN:MAX or lognormal:MEDIAN:SIGMA
+    struct SizeDistribution
+    {
+        enum Kind { Fixed, Uniform, LogNormal } kind = Fixed;
+        double a = 64 * 1024;
+        double b = 0;
+
+        std::size_t sample(std::mt19937_64& rng) const
+        {
+            double size = a;
+            if (kind == Uniform)
+            {
+                size = std::uniform_real_distribution<double>(a, b)(rng);
+            }
+            else if (kind == LogNormal)
+            {
+                size = std::lognormal_distribution<double>(std::log(a), b)(rng);
+            }
+            return static_cast<std::size_t>(std::max(0.0, size));
+        }
+    };
+
+    struct Config
+    {
+        std::string host = "localhost";
+        int port = 8080;
+        std::size_t users = 8;
+        double duration = 30;              // seconds of measured load
+        double warmup = 2;                 // seconds run but not recorded
+        bool open_loop = false;
+        double rate = 100;                 // open loop: operations per second
+        std::chrono::milliseconds think{0};
+        double weights[kOpCount] = {0, 1, 2, 5, 2};
+        SizeDistribution sizes;
+        std::string key = "loadgen-key";
+        std::string output;                // JSON report path; stdout when empty
+    };
+
+    /// "64K", "1.5M", "2G" → bytes
+    double parse_size(const std::string& text)
+    {
+        std::size_t used = 0;
+        double value = std::stod(text, &used);
+        std::string unit = text.substr(used);
+        if (unit == "K" || unit == "k") value *= 1024;
+        else if (unit == "M" || unit == "m") value *= 1024 * 1024;
+        else if (unit == "G" || unit == "g") value *= 1024.0 * 1024 * 1024;
+        else if (!unit.empty()) throw std::invalid_argument("bad size: " + text);
+        return value;
+    }
+
+    std::vector<std::string> split(const std::string& text, char sep)
+    {
+        std::vector<std::string> parts;
+        std::stringstream in(text);
+        for (std::string part; std::getline(in, part, sep);) parts.push_back(part);
+        return parts;
+    }
+
+    SizeDistribution parse_distribution(const std::string& text)
+    {
+        auto parts = split(text, ':');
+        SizeDistribution d;
+        if (parts.size() == 2 && parts[0] == "fixed")
+        {
+            d.a = parse_size(parts[1]);
+        }
+        else if (parts.size() == 3 && parts[0] == "uniform")
+        {
+            d.kind = SizeDistribution::Uniform;
+            d.a = parse_size(parts[1]);
+            d.b = parse_size(parts[2]);
+        }
+        else if (parts.size() == 3 && parts[0] == "lognormal")
+        {
+            d.kind = SizeDistribution::LogNormal;
+            d.a = parse_size(parts[1]);
+            d.b = std::stod(parts[2]);
+        }
+        else
+        {
+            throw std::invalid_argument("bad size distribution: " + text);
+        }
+        return d;
+    }
+
+    /// "upload=3,download=5,list=2" → weights; unnamed operations get 0
+    void parse_mix(const std::string& text, double (&weights)[kOpCount])
+    {
+        std::fill(std::begin(weights), std::end(weights), 0.0);
+        for (const auto& item : split(text, ','))
+        {
+            auto kv = split(item, '=');
+            auto it = std::find_if(std::begin(kOpNames), std::end(kOpNames),
+                                   [&](const char* name) { return kv.size() == 2 && kv[0] == name; });
+            if (it == std::end(kOpNames)) throw std::invalid_argument("bad mix entry: " + item);
+            weights[it - std::begin(kOpNames)] = std::stod(kv[1]);
+        }
+    }
+
+    void print_usage()
+    {
+        std::cout << "Usage: vault_loadgen [options]\n"
+                  << "  --host, -H <host>       Server host (default: localhost)\n"
+                  << "  --port, -p <port>       Server port (default: 8080)\n"
+                  << "  --users <n>             Concurrent simulated users (default: 8)\n"
+                  << "  --duration <s>          Measured seconds (default: 30)\n"
+                  << "  --warmup <s>            Unmeasured seconds first (default: 2)\n"
+                  << "  --mode closed|open      Closed loop, or fixed arrival rate (default: closed)\n"
+                  << "  --rate <ops/s>          Arrival rate in open loop (default: 100)\n"
+                  << "  --think <ms>            Closed loop pause between operations (default: 0)\n"
+                  << "  --mix <op=w,...>        Weights for register, login, upload, download, list\n"
+                  << "                          (default: login=1,upload=2,download=5,list=2)\n"
+                  << "  --sizes <dist>          fixed:N | uniform:MIN:MAX | lognormal:MEDIAN:SIGMA\n"
+                  << "                          sizes take K/M/G suffixes (default: fixed:64K)\n"
+                  << "  --output <file>         Write the JSON report here instead of stdout\n"
+                  << "\n"
+                  << "Run the server with --no-rate-limit, or 429s will dominate the results.\n";
+    }
+
+    // ─── Measurement ────────────────────────────────────────────────────────────
+
+    /// Per-thread samples, merged once at the end so recording never contends
+    struct Recorder
+    {
+        std::vector<double> latency_us[kOpCount];
+        std::uint64_t errors[kOpCount] = {};
+        std::uint64_t rate_limited[kOpCount] = {};
+        std::uint64_t bytes[kOpCount] = {};
+
+        void merge(const Recorder& other)
+        {
+            for (int op = 0; op < kOpCount; ++op)
+            {
+                latency_us[op].insert(latency_us[op].end(), other.latency_us[op].begin(),
+                                      other.latency_us[op].end());
+                errors[op] += other.errors[op];
+                rate_limited[op] += other.rate_limited[op];
+                bytes[op] += other.bytes[op];
+            }
+        }
+    };
+
+    double percentile(const std::vector<double>& sorted, double p)
+    {
+        if (sorted.empty()) return 0;
+        auto rank = static_cast<std::size_t>(std::ceil(p / 100.0 * sorted.size()));
+        return sorted[std::min(sorted.size() - 1, rank == 0 ? 0 : rank - 1)];
+    }
+
+    json latency_summary(std::vector<double>& samples)
+    {
+        std::sort(samples.begin(), samples.end());
+        double sum = 0;
+        for (double s : samples) sum += s;
+        auto ms = [](double us) { return std::round(us) / 1000.0; };
+        return {
+            {"mean", ms(samples.empty() ? 0 : sum / samples.size())},
+            {"p50", ms(percentile(samples, 50))},
+            {"p90", ms(percentile(samples, 90))},
+            {"p99", ms(percentile(samples, 99))},
+            {"p999", ms(percentile(samples, 99.9))},
+            {"max", ms(samples.empty() ? 0 : samples.back())},
+        };
+    }
+
+    /// Discards everything written to it (download sink)
+    class NullBuffer : public std::streambuf
+    {
+    protected:
+        int overflow(int c) override { return c; }
+        std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+    };
+
+    // ─── Simulated User ─────────────────────────────────────────────────────────
+
+    class User
+    {
+    public:
+        User(const Config& config, std::string name, std::uint64_t seed)
+            : config_(config),
+              name_(std::move(name)),
+              password_("pw-" + name_),
+              api_(config.host, config.port, 1),
+              rng_(seed)
+        {
+        }
+
+        /// Register, log in and upload one file so downloads have a target
+        bool setup()
+        {
+            if (!api_.register_user(name_, password_).success) return false;
+            if (!api_.login(name_, password_).success) return false;
+            return upload(1024).success;
+        }
+
+        Op pick()
+        {
+            std::discrete_distribution<int> dist(std::begin(config_.weights), std::end(config_.weights));
+            return static_cast<Op>(dist(rng_));
+        }
+
+        /// Run one operation and record it when `record` is set
+        void run(Op op, Clock::time_point start, bool record, Recorder& out)
+        {
+            vault::client::ApiResult result;
+            std::uint64_t bytes = 0;
+
+            switch (op)
+            {
+                case Register:
+                {
+                    std::string fresh = name_ + "-r" + std::to_string(registered_++);
+                    result = api_.register_user(fresh, password_);
+                    break;
+                }
+                case Login:
+                    result = api_.login(name_, password_);
+                    break;
+                case Upload:
+                {
+                    std::size_t size = config_.sizes.sample(rng_);
+                    result = upload(size);
+                    bytes = size;
+                    break;
+                }
+                case Download:
+                {
+                    const auto& name = files_[std::uniform_int_distribution<std::size_t>(0, files_.size() - 1)(rng_)];
+                    NullBuffer sink_buffer;
+                    std::ostream sink(&sink_buffer);
+                    result = api_.download_stream(name, sink, config_.key,
+                        [&bytes](std::uint64_t done, std::uint64_t) { bytes = done; return true; });
+                    break;
+                }
+                case List:
+                    result.success = api_.list_files().ok;
+                    break;
+                case kOpCount:
+                    break;
+            }
+
+            if (!record) return;
+            auto elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+            out.latency_us[op].push_back(elapsed);
+            out.bytes[op] += bytes;
+            if (!result.success)
+            {
+                ++out.errors[op];
+                if (result.status == 429) ++out.rate_limited[op];
+            }
+        }
+
+    private:
+        vault::client::ApiResult upload(std::size_t size)
+        {
+            // Incompressible bytes; the PRNG fill is negligible next to AES
+            std::string body(size, '\0');
+            for (std::size_t i = 0; i + 8 <= size; i += 8)
+            {
+                std::uint64_t word = rng_();
+                std::memcpy(body.data() + i, &word, 8);
+            }
+            std::istringstream in(std::move(body));
+
+            // A bounded set of names per user, so the store doesn't grow forever
+            std::string name = "load-" + std::to_string(uploads_++ % 64) + ".bin";
+            auto result = api_.upload_stream(in, name, config_.key);
+            if (result.success && std::find(files_.begin(), files_.end(), name) == files_.end())
+            {
+                files_.push_back(name);
+            }
+            return result;
+        }
+
+        const Config& config_;
+        std::string name_;
+        std::string password_;
+        vault::client::ApiClient api_;
+        std::mt19937_64 rng_;
+        std::vector<std::string> files_;
+        std::uint64_t uploads_ = 0;
+        std::uint64_t registered_ = 0;
+    };
+
+} // namespace
+
+// ─── Main ──────────────────────────────────────────────────────────────────────
+
+int main(int argc, char* argv[])
+{
+    Config config;
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            bool has_value = i + 1 < argc;
+            if ((arg == "--host" || arg == "-H") && has_value) config.host = argv[++i];
+            else if ((arg == "--port" || arg == "-p") && has_value) config.port = std::stoi(argv[++i]);
+            else if (arg == "--users" && has_value) config.users = std::stoul(argv[++i]);
+            else if (arg == "--duration" && has_value) config.duration = std::stod(argv[++i]);
+            else if (arg == "--warmup" && has_value) config.warmup = std::stod(argv[++i]);
+            else if (arg == "--mode" && has_value)
+            {
+                std::string mode = argv[++i];
+                if (mode != "open" && mode != "closed") throw std::invalid_argument("bad mode: " + mode);
+                config.open_loop = mode == "open";
+            }
+            else if (arg == "--rate" && has_value) config.rate = std::stod(argv[++i]);
+            else if (arg == "--think" && has_value) config.think = std::chrono::milliseconds(std::stoi(argv[++i]));
+            else if (arg == "--mix" && has_value) parse_mix(argv[++i], config.weights);
+            else if (arg == "--sizes" && has_value) config.sizes = parse_distribution(argv[++i]);
+            else if (arg == "--output" && has_value) config.output = argv[++i];
+            else if (arg == "--help")
+            {
+                print_usage();
+                return 0;
+            }
+            else throw std::invalid_argument("unknown option: " + arg);
+        }
+        if (config.users == 0 || config.duration <= 0 || config.rate <= 0)
+        {
+            throw std::invalid_argument("--users, --duration and --rate must be positive");
+        }
+        if (std::all_of(std::begin(config.weights), std::end(config.weights), [](double w) { return w <= 0; }))
+        {
+            throw std::invalid_argument("--mix needs at least one positive weight");
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "vault_loadgen: " << e.what() << "\n";
+        print_usage();
+        return 2;
+    }
+
+    // ── Set up users ────────────────────────────────────────────────────
+    std::string run_id = vault::crypto::generate_token().substr(0, 8);
+    std::vector<std::unique_ptr<User>> users;
+    std::random_device seed;
+    for (std::size_t i = 0; i < config.users; ++i)
+    {
+        users.push_back(std::make_unique<User>(config, "lg" + run_id + "u" + std::to_string(i),
+                                               (static_cast<std::uint64_t>(seed()) << 32) | seed()));
+    }
+
+    std::atomic<std::size_t> ready{0};
+    {
+        std::vector<std::thread> setup;
+        for (auto& user : users)
+        {
+            setup.emplace_back([&ready, &user] { if (user->setup()) ++ready; });
+        }
+        for (auto& t : setup) t.join();
+    }
+    if (ready != users.size())
+    {
+        std::cerr << "vault_loadgen: only " << ready << " of " << users.size()
+                  << " users could register, log in and upload\n";
+        return 1;
+    }
+    std::cerr << "vault_loadgen: " << users.size() << " users ready, running "
+              << (config.open_loop ? "open" : "closed") << " loop for "
+              << config.warmup << "s warmup + " << config.duration << "s\n";
+
+    // ── Run ─────────────────────────────────────────────────────────────
+    auto begin = Clock::now();
+    auto measure_from = begin + std::chrono::duration_cast<Clock::duration>(
+                                    std::chrono::duration<double>(config.warmup));
+    auto end = measure_from + std::chrono::duration_cast<Clock::duration>(
+                                  std::chrono::duration<double>(config.duration));
+
+    std::vector<Recorder> recorders(users.size());
+    std::vector<std::thread> workers;
+
+    // Open loop: a scheduler hands out arrival times; any idle user takes one
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    std::deque<Clock::time_point> arrivals;
+    bool scheduling = true;
+    std::uint64_t dropped = 0;   // arrivals still queued when the run ended
+
+    for (std::size_t i = 0; i < users.size(); ++i)
+    {
+        workers.emplace_back([&, i]
+        {
+            User& user = *users[i];
+            Recorder& out = recorders[i];
+
+            if (!config.open_loop)
+            {
+                while (Clock::now() < end)
+                {
+                    auto start = Clock::now();
+                    user.run(user.pick(), start, start >= measure_from, out);
+                    if (config.think.count() > 0) std::this_thread::sleep_for(config.think);
+                }
+                return;
+            }
+
+            for (;;)
+            {
+                Clock::time_point scheduled;
+                {
+                    std::unique_lock<std::mutex> lock(queue_mutex);
+                    queue_cv.wait(lock, [&] { return !arrivals.empty() || !scheduling; });
+                    if (arrivals.empty()) return;
+                    scheduled = arrivals.front();
+                    arrivals.pop_front();
+                }
+                // Latency counts from when the request should have been sent
+                user.run(user.pick(), scheduled, scheduled >= measure_from, out);
+            }
+        });
+    }
+
+    if (config.open_loop)
+    {
+        auto interval = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(1.0 / config.rate));
+        for (auto next = begin; next < end; next += interval)
+        {
+            std::this_thread::sleep_until(next);
+            {
+                std::lock_guard<std::mutex> lock(queue_mutex);
+                arrivals.push_back(next);
+            }
+            queue_cv.notify_one();
+        }
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            dropped = arrivals.size();
+            arrivals.clear();
+            scheduling = false;
+        }
+        queue_cv.notify_all();
+    }
+
+    for (auto& t : workers) t.join();
+    double elapsed = std::chrono::duration<double>(Clock::now() - measure_from).count();
+
+    // ── Report ──────────────────────────────────────────────────────────
+    Recorder total;
+    for (const auto& r : recorders) total.merge(r);
+
+    json operations = json::object();
+    std::uint64_t all_ops = 0;
+    std::uint64_t all_errors = 0;
+    std::vector<double> all_latency;
+    for (int op = 0; op < kOpCount; ++op)
+    {
+        auto& samples = total.latency_us[op];
+        if (samples.empty()) continue;
+        all_ops += samples.size();
+        all_errors += total.errors[op];
+        all_latency.insert(all_latency.end(), samples.begin(), samples.end());
+
+        operations[kOpNames[op]] = {
+            {"count", samples.size()},
+            {"errors", total.errors[op]},
+            {"rate_limited", total.rate_limited[op]},
+            {"ops_per_sec", samples.size() / elapsed},
+            {"bytes", total.bytes[op]},
+            {"mb_per_sec", total.bytes[op] / elapsed / (1024.0 * 1024.0)},
+            {"latency_ms", latency_summary(samples)},
+        };
+    }
+
+    json mix = json::object();
+    for (int op = 0; op < kOpCount; ++op)
+    {
+        if (config.weights[op] > 0) mix[kOpNames[op]] = config.weights[op];
+    }
+
+    json report = {
+        {"config", {
+            {"host", config.host},
+            {"port", config.port},
+            {"users", config.users},
+            {"mode", config.open_loop ? "open" : "closed"},
+            {"rate", config.open_loop ? json(config.rate) : json(nullptr)},
+            {"duration_s", config.duration},
+            {"warmup_s", config.warmup},
+            {"mix", mix},
+        }},
+        {"elapsed_s", elapsed},
+        {"total", {
+            {"count", all_ops},
+            {"errors", all_errors},
+            {"ops_per_sec", all_ops / elapsed},
+            {"latency_ms", latency_summary(all_latency)},
+        }},
+        {"operations", operations},
+    };
+    if (config.open_loop) report["total"]["dropped_arrivals"] = dropped;
+
+    if (config.output.empty())
+    {
+        std::cout << report.dump(2) << "\n";
+    }
+    else
+    {
+        std::ofstream out(config.output);
+        out << report.dump(2) << "\n";
+        if (!out)
+        {
+            std::cerr << "vault_loadgen: cannot write " << config.output << "\n";
+            return 1;
+        }
+    }
+    return all_errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,556 @@
+// vault_replay — plays a vault_server --capture trace against a server.
+//
+// Each pseudonymous user in the trace gets a fresh account on the target,
+// and every request is re-issued with the same method, route, sizes and
+// (pseudonymised) filenames at its original offset, divided by --speed.
+// Request bodies are synthesised from the record's index, so two replays of
+// the same trace send identical bytes. Files that the trace downloads but
+// never uploads existed before the capture started; they are seeded first
+// at their recorded size so the downloads have something to read.
+
+#include "utils/utils.h"
+
+#include <httplib.h>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+
+    // ─── Trace ──────────────────────────────────────────────────────────────────
+
+    struct UploadPart
+    {
+        std::string field;
+        std::string name;
+        std::uint64_t size = 0;
+    };
+
+    struct Record
+    {
+        std::int64_t t_us = 0;
+        std::string method;
+        std::string route;
+        std::string user;                          // pseudonym, or empty
+        std::map<std::string, std::string> params;
+        std::vector<UploadPart> files;             // multipart parts
+        std::string content_type;
+        std::string accept;
+        std::uint64_t bytes_in = 0;
+        std::uint64_t bytes_out = 0;
+        int status = 0;
+        std::int64_t duration_us = 0;
+        json body;                                 // only in --capture-payloads traces
+    };
+
+    std::vector<Record> load_trace(const std::string& path)
+    {
+        std::ifstream in(path);
+        if (!in) throw std::runtime_error("Cannot open trace: " + path);
+
+        std::vector<Record> records;
+        std::string line;
+        for (std::size_t number = 1; std::getline(in, line); ++number)
+        {
+            if (line.empty()) continue;
+            json j = json::parse(line, nullptr, false);
+            if (j.is_discarded() || !j.is_object())
+            {
+                throw std::runtime_error(path + ":" + std::to_string(number) + ": not a JSON object");
+            }
+
+            Record r;
+            r.t_us = j.value("t_us", std::int64_t{0});
+            r.method = j.value("method", "GET");
+            r.route = j.value("route", "/");
+            r.user = j.value("user", "");
+            if (j.contains("params"))
+            {
+                for (const auto& [key, value] : j["params"].items())
+                {
+                    r.params[key] = value.get<std::string>();
+                }
+            }
+            if (j.contains("files"))
+            {
+                for (const auto& part : j["files"])
+                {
+                    r.files.push_back({part.value("field", "file"), part.value("name", ""),
+                                       part.value("size", std::uint64_t{0})});
+                }
+            }
+            r.content_type = j.value("content_type", "");
+            r.accept = j.value("accept", "");
+            r.bytes_in = j.value("bytes_in", std::uint64_t{0});
+            r.bytes_out = j.value("bytes_out", std::uint64_t{0});
+            r.status = j.value("status", 0);
+            r.duration_us = j.value("duration_us", std::int64_t{0});
+            if (j.contains("body")) r.body = j["body"];
+            records.push_back(std::move(r));
+        }
+
+        // Lines are written as requests finish; replay in arrival order
+        std::stable_sort(records.begin(), records.end(),
+                         [](const Record& a, const Record& b) { return a.t_us < b.t_us; });
+        return records;
+    }
+
+    /// Name the server stores an upload under (it appends ".enc" when absent)
+    std::string stored_name(const std::string& name)
+    {
+        return name.find(".enc") == std::string::npos ? name + ".enc" : name;
+    }
+
+    // ─── Synthetic Bodies ───────────────────────────────────────────────────────
+
+    /// Deterministic incompressible bytes: the same (seed, offset) always
+    /// yields the same data, so a provider can be restarted mid-stream
+    void fill(char* out, std::size_t length, std::uint64_t seed, std::uint64_t offset)
+    {
+        std::uint64_t word = 0;
+        for (std::size_t i = 0; i < length; ++i)
+        {
+            std::uint64_t pos = offset + i;
+            if (i == 0 || pos % 8 == 0)
+            {
+                // splitmix64 of (seed, word index)
+                word = (seed * 0x9E3779B97F4A7C15ull) ^ ((pos / 8) * 0xBF58476D1CE4E5B9ull);
+                word ^= word >> 31;
+                word *= 0x94D049BB133111EBull;
+                word ^= word >> 29;
+            }
+            out[i] = static_cast<char>(word >> ((pos % 8) * 8));
+        }
+    }
+
+    std::string make_body(std::size_t length, std::uint64_t seed)
+    {
+        std::string body(length, '\0');
+        fill(body.data(), length, seed, 0);
+        return body;
+    }
+
+    httplib::ContentProvider body_provider(std::uint64_t seed)
+    {
+        return [seed](std::size_t offset, std::size_t length, httplib::DataSink& sink)
+        {
+            char block[64 * 1024];
+            std::size_t n = std::min(length, sizeof(block));
+            fill(block, n, seed, offset);
+            return sink.write(block, n);
+        };
+    }
+
+    // ─── Configuration ──────────────────────────────────────────────────────────
+
+    struct Config
+    {
+        std::string trace;
+        std::string host = "localhost";
+        int port = 8080;
+        double speed = 1.0;        // 0 = as fast as possible
+        std::size_t threads = 16;
+        bool seed = true;
+        std::string output;
+    };
+
+    const std::string kPassword = "replay-password";
+
+    void print_usage()
+    {
+        std::cout << "Usage: vault_replay <trace.jsonl> [options]\n"
+                  << "  --host, -H <host>   Server host (default: localhost)\n"
+                  << "  --port, -p <port>   Server port (default: 8080)\n"
+                  << "  --speed <x>         Pacing multiplier, 2 = twice as fast (default: 1)\n"
+                  << "  --max-speed         Send every request as soon as a worker is free\n"
+                  << "  --threads <n>       Concurrent connections (default: 16)\n"
+                  << "  --no-seed           Don't pre-create files the trace downloads\n"
+                  << "  --output <file>     Write the JSON report here instead of stdout\n"
+                  << "\n"
+                  << "Replay against a scratch server: it registers accounts and stores files.\n";
+    }
+
+    // ─── Replayer ───────────────────────────────────────────────────────────────
+
+    struct Outcome
+    {
+        bool sent = false;            // a response arrived
+        int status = 0;
+        double lag_us = 0;            // how late the request left vs. its schedule
+        double latency_us = 0;        // from scheduled time to response
+        double service_us = 0;        // from send to response
+    };
+
+    class Replayer
+    {
+    public:
+        Replayer(const Config& config, std::vector<Record> records)
+            : config_(config), records_(std::move(records)), outcomes_(records_.size())
+        {
+            auto now = std::chrono::system_clock::now().time_since_epoch();
+            run_id_ = std::to_string(std::chrono::duration_cast<std::chrono::seconds>(now).count() % 1000000);
+        }
+
+        /// Create an account per trace user and seed pre-existing files
+        void setup()
+        {
+            httplib::Client client(config_.host, config_.port);
+            client.set_read_timeout(60);
+
+            std::set<std::string> users;
+            for (const auto& r : records_)
+            {
+                if (!r.user.empty()) users.insert(r.user);
+            }
+            for (const auto& user : users)
+            {
+                std::string name = account(user);
+                json creds = {{"username", name}, {"password", kPassword}};
+                auto reg = client.Post("/register", creds.dump(), "application/json");
+                auto login = client.Post("/login", creds.dump(), "application/json");
+                if (!reg || !login || login->status != 200)
+                {
+                    throw std::runtime_error("Cannot create replay account " + name +
+                                             (login ? " (HTTP " + std::to_string(login->status) + ")" : ""));
+                }
+                tokens_[user] = json::parse(login->body).value("token", "");
+            }
+
+            if (config_.seed) seed_files(client);
+        }
+
+        /// Play the trace; returns the wall time it took in seconds
+        double run()
+        {
+            auto epoch = Clock::now();
+            std::int64_t first = records_.empty() ? 0 : records_.front().t_us;
+
+            std::vector<std::thread> workers;
+            for (std::size_t t = 0; t < config_.threads; ++t)
+            {
+                workers.emplace_back([this, epoch, first]
+                {
+                    httplib::Client client(config_.host, config_.port);
+                    client.set_keep_alive(true);
+                    client.set_read_timeout(300);
+                    client.set_write_timeout(300);
+
+                    for (;;)
+                    {
+                        std::size_t i = next_.fetch_add(1);
+                        if (i >= records_.size()) return;
+
+                        auto offset = config_.speed > 0
+                            ? std::chrono::duration<double, std::micro>((records_[i].t_us - first) / config_.speed)
+                            : std::chrono::duration<double, std::micro>(0);
+                        auto scheduled = epoch + std::chrono::duration_cast<Clock::duration>(offset);
+                        std::this_thread::sleep_until(scheduled);
+                        replay(client, i, scheduled);
+                    }
+                });
+            }
+            for (auto& w : workers) w.join();
+            return std::chrono::duration<double>(Clock::now() - epoch).count();
+        }
+
+        json report(double elapsed) const;
+
+    private:
+        std::string account(const std::string& user) const
+        {
+            return "rp" + run_id_ + user;
+        }
+
+        httplib::Headers headers_for(const Record& r) const
+        {
+            httplib::Headers headers;
+            auto token = tokens_.find(r.user);
+            if (token != tokens_.end() && r.route != "/login" && r.route != "/register")
+            {
+                headers.emplace("Authorization", "Bearer " + token->second);
+            }
+            if (!r.accept.empty()) headers.emplace("Accept", r.accept);
+            return headers;
+        }
+
+        static std::string target(const Record& r)
+        {
+            std::string path = r.route;
+            char sep = '?';
+            for (const auto& [key, value] : r.params)
+            {
+                path += sep + vault::utils::url_encode(key) + "=" + vault::utils::url_encode(value);
+                sep = '&';
+            }
+            return path;
+        }
+
+        /// Upload, before the run, every file the trace reads before writing it
+        void seed_files(httplib::Client& client)
+        {
+            std::map<std::string, std::set<std::string>> present;     // user → stored names
+            std::size_t seeded = 0;
+
+            auto seed = [&](const Record& r, const std::string& name, std::uint64_t size)
+            {
+                auto& files = present[r.user];
+                if (!files.insert(stored_name(name)).second) return;
+                auto res = client.Put("/upload?filename=" + vault::utils::url_encode(name), headers_for(r),
+                                      static_cast<std::size_t>(size), body_provider(size ^ 0x5eed),
+                                      "application/octet-stream");
+                if (res && res->status == 200) ++seeded;
+            };
+
+            for (const auto& r : records_)
+            {
+                if (r.route == "/upload")
+                {
+                    auto it = r.params.find("filename");
+                    if (it != r.params.end()) present[r.user].insert(stored_name(it->second));
+                    for (const auto& part : r.files) present[r.user].insert(stored_name(part.name));
+                }
+                else if (r.route == "/download" && r.status == 200)
+                {
+                    auto it = r.params.find("filename");
+                    if (it != r.params.end()) seed(r, it->second, r.bytes_out);
+                }
+                else if (r.route == "/download-batch" && r.status == 200 && r.body.contains("files"))
+                {
+                    // Sizes inside an archive aren't recorded; split it evenly
+                    const auto& names = r.body["files"];
+                    std::uint64_t each = names.empty() ? 0 : r.bytes_out / names.size();
+                    for (const auto& name : names)
+                    {
+                        if (name.is_string()) seed(r, name.get<std::string>(), each);
+                    }
+                }
+            }
+            std::cerr << "vault_replay: seeded " << seeded << " pre-existing file(s)\n";
+        }
+
+        void replay(httplib::Client& client, std::size_t index, Clock::time_point scheduled)
+        {
+            const Record& r = records_[index];
+            auto headers = headers_for(r);
+            auto path = target(r);
+            auto start = Clock::now();
+
+            auto result = [&]() -> httplib::Result
+            {
+                if (r.route == "/register" || r.route == "/login")
+                {
+                    // /register makes a new account each time, like the original did
+                    std::string name = r.route == "/register"
+                        ? account(r.user) + "n" + std::to_string(index)
+                        : account(r.user);
+                    json creds = {{"username", name}, {"password", kPassword}};
+                    return client.Post(path, headers, creds.dump(), "application/json");
+                }
+                if (!r.files.empty())
+                {
+                    httplib::MultipartFormDataItems items;
+                    for (std::size_t p = 0; p < r.files.size(); ++p)
+                    {
+                        items.push_back({r.files[p].field, make_body(r.files[p].size, index * 131 + p),
+                                         r.files[p].name, "application/octet-stream"});
+                    }
+                    return client.Post(path, headers, items);
+                }
+                if (r.method == "PUT")
+                {
+                    return client.Put(path, headers, static_cast<std::size_t>(r.bytes_in),
+                                      body_provider(index),
+                                      r.content_type.empty() ? "application/octet-stream" : r.content_type);
+                }
+
+                // Everything else, including archives, is read and discarded
+                httplib::Request req;
+                req.method = r.method;
+                req.path = path;
+                req.headers = headers;
+                if (r.method == "POST")
+                {
+                    req.body = r.body.is_null() ? std::string("{}") : r.body.dump();
+                    req.set_header("Content-Type", "application/json");
+                }
+                req.content_receiver = [](const char*, size_t, uint64_t, uint64_t) { return true; };
+                return client.send(req);
+            }();
+
+            auto done = Clock::now();
+            Outcome& out = outcomes_[index];
+            out.sent = static_cast<bool>(result);
+            out.status = result ? result->status : 0;
+            out.lag_us = std::chrono::duration<double, std::micro>(start - scheduled).count();
+            out.latency_us = std::chrono::duration<double, std::micro>(done - scheduled).count();
+            out.service_us = std::chrono::duration<double, std::micro>(done - start).count();
+        }
+
+        const Config& config_;
+        std::vector<Record> records_;
+        std::vector<Outcome> outcomes_;      // one per record, written by whichever worker ran it
+        std::map<std::string, std::string> tokens_;
+        std::string run_id_;
+        std::atomic<std::size_t> next_{0};
+    };
+
+    // ─── Report ─────────────────────────────────────────────────────────────────
+
+    json percentiles_ms(std::vector<double> samples)
+    {
+        std::sort(samples.begin(), samples.end());
+        auto at = [&samples](double p)
+        {
+            if (samples.empty()) return 0.0;
+            auto rank = static_cast<std::size_t>(std::ceil(p / 100.0 * samples.size()));
+            return std::round(samples[std::min(samples.size() - 1, rank == 0 ? 0 : rank - 1)]) / 1000.0;
+        };
+        return {{"p50", at(50)}, {"p90", at(90)}, {"p99", at(99)}, {"max", at(100)}};
+    }
+
+    json Replayer::report(double elapsed) const
+    {
+        struct RouteSamples
+        {
+            std::size_t count = 0;
+            std::size_t failed = 0;
+            std::size_t status_matched = 0;
+            std::vector<double> captured;
+            std::vector<double> replayed;
+        };
+        std::map<std::string, RouteSamples> routes;
+        std::vector<double> lags;
+        std::vector<double> latencies;
+        std::size_t failed = 0;
+        std::size_t matched = 0;
+
+        for (std::size_t i = 0; i < records_.size(); ++i)
+        {
+            const auto& r = records_[i];
+            const auto& o = outcomes_[i];
+            auto& s = routes[r.method + " " + r.route];
+            ++s.count;
+            s.captured.push_back(static_cast<double>(r.duration_us));
+            lags.push_back(o.lag_us);
+            if (!o.sent)
+            {
+                ++s.failed;
+                ++failed;
+                continue;
+            }
+            s.replayed.push_back(o.service_us);
+            latencies.push_back(o.latency_us);
+            if (o.status == r.status)
+            {
+                ++s.status_matched;
+                ++matched;
+            }
+        }
+
+        json per_route = json::object();
+        for (auto& [route, s] : routes)
+        {
+            per_route[route] = {
+                {"count", s.count},
+                {"failed", s.failed},
+                {"status_matched", s.status_matched},
+                {"captured_ms", percentiles_ms(std::move(s.captured))},
+                {"replayed_ms", percentiles_ms(std::move(s.replayed))},
+            };
+        }
+
+        return {
+            {"trace", config_.trace},
+            {"speed", config_.speed},
+            {"requests", records_.size()},
+            {"failed", failed},
+            {"status_matched", matched},
+            {"elapsed_s", elapsed},
+            {"requests_per_sec", records_.size() / elapsed},
+            {"send_lag_ms", percentiles_ms(std::move(lags))},
+            {"latency_from_schedule_ms", percentiles_ms(std::move(latencies))},
+            {"routes", per_route},
+        };
+    }
+
+} // namespace
+
+// ─── Main ──────────────────────────────────────────────────────────────────────
+
+int main(int argc, char* argv[])
+{
+    Config config;
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            bool has_value = i + 1 < argc;
+            if ((arg == "--host" || arg == "-H") && has_value) config.host = argv[++i];
+            else if ((arg == "--port" || arg == "-p") && has_value) config.port = std::stoi(argv[++i]);
+            else if (arg == "--speed" && has_value) config.speed = std::stod(argv[++i]);
+            else if (arg == "--max-speed") config.speed = 0;
+            else if (arg == "--threads" && has_value) config.threads = std::stoul(argv[++i]);
+            else if (arg == "--no-seed") config.seed = false;
+            else if (arg == "--output" && has_value) config.output = argv[++i];
+            else if (arg == "--help")
+            {
+                print_usage();
+                return 0;
+            }
+            else if (!arg.empty() && arg[0] != '-' && config.trace.empty()) config.trace = arg;
+            else throw std::invalid_argument("unknown option: " + arg);
+        }
+        if (config.trace.empty()) throw std::invalid_argument("no trace file given");
+        if (config.speed < 0 || config.threads == 0)
+        {
+            throw std::invalid_argument("--speed must be >= 0 and --threads positive");
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "vault_replay: " << e.what() << "\n";
+        print_usage();
+        return 2;
+    }
+
+    try
+    {
+        Replayer replayer(config, load_trace(config.trace));
+        replayer.setup();
+        double elapsed = replayer.run();
+        auto report = replayer.report(elapsed).dump(2);
+
+        if (config.output.empty())
+        {
+            std::cout << report << "\n";
+        }
+        else
+        {
+            std::ofstream out(config.output);
+            out << report << "\n";
+            if (!out) throw std::runtime_error("Cannot write " + config.output);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "vault_replay: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}